@@ -0,0 +1,61 @@
+/*
+Copyright (c) 2025 RealTimeChris (Chris M.)
+
+This file is part of software offered under a restricted-use license to a designated Licensee,
+whose identity is confirmed in writing by the Author.
+
+License Terms (Summary):
+- Exclusive, non-transferable license for internal use only.
+- Redistribution, sublicensing, or public disclosure is prohibited without written consent.
+- Full ownership remains with the Author.
+- License may terminate if unused for [X months], if materially breached, or by mutual agreement.
+- No warranty is provided, express or implied.
+
+Full license terms are provided in the LICENSE file distributed with this software.
+
+Signed,
+RealTimeChris (Chris M.)
+2025
+*/
+
+#pragma once
+
+#include <nihilus/common/common.hpp>
+#include <algorithm>
+
+namespace nihilus {
+
+	struct visible_range {
+		uint64_t begin{};
+		uint64_t end{};
+	};
+
+	// Stands in for a materialized kq_mask: the visible kv span of a query row is derived from its position, so kernels never read a mask tensor.
+	template<model_config config> struct attention_mask {
+		static constexpr attention_mask_type type{ config.mask_type };
+		static constexpr uint64_t window_size{ config.sliding_window_size };
+		static_assert(type != attention_mask_type::sliding_window || window_size > 0, "Sorry, but a sliding window mask needs a non-zero sliding_window_size!");
+
+		// Absolute position of the first query row in this step.
+		uint64_t position_offset{};
+		// Query rows per head that the graph lays out; rows run head-major, so this is the distance between one head's rows and the next.
+		uint64_t row_stride{ 1 };
+		// Query rows per head that hold tokens in this step; rows past it (the tail of a short last chunk) see nothing and softmax to zero.
+		uint64_t query_count{ 1 };
+
+		NIHILUS_FORCE_INLINE visible_range range(uint64_t query_row) const {
+			const uint64_t position{ position_offset + query_row };
+			visible_range return_value{ 0, position + 1 };
+			if constexpr (type == attention_mask_type::sliding_window) {
+				return_value.begin = return_value.end > window_size ? return_value.end - window_size : 0;
+			}
+			return return_value;
+		}
+
+		NIHILUS_FORCE_INLINE visible_range range_for_row(uint64_t row) const {
+			const uint64_t query_row{ row % row_stride };
+			return query_row < query_count ? range(query_row) : visible_range{};
+		}
+	};
+
+}
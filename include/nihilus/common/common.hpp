@@ -499,6 +499,107 @@ namespace nihilus {
 		}
 	}
 
+	// Tensors that come from the model file: their storage is bound by the loader instead of being carved out of the activation buffer.
+	template<integral_or_enum value_type> constexpr bool is_weight_op(value_type op) {
+		switch (static_cast<llama_op_types>(op)) {
+			case llama_op_types::token_embd_weight:
+			case llama_op_types::rope_freqs_weight:
+			case llama_op_types::output_weight:
+			case llama_op_types::output_norm_weight:
+			case llama_op_types::attn_q_weight:
+			case llama_op_types::attn_k_weight:
+			case llama_op_types::attn_v_weight:
+			case llama_op_types::attn_output_weight:
+			case llama_op_types::attn_norm_weight:
+			case llama_op_types::ffn_gate_weight:
+			case llama_op_types::ffn_up_weight:
+			case llama_op_types::ffn_down_weight:
+			case llama_op_types::ffn_norm_weight:
+				return true;
+			default:
+				return false;
+		}
+	}
+
+	enum class map_advice : uint8_t {
+		normal,
+		sequential,
+		random,
+		will_need,
+		dont_need,
+		count,
+	};
+
+	// Weight storage the mul_mat kernels read: row_major is the GGUF order, interleaved_xN groups N rows with their blocks interleaved.
+	enum class weight_layout : uint8_t {
+		row_major,
+		interleaved_x4,
+		interleaved_x8,
+		count,
+	};
+
+	// A mul_mat weight operand as the kernels are selected by it: the element type plus the layout the loader left it in, so a weight kept in
+	// GGUF order (pinned, tied, or with a row count the interleave does not divide) reaches a kernel that reads it that way.
+	template<typename value_type_new, weight_layout layout_new> struct laid_out_weight {
+		using value_type = value_type_new;
+		static constexpr weight_layout layout{ layout_new };
+	};
+
+	// How tensor data reaches memory: mmap maps the file in place, the others read it with O_DIRECT into memory the model owns, bypassing the page
+	// cache. io_uring falls back to pread where the kernel or sandbox refuses it.
+	enum class weight_reader : uint8_t {
+		mmap,
+		pread,
+		io_uring,
+		count,
+	};
+
+	// Backing for the large arenas, from weakest to strongest. Requested through cli_params and reported back by memory_buffer::backing(), since
+	// every policy but none can silently degrade: hugetlb needs a reserved pool, THP needs the kernel to allow it.
+	enum class huge_page_policy : uint8_t {
+		none,
+		transparent,
+		explicit_2m,
+		explicit_1g,
+		count,
+	};
+
+	inline static constexpr const char* huge_page_policy_names[]{ "4 KiB pages", "transparent huge pages", "2 MiB hugetlb pages", "1 GiB hugetlb pages" };
+
+	// Where pages of the shared arenas live on multi-socket hosts. interleave spreads every buffer round-robin over the nodes; partition gives each
+	// node the rows of every weight held in anonymous memory that its contiguous group of pool threads takes under a thread_index row split.
+	enum class numa_placement : uint8_t {
+		none,
+		interleave,
+		partition,
+		count,
+	};
+
+	// Startup work that moves first-token page faults into the constructor; each level includes the ones before it. prefault touches every
+	// activation page and every page of the weight mapping, lock pins the weights in RAM, full also runs one throwaway token through the graph.
+	enum class startup_warmup : uint8_t {
+		none,
+		prefault,
+		lock,
+		full,
+		count,
+	};
+
+	inline static constexpr const char* startup_warmup_names[]{ "none", "prefault", "lock", "full" };
+
+	struct map_options {
+		// Fault every page in at map time (MAP_POPULATE) instead of on first touch.
+		bool populate{};
+		map_advice advice{ map_advice::normal };
+		weight_reader reader{ weight_reader::mmap };
+		// Layers of mapped weights prefetched ahead of the one executing, each dropped from the mapping once the schedule moves past it; zero keeps
+		// every weight mapped for the model's lifetime.
+		uint64_t stream_distance{};
+		// Return once weights are bound and finish repacks and page-ins on a loader thread in execution order; each graph pass waits only at
+		// the first block whose weights are not resident yet.
+		bool background{};
+	};
+
 	enum class device_type {
 		cpu,
 		gpu,
@@ -546,6 +647,12 @@ namespace nihilus {
 		count,
 	};
 
+	enum class attention_mask_type : uint64_t {
+		causal,
+		sliding_window,
+		count,
+	};
+
 	enum class rope_scaling_type : uint64_t {
 		none,
 		linear,
@@ -586,7 +693,7 @@ namespace nihilus {
 		using type = decltype(get_op_type_impl());
 	};
 
-	enum class model_format { gguf = 1 };
+	enum class model_format { gguf = 1, prepacked = 2 };
 
 	template<typename model_generation_type_new, typename model_size_type_new> struct model_config {
 		using model_generation_type = model_generation_type_new;
@@ -606,6 +713,11 @@ namespace nihilus {
 		model_format format{};
 		float norm_epsilon{};
 		bool exceptions{};
+		attention_mask_type mask_type{};
+		uint64_t sliding_window_size{};
+		uint64_t max_context_length{};
+		uint64_t max_batch_size{};
+		bool is_decode_graph{};
 
 	  protected:
 		template<typename model_generateion_type_newer, typename model_size_type_newer> friend struct model_base;
@@ -613,11 +725,13 @@ namespace nihilus {
 
 		constexpr model_config(auto model_generation_new, auto model_size_new, kernel_type_profile kernel_profile_new, model_arch arch_new, bool exceptions_new,
 			kv_cache_strategy cache_strategy_new, bool use_gradient_checkpointing_new, rope_scaling_type rope_scaling_new, bool use_rotary_embeddings_new,
-			uint64_t kv_cache_block_size_new, bool use_flash_attention_new, norm_type rms_norm_type_new, model_format format_new, float norm_epsilon_new)
+			uint64_t kv_cache_block_size_new, bool use_flash_attention_new, norm_type rms_norm_type_new, model_format format_new, float norm_epsilon_new,
+			attention_mask_type mask_type_new, uint64_t sliding_window_size_new, uint64_t max_context_length_new, uint64_t max_batch_size_new)
 			: model_generation(model_generation_new), model_size(model_size_new), kernel_profile(kernel_profile_new), arch(arch_new), cache_strategy(cache_strategy_new),
 			  use_gradient_checkpointing(use_gradient_checkpointing_new), rope_scaling(rope_scaling_new), use_rotary_embeddings(use_rotary_embeddings_new),
 			  kv_cache_block_size(kv_cache_block_size_new), use_flash_attention(use_flash_attention_new), rms_norm_type(rms_norm_type_new), format{ format_new },
-			  norm_epsilon(norm_epsilon_new), exceptions(exceptions_new) {};
+			  norm_epsilon(norm_epsilon_new), exceptions(exceptions_new), mask_type(mask_type_new), sliding_window_size(sliding_window_size_new),
+			  max_context_length(max_context_length_new), max_batch_size(max_batch_size_new) {};
 
 		constexpr model_config() = default;
 	};
@@ -628,6 +742,12 @@ namespace nihilus {
 		uint64_t thread_count{ std::thread::hardware_concurrency() };
 		bool no_conversation{ false };
 		uint64_t batch_size{ 512 };
+		uint64_t context_length{ 0 };
+		map_options weight_mapping{};
+		huge_page_policy huge_pages{ huge_page_policy::none };
+		numa_placement numa{ numa_placement::none };
+		startup_warmup warmup{ startup_warmup::none };
+		bool memory_report{ false };
 		uint64_t n_predict{ 128 };
 		std::string model_file{};
 		uint64_t n_tokens{ 0 };
@@ -647,8 +767,13 @@ namespace nihilus {
 	struct execution_parameters {
 		const int32_t* input_tokens{};
 		size_t kv_cache_seq_len{};
+		size_t context_keep_count{};
 		size_t position_offset{};
+		// Tokens to sample after the prompt; the first comes from the prompt's own pass, each later one costs a decode pass.
 		size_t max_new_tokens{};
+		// Receives the samples when set, and must hold max_new_tokens of them; generated_count says how many were produced.
+		int32_t* output_tokens{};
+		size_t generated_count{};
 		uint64_t random_seed{};
 		int32_t eos_token_id{};
 		bool clear_kv_cache{};
@@ -0,0 +1,109 @@
+/*
+Copyright (c) 2025 RealTimeChris (Chris M.)
+
+This file is part of software offered under a restricted-use license to a designated Licensee,
+whose identity is confirmed in writing by the Author.
+
+License Terms (Summary):
+- Exclusive, non-transferable license for internal use only.
+- Redistribution, sublicensing, or public disclosure is prohibited without written consent.
+- Full ownership remains with the Author.
+- License may terminate if unused for [X months], if materially breached, or by mutual agreement.
+- No warranty is provided, express or implied.
+
+Full license terms are provided in the LICENSE file distributed with this software.
+
+Signed,
+RealTimeChris (Chris M.)
+2025
+*/
+
+#pragma once
+
+#include <nihilus/common/kernel_type_profile_traits.hpp>
+#include <nihilus/common/core_traits.hpp>
+#include <nihilus/common/model_traits.hpp>
+#include <nihilus/common/data_types.hpp>
+#include <nihilus/common/common.hpp>
+#include <nihilus/common/array.hpp>
+#include <type_traits>
+#include <cstring>
+#include <vector>
+#include <cmath>
+
+namespace nihilus {
+
+	template<model_config config> struct context_shift {
+		using model_traits_type = model_traits<config.arch, config.model_size, config.model_generation>;
+		using kv_cache_type		= typename kernel_type_profile_traits<config.kernel_profile>::kv_cache_type;
+		using cache_data_type	= array<kv_cache_type*, model_traits_type::block_count>;
+		static constexpr uint64_t kv_dim{ model_traits_type::head_count_kv * model_traits_type::head_dim };
+		static constexpr uint64_t context_length{ sequence_traits<config>::context_length };
+		static constexpr uint64_t rope_pair_count{ model_traits_type::rope_dimension_count / 2 };
+		static constexpr uint64_t page_size{ config.kv_cache_block_size };
+
+		NIHILUS_FORCE_INLINE static float load(kv_cache_type value) {
+			if constexpr (std::is_same_v<kv_cache_type, float>) {
+				return value;
+			} else {
+				return fp16_to_fp32(static_cast<fp16_t>(value));
+			}
+		}
+
+		NIHILUS_FORCE_INLINE static kv_cache_type store(float value) {
+			if constexpr (std::is_same_v<kv_cache_type, float>) {
+				return value;
+			} else {
+				return static_cast<kv_cache_type>(fp32_to_fp16(value));
+			}
+		}
+
+		NIHILUS_FORCE_INLINE static uint64_t physical_row(const std::vector<uint32_t>& pages, uint64_t token) {
+			return pages[token / page_size] * page_size + token % page_size;
+		}
+
+		NIHILUS_FORCE_INLINE static void copy_row(cache_data_type& cache_k, cache_data_type& cache_v, uint64_t destination_row, uint64_t source_row) {
+			for (uint64_t x = 0; x < model_traits_type::block_count; ++x) {
+				std::memcpy(cache_k[x] + destination_row * kv_dim, cache_k[x] + source_row * kv_dim, kv_dim * sizeof(kv_cache_type));
+				for (uint64_t y = 0; y < kv_dim; ++y) {
+					cache_v[x][y * context_length + destination_row] = cache_v[x][y * context_length + source_row];
+				}
+			}
+		}
+
+		// Removes tokens [keep_count, keep_count + discard_count), slides the tail down, and rotates the moved keys back by discard_count positions.
+		// Because every moved key shifts by the same delta, one cos/sin table covers the whole cache.
+		NIHILUS_FORCE_INLINE static void impl(cache_data_type& cache_k, cache_data_type& cache_v, const std::vector<uint32_t>& pages, uint64_t token_count, uint64_t keep_count,
+			uint64_t discard_count, float freq_base, const float* freq_factors) {
+			for (uint64_t x = keep_count + discard_count; x < token_count; ++x) {
+				copy_row(cache_k, cache_v, physical_row(pages, x - discard_count), physical_row(pages, x));
+			}
+			array<float, rope_pair_count> cos_values{};
+			array<float, rope_pair_count> sin_values{};
+			for (uint64_t x = 0; x < rope_pair_count; ++x) {
+				float theta{ -static_cast<float>(discard_count) * std::pow(freq_base, -2.0f * static_cast<float>(x) / static_cast<float>(model_traits_type::rope_dimension_count)) };
+				if (freq_factors && freq_factors[x] > 0.0f) {
+					theta /= freq_factors[x];
+				}
+				cos_values[x] = std::cos(theta);
+				sin_values[x] = std::sin(theta);
+			}
+			const uint64_t new_token_count{ token_count - discard_count };
+			for (uint64_t x = 0; x < model_traits_type::block_count; ++x) {
+				for (uint64_t y = keep_count; y < new_token_count; ++y) {
+					kv_cache_type* row{ cache_k[x] + physical_row(pages, y) * kv_dim };
+					for (uint64_t z = 0; z < model_traits_type::head_count_kv; ++z) {
+						kv_cache_type* head{ row + z * model_traits_type::head_dim };
+						for (uint64_t w = 0; w < rope_pair_count; ++w) {
+							const float x0{ load(head[2 * w]) };
+							const float x1{ load(head[2 * w + 1]) };
+							head[2 * w]		= store(x0 * cos_values[w] - x1 * sin_values[w]);
+							head[2 * w + 1] = store(x0 * sin_values[w] + x1 * cos_values[w]);
+						}
+					}
+				}
+			}
+		}
+	};
+
+}
@@ -22,6 +22,7 @@ RealTimeChris (Chris model_traits_type.)
 
 #include <nihilus/common/kernel_traits.hpp>
 #include <nihilus/common/kernel_type_profile_traits.hpp>
+#include <nihilus/common/attention_mask.hpp>
 #include <nihilus/common/model_traits.hpp>
 #include <nihilus/common/common.hpp>
 #include <nihilus/common/array.hpp>
@@ -41,6 +42,24 @@ namespace nihilus {
 		per_block,
 	};
 
+	// Rows reserved for the kv cache and attention scores (context_length), and for the per-pass activations (batch_length). A zero in the config
+	// falls back to the model's trained context.
+	template<model_config config> struct sequence_traits {
+		using model_traits_type = model_traits<config.arch, config.model_size, config.model_generation>;
+		static_assert(config.max_context_length <= model_traits_type::max_sequence_length, "Sorry, but max_context_length exceeds the model's trained context!");
+		static constexpr uint64_t context_length{ config.max_context_length > 0 ? config.max_context_length : model_traits_type::max_sequence_length };
+		static_assert(config.max_batch_size <= context_length, "Sorry, but max_batch_size must not exceed the context length!");
+		static constexpr uint64_t batch_length{ config.max_batch_size > 0 ? config.max_batch_size : context_length };
+	};
+
+	// The same model with one row per pass, instantiated alongside the prefill graph so decode gets GEMV-shaped kernels and a one-token footprint.
+	template<model_config config> inline constexpr auto decode_config{ [] {
+		auto return_value{ config };
+		return_value.max_batch_size	 = 1;
+		return_value.is_decode_graph = true;
+		return return_value;
+	}() };
+
 	template<typename type01, typename type02> struct requires_dequant_or_quant {
 		static constexpr bool required{ !std::is_same_v<type01, type02> };
 	};
@@ -55,8 +74,10 @@ namespace nihilus {
 
 	template<model_config config> struct model;
 
+	template<model_config config> struct decode_graph;
+
 	template<model_config config> struct model_traits_provider {
-		using model_type = model<config>;
+		using model_type = std::conditional_t<config.is_decode_graph, decode_graph<config>, model<config>>;
 	};
 
 	template<model_config config> struct core_traits<config, llama_op_types::token_embd_weight> {
@@ -91,7 +112,7 @@ namespace nihilus {
 		using output_type		= typename kernel_type_profile_traits<config.kernel_profile>::input_token_type;
 		static constexpr uint64_t depth{ 0 };
 		static constexpr alloc_type alc_type{ alloc_type::single_alloc };
-		static constexpr array<uint64_t, 4> dims{ { model_traits_type::max_sequence_length, 1, 1, 1 } };
+		static constexpr array<uint64_t, 4> dims{ { sequence_traits<config>::batch_length, 1, 1, 1 } };
 		static constexpr uint64_t total_required_bytes{ roundUpToMultiple(type_traits<output_type>::total_byte_size(dims), 64ull) };
 		static constexpr layer_op_type layer_type{ layer_op_type::none };
 		static constexpr kernel_type krn_type{ kernel_type::none };
@@ -112,7 +133,7 @@ namespace nihilus {
 		using output_type		= typename kernel_type_profile_traits<config.kernel_profile>::position_type;
 		static constexpr uint64_t depth{ 0 };
 		static constexpr alloc_type alc_type{ alloc_type::single_alloc };
-		static constexpr array<uint64_t, 4> dims{ { model_traits_type::max_sequence_length, 1, 1, 1 } };
+		static constexpr array<uint64_t, 4> dims{ { sequence_traits<config>::batch_length, 1, 1, 1 } };
 		static constexpr uint64_t total_required_bytes{ roundUpToMultiple(type_traits<output_type>::total_byte_size(dims), 64ull) };
 		static constexpr layer_op_type layer_type{ layer_op_type::none };
 		static constexpr kernel_type krn_type{ kernel_type::none };
@@ -133,7 +154,7 @@ namespace nihilus {
 		using output_type		= typename kernel_type_profile_traits<config.kernel_profile>::output_token_type;
 		static constexpr uint64_t depth{ 0 };
 		static constexpr alloc_type alc_type{ alloc_type::single_alloc };
-		static constexpr array<uint64_t, 4> dims{ { model_traits_type::max_sequence_length, 1, 1, 1 } };
+		static constexpr array<uint64_t, 4> dims{ { sequence_traits<config>::batch_length, 1, 1, 1 } };
 		static constexpr uint64_t total_required_bytes{ roundUpToMultiple(type_traits<output_type>::total_byte_size(dims), 64ull) };
 		static constexpr layer_op_type layer_type{ layer_op_type::none };
 		static constexpr kernel_type krn_type{ kernel_type::none };
@@ -223,7 +244,7 @@ namespace nihilus {
 		static constexpr kernel_type krn_type{ kernel_type::none };
 		static constexpr llama_op_types type{ llama_op_types::attn_q_weight };
 		static constexpr uint64_t count{ total_required_bytes / sizeof(output_type) };
-		output_type* data{};
+		array<output_type*, model_traits_type::block_count> data{};
 		int32_t value{};
 	};
 
@@ -244,7 +265,7 @@ namespace nihilus {
 		static constexpr kernel_type krn_type{ kernel_type::none };
 		static constexpr llama_op_types type{ llama_op_types::attn_k_weight };
 		static constexpr uint64_t count{ total_required_bytes / sizeof(output_type) };
-		output_type* data{};
+		array<output_type*, model_traits_type::block_count> data{};
 		int32_t value{};
 	};
 
@@ -265,7 +286,7 @@ namespace nihilus {
 		static constexpr kernel_type krn_type{ kernel_type::none };
 		static constexpr llama_op_types type{ llama_op_types::attn_v_weight };
 		static constexpr uint64_t count{ total_required_bytes / sizeof(output_type) };
-		output_type* data{};
+		array<output_type*, model_traits_type::block_count> data{};
 		int32_t value{};
 	};
 
@@ -286,7 +307,7 @@ namespace nihilus {
 		static constexpr kernel_type krn_type{ kernel_type::none };
 		static constexpr llama_op_types type{ llama_op_types::attn_output_weight };
 		static constexpr uint64_t count{ total_required_bytes / sizeof(output_type) };
-		output_type* data{};
+		array<output_type*, model_traits_type::block_count> data{};
 		int32_t value{};
 	};
 
@@ -307,7 +328,7 @@ namespace nihilus {
 		static constexpr kernel_type krn_type{ kernel_type::none };
 		static constexpr llama_op_types type{ llama_op_types::attn_norm_weight };
 		static constexpr uint64_t count{ total_required_bytes / sizeof(output_type) };
-		output_type* data{};
+		array<output_type*, model_traits_type::block_count> data{};
 		int32_t value{};
 	};
 
@@ -328,7 +349,7 @@ namespace nihilus {
 		static constexpr kernel_type krn_type{ kernel_type::none };
 		static constexpr llama_op_types type{ llama_op_types::ffn_gate_weight };
 		static constexpr uint64_t count{ total_required_bytes / sizeof(output_type) };
-		output_type* data{};
+		array<output_type*, model_traits_type::block_count> data{};
 		int32_t value{};
 	};
 
@@ -349,7 +370,7 @@ namespace nihilus {
 		static constexpr kernel_type krn_type{ kernel_type::none };
 		static constexpr llama_op_types type{ llama_op_types::ffn_up_weight };
 		static constexpr uint64_t count{ total_required_bytes / sizeof(output_type) };
-		output_type* data{};
+		array<output_type*, model_traits_type::block_count> data{};
 		int32_t value{};
 	};
 
@@ -363,14 +384,14 @@ namespace nihilus {
 		using model_traits_type = model_traits<config.arch, config.model_size, config.model_generation>;
 		using output_type		= typename kernel_type_profile_traits<config.kernel_profile>::ffn_down_weight_type;
 		static constexpr uint64_t depth{ 0 };
-		static constexpr alloc_type alc_type{ alloc_type::single_alloc };
+		static constexpr alloc_type alc_type{ alloc_type::per_block_alloc };
 		static constexpr array<uint64_t, 4> dims{ { model_traits_type::feed_forward_length, model_traits_type::embedding_dim, 1, 1 } };
 		static constexpr uint64_t total_required_bytes{ roundUpToMultiple(type_traits<output_type>::total_byte_size(dims), 64ull) };
 		static constexpr layer_op_type layer_type{ layer_op_type::none };
 		static constexpr kernel_type krn_type{ kernel_type::none };
 		static constexpr llama_op_types type{ llama_op_types::ffn_down_weight };
 		static constexpr uint64_t count{ total_required_bytes / sizeof(output_type) };
-		output_type* data{};
+		array<output_type*, model_traits_type::block_count> data{};
 		int32_t value{};
 	};
 
@@ -384,14 +405,14 @@ namespace nihilus {
 		using model_traits_type = model_traits<config.arch, config.model_size, config.model_generation>;
 		using output_type		= typename kernel_type_profile_traits<config.kernel_profile>::ffn_norm_weight_type;
 		static constexpr uint64_t depth{ 0 };
-		static constexpr alloc_type alc_type{ alloc_type::single_alloc };
+		static constexpr alloc_type alc_type{ alloc_type::per_block_alloc };
 		static constexpr array<uint64_t, 4> dims{ { model_traits_type::embedding_dim, 1, 1, 1 } };
 		static constexpr uint64_t total_required_bytes{ roundUpToMultiple(type_traits<output_type>::total_byte_size(dims), 64ull) };
 		static constexpr layer_op_type layer_type{ layer_op_type::none };
 		static constexpr kernel_type krn_type{ kernel_type::none };
 		static constexpr llama_op_types type{ llama_op_types::ffn_norm_weight };
 		static constexpr uint64_t count{ total_required_bytes / sizeof(output_type) };
-		output_type* data{};
+		array<output_type*, model_traits_type::block_count> data{};
 		int32_t value{};
 	};
 
@@ -405,14 +426,14 @@ namespace nihilus {
 		using model_traits_type = model_traits<config.arch, config.model_size, config.model_generation>;
 		using output_type		= typename kernel_type_profile_traits<config.kernel_profile>::kv_cache_type;
 		static constexpr uint64_t depth{ 0 };
-		static constexpr alloc_type alc_type{ alloc_type::single_alloc };
-		static constexpr array<uint64_t, 4> dims{ { model_traits_type::head_count_kv * model_traits_type::head_dim, model_traits_type::max_sequence_length, 1, 1 } };
+		static constexpr alloc_type alc_type{ alloc_type::per_block_alloc };
+		static constexpr array<uint64_t, 4> dims{ { model_traits_type::head_count_kv * model_traits_type::head_dim, sequence_traits<config>::context_length, 1, 1 } };
 		static constexpr uint64_t total_required_bytes{ roundUpToMultiple(type_traits<output_type>::total_byte_size(dims), 64ull) };
 		static constexpr layer_op_type layer_type{ layer_op_type::none };
 		static constexpr kernel_type krn_type{ kernel_type::none };
 		static constexpr llama_op_types type{ llama_op_types::cache_k };
 		static constexpr uint64_t count{ total_required_bytes / sizeof(output_type) };
-		output_type* data{};
+		array<output_type*, model_traits_type::block_count> data{};
 		int32_t value{};
 	};
 
@@ -426,14 +447,14 @@ namespace nihilus {
 		using model_traits_type = model_traits<config.arch, config.model_size, config.model_generation>;
 		using output_type		= typename kernel_type_profile_traits<config.kernel_profile>::kv_cache_type;
 		static constexpr uint64_t depth{ 0 };
-		static constexpr alloc_type alc_type{ alloc_type::single_alloc };
-		static constexpr array<uint64_t, 4> dims{ { model_traits_type::head_count_kv * model_traits_type::head_dim, model_traits_type::max_sequence_length, 1, 1 } };
+		static constexpr alloc_type alc_type{ alloc_type::per_block_alloc };
+		static constexpr array<uint64_t, 4> dims{ { model_traits_type::head_count_kv * model_traits_type::head_dim, sequence_traits<config>::context_length, 1, 1 } };
 		static constexpr uint64_t total_required_bytes{ roundUpToMultiple(type_traits<output_type>::total_byte_size(dims), 64ull) };
 		static constexpr layer_op_type layer_type{ layer_op_type::none };
 		static constexpr kernel_type krn_type{ kernel_type::none };
 		static constexpr llama_op_types type{ llama_op_types::cache_v };
 		static constexpr uint64_t count{ total_required_bytes / sizeof(output_type) };
-		output_type* data{};
+		array<output_type*, model_traits_type::block_count> data{};
 		int32_t value{};
 	};
 
@@ -448,8 +469,8 @@ namespace nihilus {
 		using output_type		= typename kernel_type_profile_traits<config.kernel_profile>::kq_mask_type;
 		static constexpr uint64_t depth{ 0 };
 		static constexpr alloc_type alc_type{ alloc_type::single_alloc };
-		static constexpr array<uint64_t, 4> dims{ { model_traits_type::max_sequence_length, model_traits_type::max_sequence_length, 1, 1 } };
-		static constexpr uint64_t total_required_bytes{ roundUpToMultiple(type_traits<output_type>::total_byte_size(dims), 64ull) };
+		static constexpr array<uint64_t, 4> dims{ { sequence_traits<config>::context_length, sequence_traits<config>::batch_length, 1, 1 } };
+		static constexpr uint64_t total_required_bytes{ 0 };
 		static constexpr layer_op_type layer_type{ layer_op_type::none };
 		static constexpr kernel_type krn_type{ kernel_type::none };
 		static constexpr llama_op_types type{ llama_op_types::kq_mask };
@@ -475,7 +496,7 @@ namespace nihilus {
 		static constexpr uint64_t depth{ std::max(input_type01::depth, input_type02::depth) + 1 };
 		static constexpr bool dequantization{ requires_dequant_or_quant<typename input_type01::output_type, typename input_type02::output_type>::required };
 		static constexpr alloc_type alc_type{ alloc_type::single_alloc };
-		static constexpr array<uint64_t, 4> dims{ { model_traits_type::embedding_dim, model_traits_type::max_sequence_length, 1, 1 } };
+		static constexpr array<uint64_t, 4> dims{ { model_traits_type::embedding_dim, sequence_traits<config>::batch_length, 1, 1 } };
 		static constexpr uint64_t total_required_bytes{ roundUpToMultiple(
 			type_traits<output_type>::total_byte_size(dims) + (dequantization ? type_traits<output_type>::total_byte_size(dims) : 0), 64ull) };
 		static constexpr layer_op_type layer_type{ layer_op_type::global_input };
@@ -501,7 +522,7 @@ namespace nihilus {
 		static constexpr uint64_t depth{ input_type01::depth + 1 };
 		static constexpr bool dequantization{ requires_dequant_or_quant<typename input_type01::output_type, output_type>::required };
 		static constexpr alloc_type alc_type{ alloc_type::single_alloc };
-		static constexpr array<uint64_t, 4> dims{ { model_traits_type::embedding_dim, model_traits_type::max_sequence_length, 1, 1 } };
+		static constexpr array<uint64_t, 4> dims{ { model_traits_type::embedding_dim, sequence_traits<config>::batch_length, 1, 1 } };
 		static constexpr uint64_t total_required_bytes{ roundUpToMultiple(
 			type_traits<output_type>::total_byte_size(dims) + (dequantization ? type_traits<output_type>::total_byte_size(dims) : 0), 64ull) };
 		static constexpr layer_op_type layer_type{ layer_op_type::per_block };
@@ -528,7 +549,7 @@ namespace nihilus {
 		static constexpr uint64_t depth{ std::max(input_type01::depth, input_type02::depth) + 1 };
 		static constexpr bool dequantization{ requires_dequant_or_quant<typename input_type01::output_type, typename input_type02::output_type>::required };
 		static constexpr alloc_type alc_type{ alloc_type::single_alloc };
-		static constexpr array<uint64_t, 4> dims{ { model_traits_type::embedding_dim, model_traits_type::max_sequence_length, 1, 1 } };
+		static constexpr array<uint64_t, 4> dims{ { model_traits_type::embedding_dim, sequence_traits<config>::batch_length, 1, 1 } };
 		static constexpr uint64_t total_required_bytes{ roundUpToMultiple(
 			type_traits<output_type>::total_byte_size(dims) + (dequantization ? type_traits<output_type>::total_byte_size(dims) : 0), 64ull) };
 		static constexpr layer_op_type layer_type{ layer_op_type::per_block };
@@ -555,7 +576,7 @@ namespace nihilus {
 		static constexpr uint64_t depth{ std::max(input_type01::depth, input_type02::depth) + 1 };
 		static constexpr alloc_type alc_type{ alloc_type::single_alloc };
 		static constexpr bool dequantization{ requires_dequant_or_quant<typename input_type01::output_type, typename input_type02::output_type>::required };
-		static constexpr array<uint64_t, 4> dims{ { model_traits_type::head_count * model_traits_type::head_dim, model_traits_type::max_sequence_length, 1, 1 } };
+		static constexpr array<uint64_t, 4> dims{ { model_traits_type::head_count * model_traits_type::head_dim, sequence_traits<config>::batch_length, 1, 1 } };
 		static constexpr uint64_t total_required_bytes{ roundUpToMultiple(
 			type_traits<output_type>::total_byte_size(dims) + (dequantization ? type_traits<output_type>::total_byte_size(dims) : 0), 64ull) };
 		static constexpr layer_op_type layer_type{ layer_op_type::per_block };
@@ -582,7 +603,7 @@ namespace nihilus {
 		using output_type		= typename kernel_type_profile_traits<config.kernel_profile>::query_type;
 		static constexpr uint64_t depth{ input_type01::depth + 1 };
 		static constexpr alloc_type alc_type{ alloc_type::single_alloc };
-		static constexpr array<uint64_t, 4> dims{ { model_traits_type::head_dim, model_traits_type::max_sequence_length, model_traits_type::head_count, 1 } };
+		static constexpr array<uint64_t, 4> dims{ { model_traits_type::head_dim, sequence_traits<config>::batch_length, model_traits_type::head_count, 1 } };
 		static constexpr uint64_t total_required_bytes{ roundUpToMultiple(type_traits<output_type>::total_byte_size(dims), 64ull) };
 		static constexpr layer_op_type layer_type{ layer_op_type::per_block };
 		static constexpr kernel_type krn_type{ kernel_type::reshape };
@@ -607,9 +628,9 @@ namespace nihilus {
 		using input_type03		= core_traits<config, llama_op_types::rope_freqs_weight>;
 		using output_type		= typename kernel_type_profile_traits<config.kernel_profile>::query_type;
 		static constexpr uint64_t depth{ std::max(input_type01::depth, input_type02::depth) + 1 };
-		static constexpr bool dequantization{ requires_dequant_or_quant<typename input_type01::output_type, typename input_type02::output_type>::required };
+		static constexpr bool dequantization{ requires_dequant_or_quant<typename input_type01::output_type, output_type>::required };
 		static constexpr alloc_type alc_type{ alloc_type::single_alloc };
-		static constexpr array<uint64_t, 4> dims{ { model_traits_type::head_dim, model_traits_type::max_sequence_length, model_traits_type::head_count, 1 } };
+		static constexpr array<uint64_t, 4> dims{ { model_traits_type::head_dim, sequence_traits<config>::batch_length, model_traits_type::head_count, 1 } };
 		static constexpr uint64_t total_required_bytes{ roundUpToMultiple(
 			type_traits<output_type>::total_byte_size(dims) + (dequantization ? type_traits<output_type>::total_byte_size(dims) : 0), 64ull) };
 		static constexpr layer_op_type layer_type{ layer_op_type::per_block };
@@ -636,7 +657,7 @@ namespace nihilus {
 		static constexpr uint64_t depth{ std::max(input_type01::depth, input_type02::depth) + 1 };
 		static constexpr alloc_type alc_type{ alloc_type::single_alloc };
 		static constexpr bool dequantization{ requires_dequant_or_quant<typename input_type01::output_type, typename input_type02::output_type>::required };
-		static constexpr array<uint64_t, 4> dims{ { model_traits_type::head_count_kv * model_traits_type::head_dim, model_traits_type::max_sequence_length, 1, 1 } };
+		static constexpr array<uint64_t, 4> dims{ { model_traits_type::head_count_kv * model_traits_type::head_dim, sequence_traits<config>::batch_length, 1, 1 } };
 		static constexpr uint64_t total_required_bytes{ roundUpToMultiple(
 			type_traits<output_type>::total_byte_size(dims) + (dequantization ? type_traits<output_type>::total_byte_size(dims) : 0), 64ull) };
 		static constexpr layer_op_type layer_type{ layer_op_type::per_block };
@@ -663,7 +684,7 @@ namespace nihilus {
 		using output_type		= typename kernel_type_profile_traits<config.kernel_profile>::key_type;
 		static constexpr uint64_t depth{ input_type01::depth + 1 };
 		static constexpr alloc_type alc_type{ alloc_type::single_alloc };
-		static constexpr array<uint64_t, 4> dims{ { model_traits_type::head_dim, model_traits_type::max_sequence_length, model_traits_type::head_count_kv, 1 } };
+		static constexpr array<uint64_t, 4> dims{ { model_traits_type::head_dim, sequence_traits<config>::batch_length, model_traits_type::head_count_kv, 1 } };
 		static constexpr uint64_t total_required_bytes{ roundUpToMultiple(type_traits<output_type>::total_byte_size(dims), 64ull) };
 		static constexpr layer_op_type layer_type{ layer_op_type::per_block };
 		static constexpr kernel_type krn_type{ kernel_type::reshape };
@@ -688,9 +709,9 @@ namespace nihilus {
 		using input_type03		= core_traits<config, llama_op_types::rope_freqs_weight>;
 		using output_type		= typename kernel_type_profile_traits<config.kernel_profile>::key_type;
 		static constexpr uint64_t depth{ std::max(std::max(input_type01::depth, input_type02::depth), input_type03::depth) + 1 };
-		static constexpr bool dequantization{ requires_dequant_or_quant<typename input_type01::output_type, typename input_type02::output_type>::required };
+		static constexpr bool dequantization{ requires_dequant_or_quant<typename input_type01::output_type, output_type>::required };
 		static constexpr alloc_type alc_type{ alloc_type::single_alloc };
-		static constexpr array<uint64_t, 4> dims{ { model_traits_type::head_dim, model_traits_type::max_sequence_length, model_traits_type::head_count_kv, 1 } };
+		static constexpr array<uint64_t, 4> dims{ { model_traits_type::head_dim, sequence_traits<config>::batch_length, model_traits_type::head_count_kv, 1 } };
 		static constexpr uint64_t total_required_bytes{ roundUpToMultiple(
 			type_traits<output_type>::total_byte_size(dims) + (dequantization ? type_traits<output_type>::total_byte_size(dims) : 0), 64ull) };
 		static constexpr layer_op_type layer_type{ layer_op_type::per_block };
@@ -717,7 +738,7 @@ namespace nihilus {
 		static constexpr uint64_t depth{ std::max(input_type01::depth, input_type02::depth) + 1 };
 		static constexpr alloc_type alc_type{ alloc_type::single_alloc };
 		static constexpr bool dequantization{ requires_dequant_or_quant<typename input_type01::output_type, typename input_type02::output_type>::required };
-		static constexpr array<uint64_t, 4> dims{ { (model_traits_type::head_dim * model_traits_type::head_count_kv), model_traits_type::max_sequence_length, 1, 1 } };
+		static constexpr array<uint64_t, 4> dims{ { (model_traits_type::head_dim * model_traits_type::head_count_kv), sequence_traits<config>::batch_length, 1, 1 } };
 		static constexpr uint64_t total_required_bytes{ roundUpToMultiple(
 			type_traits<output_type>::total_byte_size(dims) + (dequantization ? type_traits<output_type>::total_byte_size(dims) : 0), 64ull) };
 		static constexpr layer_op_type layer_type{ layer_op_type::per_block };
@@ -744,7 +765,7 @@ namespace nihilus {
 		using output_type		= typename kernel_type_profile_traits<config.kernel_profile>::kv_cache_type;
 		static constexpr uint64_t depth{ input_type01::depth + 1 };
 		static constexpr alloc_type alc_type{ alloc_type::single_alloc };
-		static constexpr array<uint64_t, 4> dims{ { model_traits_type::head_count_kv * model_traits_type::head_dim, model_traits_type::max_sequence_length, 1, 1 } };
+		static constexpr array<uint64_t, 4> dims{ { model_traits_type::head_count_kv * model_traits_type::head_dim, sequence_traits<config>::batch_length, 1, 1 } };
 		static constexpr uint64_t total_required_bytes{ 0 };
 		static constexpr layer_op_type layer_type{ layer_op_type::per_block };
 		static constexpr kernel_type krn_type{ kernel_type::view };
@@ -768,7 +789,7 @@ namespace nihilus {
 		using output_type		= typename core_traits<config, llama_op_types::k_cache_view>::output_type;
 		static constexpr uint64_t depth{ input_type01::depth + 1 };
 		static constexpr alloc_type alc_type{ alloc_type::single_alloc };
-		static constexpr array<uint64_t, 4> dims{ { model_traits_type::head_count_kv * model_traits_type::head_dim, model_traits_type::max_sequence_length, 1, 1 } };
+		static constexpr array<uint64_t, 4> dims{ { model_traits_type::head_count_kv * model_traits_type::head_dim, sequence_traits<config>::batch_length, 1, 1 } };
 		static constexpr uint64_t total_required_bytes{ 0 };
 		static constexpr layer_op_type layer_type{ layer_op_type::per_block };
 		static constexpr kernel_type krn_type{ kernel_type::copy };
@@ -792,7 +813,7 @@ namespace nihilus {
 		using output_type		= typename kernel_type_profile_traits<config.kernel_profile>::value_type;
 		static constexpr uint64_t depth{ input_type01::depth + 1 };
 		static constexpr alloc_type alc_type{ alloc_type::single_alloc };
-		static constexpr array<uint64_t, 4> dims{ { model_traits_type::max_sequence_length, (model_traits_type::head_dim * model_traits_type::head_count_kv), 1, 1 } };
+		static constexpr array<uint64_t, 4> dims{ { sequence_traits<config>::batch_length, (model_traits_type::head_dim * model_traits_type::head_count_kv), 1, 1 } };
 		static constexpr uint64_t total_required_bytes{ roundUpToMultiple(type_traits<output_type>::total_byte_size(dims), 64ull) };
 		static constexpr layer_op_type layer_type{ layer_op_type::per_block };
 		static constexpr kernel_type krn_type{ kernel_type::transpose };
@@ -816,7 +837,7 @@ namespace nihilus {
 		using output_type		= typename kernel_type_profile_traits<config.kernel_profile>::kv_cache_type;
 		static constexpr uint64_t depth{ input_type01::depth + 1 };
 		static constexpr alloc_type alc_type{ alloc_type::single_alloc };
-		static constexpr array<uint64_t, 4> dims{ { model_traits_type::max_sequence_length, (model_traits_type::head_count_kv * model_traits_type::head_dim), 1, 1 } };
+		static constexpr array<uint64_t, 4> dims{ { sequence_traits<config>::batch_length, (model_traits_type::head_count_kv * model_traits_type::head_dim), 1, 1 } };
 		static constexpr uint64_t total_required_bytes{ 0 };
 		static constexpr layer_op_type layer_type{ layer_op_type::per_block };
 		static constexpr kernel_type krn_type{ kernel_type::view };
@@ -840,7 +861,7 @@ namespace nihilus {
 		using output_type		= typename core_traits<config, llama_op_types::v_cache_view>::output_type;
 		static constexpr uint64_t depth{ input_type01::depth + 1 };
 		static constexpr alloc_type alc_type{ alloc_type::single_alloc };
-		static constexpr array<uint64_t, 4> dims{ { model_traits_type::max_sequence_length, (model_traits_type::head_count_kv * model_traits_type::head_dim), 1, 1 } };
+		static constexpr array<uint64_t, 4> dims{ { sequence_traits<config>::batch_length, (model_traits_type::head_count_kv * model_traits_type::head_dim), 1, 1 } };
 		static constexpr uint64_t total_required_bytes{ 0 };
 		static constexpr layer_op_type layer_type{ layer_op_type::per_block };
 		static constexpr kernel_type krn_type{ kernel_type::copy };
@@ -864,7 +885,7 @@ namespace nihilus {
 		using output_type		= typename kernel_type_profile_traits<config.kernel_profile>::scale_type;
 		static constexpr uint64_t depth{ input_type01::depth + 1 };
 		static constexpr alloc_type alc_type{ alloc_type::single_alloc };
-		static constexpr array<uint64_t, 4> dims{ { model_traits_type::max_sequence_length, model_traits_type::head_dim, model_traits_type::head_count_kv, 1 } };
+		static constexpr array<uint64_t, 4> dims{ { sequence_traits<config>::context_length, model_traits_type::head_dim, model_traits_type::head_count_kv, 1 } };
 		static constexpr uint64_t total_required_bytes{ 0 };
 		static constexpr layer_op_type layer_type{ layer_op_type::per_block };
 		static constexpr kernel_type krn_type{ kernel_type::view };
@@ -888,7 +909,7 @@ namespace nihilus {
 		using output_type		= typename kernel_type_profile_traits<config.kernel_profile>::scale_type;
 		static constexpr uint64_t depth{ input_type01::depth + 1 };
 		static constexpr alloc_type alc_type{ alloc_type::single_alloc };
-		static constexpr array<uint64_t, 4> dims{ { model_traits_type::head_dim, model_traits_type::max_sequence_length, model_traits_type::head_count_kv, 1 } };
+		static constexpr array<uint64_t, 4> dims{ { model_traits_type::head_dim, sequence_traits<config>::context_length, model_traits_type::head_count_kv, 1 } };
 		static constexpr uint64_t total_required_bytes{ 0 };
 		static constexpr layer_op_type layer_type{ layer_op_type::per_block };
 		static constexpr kernel_type krn_type{ kernel_type::view };
@@ -912,7 +933,7 @@ namespace nihilus {
 		using output_type		= typename kernel_type_profile_traits<config.kernel_profile>::query_type;
 		static constexpr uint64_t depth{ input_type01::depth + 1 };
 		static constexpr alloc_type alc_type{ alloc_type::single_alloc };
-		static constexpr array<uint64_t, 4> dims{ { model_traits_type::head_dim, model_traits_type::max_sequence_length, model_traits_type::head_count, 1 } };
+		static constexpr array<uint64_t, 4> dims{ { model_traits_type::head_dim, sequence_traits<config>::batch_length, model_traits_type::head_count, 1 } };
 		static constexpr uint64_t total_required_bytes{ 0 };
 		static constexpr layer_op_type layer_type{ layer_op_type::per_block };
 		static constexpr kernel_type krn_type{ kernel_type::permute };
@@ -938,7 +959,7 @@ namespace nihilus {
 		static constexpr uint64_t depth{ std::max(input_type01::depth, input_type02::depth) + 1 };
 		static constexpr alloc_type alc_type{ alloc_type::single_alloc };
 		static constexpr bool dequantization{ requires_dequant_or_quant<typename input_type01::output_type, typename input_type02::output_type>::required };
-		static constexpr array<uint64_t, 4> dims{ { model_traits_type::max_sequence_length, 1, model_traits_type::head_count, 1 } };
+		static constexpr array<uint64_t, 4> dims{ { sequence_traits<config>::context_length, sequence_traits<config>::batch_length, model_traits_type::head_count, 1 } };
 		static constexpr uint64_t total_required_bytes{ roundUpToMultiple(
 			type_traits<output_type>::total_byte_size(dims) + (dequantization ? type_traits<output_type>::total_byte_size(dims) : 0), 64ull) };
 		static constexpr layer_op_type layer_type{ layer_op_type::per_block };
@@ -962,12 +983,11 @@ namespace nihilus {
 		using model_traits_type = model_traits<config.arch, config.model_size, config.model_generation>;
 		using this_type			= core_traits<config, llama_op_types::kq_soft_max>;
 		using input_type01		= core_traits<config, llama_op_types::kq>;
-		using input_type02		= core_traits<config, llama_op_types::kq_mask>;
 		using output_type		= typename kernel_type_profile_traits<config.kernel_profile>::softmax_type;
-		static constexpr uint64_t depth{ std::max(input_type01::depth, input_type02::depth) + 1 };
-		static constexpr bool dequantization{ requires_dequant_or_quant<typename input_type01::output_type, typename input_type02::output_type>::required };
+		static constexpr uint64_t depth{ input_type01::depth + 1 };
+		static constexpr bool dequantization{ requires_dequant_or_quant<typename input_type01::output_type, output_type>::required };
 		static constexpr alloc_type alc_type{ alloc_type::single_alloc };
-		static constexpr array<uint64_t, 4> dims{ { model_traits_type::max_sequence_length, 1, model_traits_type::head_count, 1 } };
+		static constexpr array<uint64_t, 4> dims{ { sequence_traits<config>::context_length, sequence_traits<config>::batch_length, model_traits_type::head_count, 1 } };
 		static constexpr uint64_t total_required_bytes{ roundUpToMultiple(
 			type_traits<output_type>::total_byte_size(dims) + (dequantization ? type_traits<output_type>::total_byte_size(dims) : 0), 64ull) };
 		static constexpr layer_op_type layer_type{ layer_op_type::per_block };
@@ -976,6 +996,7 @@ namespace nihilus {
 		array<slim_latch, model_traits_type::block_count> sync_flag_start{};
 		array<slim_latch, model_traits_type::block_count> sync_flag_end{};
 		static constexpr uint64_t count{ total_required_bytes / sizeof(output_type) };
+		attention_mask<config> mask{};
 		output_type* data{};
 		int32_t value{};
 	};
@@ -996,7 +1017,7 @@ namespace nihilus {
 		static constexpr uint64_t depth{ std::max(input_type01::depth, input_type02::depth) + 1 };
 		static constexpr alloc_type alc_type{ alloc_type::single_alloc };
 		static constexpr bool dequantization{ requires_dequant_or_quant<typename input_type01::output_type, typename input_type02::output_type>::required };
-		static constexpr array<uint64_t, 4> dims{ { model_traits_type::head_dim, 1, model_traits_type::head_count, 1 } };
+		static constexpr array<uint64_t, 4> dims{ { model_traits_type::head_dim, sequence_traits<config>::batch_length, model_traits_type::head_count, 1 } };
 		static constexpr uint64_t total_required_bytes{ roundUpToMultiple(
 			type_traits<output_type>::total_byte_size(dims) + (dequantization ? type_traits<output_type>::total_byte_size(dims) : 0), 64ull) };
 		static constexpr layer_op_type layer_type{ layer_op_type::per_block };
@@ -1023,7 +1044,7 @@ namespace nihilus {
 		using output_type		= typename kernel_type_profile_traits<config.kernel_profile>::value_type;
 		static constexpr uint64_t depth{ input_type01::depth + 1 };
 		static constexpr alloc_type alc_type{ alloc_type::single_alloc };
-		static constexpr array<uint64_t, 4> dims{ { model_traits_type::head_dim, model_traits_type::head_count, 1, 1 } };
+		static constexpr array<uint64_t, 4> dims{ { model_traits_type::head_dim, model_traits_type::head_count, sequence_traits<config>::batch_length, 1 } };
 		static constexpr uint64_t total_required_bytes{ 0 };
 		static constexpr layer_op_type layer_type{ layer_op_type::per_block };
 		static constexpr kernel_type krn_type{ kernel_type::permute };
@@ -1047,7 +1068,7 @@ namespace nihilus {
 		using output_type		= typename kernel_type_profile_traits<config.kernel_profile>::value_type;
 		static constexpr uint64_t depth{ input_type01::depth + 1 };
 		static constexpr alloc_type alc_type{ alloc_type::single_alloc };
-		static constexpr array<uint64_t, 4> dims{ { model_traits_type::embedding_dim, 1, 1, 1 } };
+		static constexpr array<uint64_t, 4> dims{ { model_traits_type::embedding_dim, sequence_traits<config>::batch_length, 1, 1 } };
 		static constexpr uint64_t total_required_bytes{ 0 };
 		static constexpr layer_op_type layer_type{ layer_op_type::per_block };
 		static constexpr kernel_type krn_type{ kernel_type::cont };
@@ -1073,7 +1094,7 @@ namespace nihilus {
 		static constexpr uint64_t depth{ std::max(input_type01::depth, input_type02::depth) + 1 };
 		static constexpr alloc_type alc_type{ alloc_type::single_alloc };
 		static constexpr bool dequantization{ requires_dequant_or_quant<typename input_type01::output_type, typename input_type02::output_type>::required };
-		static constexpr array<uint64_t, 4> dims{ { model_traits_type::embedding_dim, model_traits_type::max_sequence_length, 1, 1 } };
+		static constexpr array<uint64_t, 4> dims{ { model_traits_type::embedding_dim, sequence_traits<config>::batch_length, 1, 1 } };
 		static constexpr uint64_t total_required_bytes{ roundUpToMultiple(
 			type_traits<output_type>::total_byte_size(dims) + (dequantization ? type_traits<output_type>::total_byte_size(dims) : 0), 64ull) };
 		static constexpr layer_op_type layer_type{ layer_op_type::per_block };
@@ -1102,7 +1123,7 @@ namespace nihilus {
 		static constexpr uint64_t depth{ input_type01::depth + 1 };
 		static constexpr alloc_type alc_type{ alloc_type::single_alloc };
 		static constexpr bool dequantization{ requires_dequant_or_quant<typename input_type01::output_type, typename input_type02::output_type>::required };
-		static constexpr array<uint64_t, 4> dims{ { model_traits_type::embedding_dim, model_traits_type::max_sequence_length, 1, 1 } };
+		static constexpr array<uint64_t, 4> dims{ { model_traits_type::embedding_dim, sequence_traits<config>::batch_length, 1, 1 } };
 		static constexpr uint64_t total_required_bytes{ roundUpToMultiple(
 			type_traits<output_type>::total_byte_size(dims) + (dequantization ? type_traits<output_type>::total_byte_size(dims) : 0), 64ull) };
 		static constexpr layer_op_type layer_type{ layer_op_type::per_block };
@@ -1128,7 +1149,7 @@ namespace nihilus {
 		static constexpr uint64_t depth{ input_type01::depth + 1 };
 		static constexpr bool dequantization{ requires_dequant_or_quant<typename input_type01::output_type, output_type>::required };
 		static constexpr alloc_type alc_type{ alloc_type::single_alloc };
-		static constexpr array<uint64_t, 4> dims{ { model_traits_type::embedding_dim, model_traits_type::max_sequence_length, 1, 1 } };
+		static constexpr array<uint64_t, 4> dims{ { model_traits_type::embedding_dim, sequence_traits<config>::batch_length, 1, 1 } };
 		static constexpr uint64_t total_required_bytes{ roundUpToMultiple(
 			type_traits<output_type>::total_byte_size(dims) + (dequantization ? type_traits<output_type>::total_byte_size(dims) : 0), 64ull) };
 		static constexpr layer_op_type layer_type{ layer_op_type::per_block };
@@ -1155,7 +1176,7 @@ namespace nihilus {
 		static constexpr uint64_t depth{ std::max(input_type01::depth, input_type02::depth) + 1 };
 		static constexpr bool dequantization{ requires_dequant_or_quant<typename input_type01::output_type, typename input_type02::output_type>::required };
 		static constexpr alloc_type alc_type{ alloc_type::single_alloc };
-		static constexpr array<uint64_t, 4> dims{ { model_traits_type::embedding_dim, model_traits_type::max_sequence_length, 1, 1 } };
+		static constexpr array<uint64_t, 4> dims{ { model_traits_type::embedding_dim, sequence_traits<config>::batch_length, 1, 1 } };
 		static constexpr uint64_t total_required_bytes{ roundUpToMultiple(
 			type_traits<output_type>::total_byte_size(dims) + (dequantization ? type_traits<output_type>::total_byte_size(dims) : 0), 64ull) };
 		static constexpr layer_op_type layer_type{ layer_op_type::per_block };
@@ -1182,7 +1203,7 @@ namespace nihilus {
 		static constexpr uint64_t depth{ std::max(input_type01::depth, input_type02::depth) + 1 };
 		static constexpr alloc_type alc_type{ alloc_type::single_alloc };
 		static constexpr bool dequantization{ requires_dequant_or_quant<typename input_type01::output_type, typename input_type02::output_type>::required };
-		static constexpr array<uint64_t, 4> dims{ { model_traits_type::feed_forward_length, model_traits_type::max_sequence_length, 1, 1 } };
+		static constexpr array<uint64_t, 4> dims{ { model_traits_type::feed_forward_length, sequence_traits<config>::batch_length, 1, 1 } };
 		static constexpr uint64_t total_required_bytes{ roundUpToMultiple(
 			type_traits<output_type>::total_byte_size(dims) + (dequantization ? type_traits<output_type>::total_byte_size(dims) : 0), 64ull) };
 		static constexpr layer_op_type layer_type{ layer_op_type::per_block };
@@ -1210,7 +1231,7 @@ namespace nihilus {
 		static constexpr uint64_t depth{ input_type01::depth + 1 };
 		static constexpr bool dequantization{ requires_dequant_or_quant<typename input_type01::output_type, output_type>::required };
 		static constexpr alloc_type alc_type{ alloc_type::single_alloc };
-		static constexpr array<uint64_t, 4> dims{ { model_traits_type::feed_forward_length, model_traits_type::max_sequence_length, 1, 1 } };
+		static constexpr array<uint64_t, 4> dims{ { model_traits_type::feed_forward_length, sequence_traits<config>::batch_length, 1, 1 } };
 		static constexpr uint64_t total_required_bytes{ roundUpToMultiple(
 			type_traits<output_type>::total_byte_size(dims) + (dequantization ? type_traits<output_type>::total_byte_size(dims) : 0), 64ull) };
 		static constexpr layer_op_type layer_type{ layer_op_type::per_block };
@@ -1237,7 +1258,7 @@ namespace nihilus {
 		static constexpr uint64_t depth{ std::max(input_type01::depth, input_type02::depth) + 1 };
 		static constexpr alloc_type alc_type{ alloc_type::single_alloc };
 		static constexpr bool dequantization{ requires_dequant_or_quant<typename input_type01::output_type, typename input_type02::output_type>::required };
-		static constexpr array<uint64_t, 4> dims{ { model_traits_type::feed_forward_length, model_traits_type::max_sequence_length, 1, 1 } };
+		static constexpr array<uint64_t, 4> dims{ { model_traits_type::feed_forward_length, sequence_traits<config>::batch_length, 1, 1 } };
 		static constexpr uint64_t total_required_bytes{ roundUpToMultiple(
 			type_traits<output_type>::total_byte_size(dims) + (dequantization ? type_traits<output_type>::total_byte_size(dims) : 0), 64ull) };
 		static constexpr layer_op_type layer_type{ layer_op_type::per_block };
@@ -1266,7 +1287,7 @@ namespace nihilus {
 		static constexpr uint64_t depth{ std::max(input_type01::depth, input_type02::depth) + 1 };
 		static constexpr bool dequantization{ requires_dequant_or_quant<typename input_type01::output_type, typename input_type02::output_type>::required };
 		static constexpr alloc_type alc_type{ alloc_type::single_alloc };
-		static constexpr array<uint64_t, 4> dims{ { model_traits_type::feed_forward_length, model_traits_type::max_sequence_length, 1, 1 } };
+		static constexpr array<uint64_t, 4> dims{ { model_traits_type::feed_forward_length, sequence_traits<config>::batch_length, 1, 1 } };
 		static constexpr uint64_t total_required_bytes{ roundUpToMultiple(
 			type_traits<output_type>::total_byte_size(dims) + (dequantization ? type_traits<output_type>::total_byte_size(dims) : 0), 64ull) };
 		static constexpr layer_op_type layer_type{ layer_op_type::per_block };
@@ -1293,7 +1314,7 @@ namespace nihilus {
 		static constexpr uint64_t depth{ std::max(input_type01::depth, input_type02::depth) + 1 };
 		static constexpr alloc_type alc_type{ alloc_type::single_alloc };
 		static constexpr bool dequantization{ requires_dequant_or_quant<typename input_type01::output_type, typename input_type02::output_type>::required };
-		static constexpr array<uint64_t, 4> dims{ { model_traits_type::embedding_dim, model_traits_type::max_sequence_length, 1, 1 } };
+		static constexpr array<uint64_t, 4> dims{ { model_traits_type::embedding_dim, sequence_traits<config>::batch_length, 1, 1 } };
 		static constexpr uint64_t total_required_bytes{ roundUpToMultiple(
 			type_traits<output_type>::total_byte_size(dims) + (dequantization ? type_traits<output_type>::total_byte_size(dims) : 0), 64ull) };
 		static constexpr layer_op_type layer_type{ layer_op_type::per_block };
@@ -1322,7 +1343,7 @@ namespace nihilus {
 		static constexpr uint64_t depth{ std::max(input_type01::depth, input_type02::depth) + 1 };
 		static constexpr bool dequantization{ requires_dequant_or_quant<typename input_type01::output_type, typename input_type02::output_type>::required };
 		static constexpr alloc_type alc_type{ alloc_type::single_alloc };
-		static constexpr array<uint64_t, 4> dims{ { model_traits_type::embedding_dim, model_traits_type::max_sequence_length, 1, 1 } };
+		static constexpr array<uint64_t, 4> dims{ { model_traits_type::embedding_dim, sequence_traits<config>::batch_length, 1, 1 } };
 		static constexpr uint64_t total_required_bytes{ roundUpToMultiple(
 			type_traits<output_type>::total_byte_size(dims) + (dequantization ? type_traits<output_type>::total_byte_size(dims) : 0), 64ull) };
 		static constexpr layer_op_type layer_type{ layer_op_type::per_block };
@@ -1349,7 +1370,7 @@ namespace nihilus {
 		static constexpr uint64_t depth{ std::max(input_type01::depth, input_type02::depth) + 1 };
 		static constexpr bool dequantization{ requires_dequant_or_quant<typename input_type01::output_type, typename input_type02::output_type>::required };
 		static constexpr alloc_type alc_type{ alloc_type::single_alloc };
-		static constexpr array<uint64_t, 4> dims{ { model_traits_type::embedding_dim, model_traits_type::max_sequence_length, 1, 1 } };
+		static constexpr array<uint64_t, 4> dims{ { model_traits_type::embedding_dim, sequence_traits<config>::batch_length, 1, 1 } };
 		static constexpr uint64_t total_required_bytes{ roundUpToMultiple(
 			type_traits<output_type>::total_byte_size(dims) + (dequantization ? type_traits<output_type>::total_byte_size(dims) : 0), 64ull) };
 		static constexpr layer_op_type layer_type{ layer_op_type::global_output };
@@ -1376,7 +1397,7 @@ namespace nihilus {
 		static constexpr uint64_t depth{ std::max(input_type01::depth, input_type02::depth) + 1 };
 		static constexpr bool dequantization{ requires_dequant_or_quant<typename input_type01::output_type, typename input_type02::output_type>::required };
 		static constexpr alloc_type alc_type{ alloc_type::single_alloc };
-		static constexpr array<uint64_t, 4> dims{ { model_traits_type::embedding_dim, model_traits_type::max_sequence_length, 1, 1 } };
+		static constexpr array<uint64_t, 4> dims{ { model_traits_type::embedding_dim, sequence_traits<config>::batch_length, 1, 1 } };
 		static constexpr uint64_t total_required_bytes{ roundUpToMultiple(
 			type_traits<output_type>::total_byte_size(dims) + (dequantization ? type_traits<output_type>::total_byte_size(dims) : 0), 64ull) };
 		static constexpr layer_op_type layer_type{ layer_op_type::global_output };
@@ -1402,7 +1423,7 @@ namespace nihilus {
 		static constexpr uint64_t depth{ input_type01::depth + 1 };
 		static constexpr bool dequantization{ requires_dequant_or_quant<typename input_type01::output_type, output_type>::required };
 		static constexpr alloc_type alc_type{ alloc_type::single_alloc };
-		static constexpr array<uint64_t, 4> dims{ { model_traits_type::embedding_dim, model_traits_type::max_sequence_length, 1, 1 } };
+		static constexpr array<uint64_t, 4> dims{ { model_traits_type::embedding_dim, sequence_traits<config>::batch_length, 1, 1 } };
 		static constexpr uint64_t total_required_bytes{ roundUpToMultiple(
 			type_traits<output_type>::total_byte_size(dims) + (dequantization ? type_traits<output_type>::total_byte_size(dims) : 0), 64ull) };
 		static constexpr layer_op_type layer_type{ layer_op_type::global_output };
@@ -1429,7 +1450,7 @@ namespace nihilus {
 		static constexpr uint64_t depth{ std::max(input_type01::depth, input_type02::depth) + 1 };
 		static constexpr bool dequantization{ requires_dequant_or_quant<typename input_type01::output_type, typename input_type02::output_type>::required };
 		static constexpr alloc_type alc_type{ alloc_type::single_alloc };
-		static constexpr array<uint64_t, 4> dims{ { model_traits_type::embedding_dim, model_traits_type::max_sequence_length, 1, 1 } };
+		static constexpr array<uint64_t, 4> dims{ { model_traits_type::embedding_dim, sequence_traits<config>::batch_length, 1, 1 } };
 		static constexpr uint64_t total_required_bytes{ roundUpToMultiple(
 			type_traits<output_type>::total_byte_size(dims) + (dequantization ? type_traits<output_type>::total_byte_size(dims) : 0), 64ull) };
 		static constexpr layer_op_type layer_type{ layer_op_type::global_output };
@@ -1455,7 +1476,7 @@ namespace nihilus {
 		static constexpr uint64_t depth{ std::max(input_type01::depth, input_type02::depth) + 1 };
 		static constexpr alloc_type alc_type{ alloc_type::single_alloc };
 		static constexpr bool dequantization{ requires_dequant_or_quant<typename input_type01::output_type, typename input_type02::output_type>::required };
-		static constexpr array<uint64_t, 4> dims{ { model_traits_type::vocab_size, model_traits_type::max_sequence_length, 1, 1 } };
+		static constexpr array<uint64_t, 4> dims{ { model_traits_type::vocab_size, sequence_traits<config>::batch_length, 1, 1 } };
 		static constexpr uint64_t total_required_bytes{ roundUpToMultiple(
 			type_traits<output_type>::total_byte_size(dims) + (dequantization ? type_traits<output_type>::total_byte_size(dims) : 0), 64ull) };
 		static constexpr layer_op_type layer_type{ layer_op_type::global_output };
@@ -1488,6 +1509,14 @@ namespace nihilus {
 		}
 	};
 
+	template<typename core_traits_type> NIHILUS_FORCE_INLINE auto get_block_data(core_traits_type& core, uint64_t current_block) {
+		if constexpr (array_type<decltype(core.data)>) {
+			return core.data[current_block];
+		} else {
+			return core.data;
+		}
+	}
+
 	template<typename... bases> struct core_bases : bases... {
 		NIHILUS_FORCE_INLINE core_bases() noexcept					  = default;
 		NIHILUS_FORCE_INLINE core_bases& operator=(core_bases&&)	  = delete;
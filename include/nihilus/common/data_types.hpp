@@ -20,7 +20,10 @@ RealTimeChris (Chris M.)
 
 #pragma once
 
+#include <nihilus/common/config.hpp>
 #include <cstdint>
+#include <cmath>
+#include <bit>
 
 namespace nihilus {
 
@@ -39,4 +42,39 @@ namespace nihilus {
 	};
 	static_assert(sizeof(block_q8_0<half>) == sizeof(half) + Q_SIZE, "Wrong q8_0 block size/padding.");
 
+	// One block column of row_count consecutive rows: scales grouped up front, quants interleaved in 8-byte runs (row 0, row 1, ..., row 0, ...).
+	template<typename half_type, uint64_t row_count> struct block_q8_0_interleaved {
+		half_type d[row_count];
+		int8_t qs[Q_SIZE * row_count];
+	};
+	static_assert(sizeof(block_q8_0_interleaved<half, 4>) == 4 * sizeof(block_q8_0<half>), "Wrong interleaved q8_0 block size/padding.");
+	static_assert(sizeof(block_q8_0_interleaved<half, 8>) == 8 * sizeof(block_q8_0<half>), "Wrong interleaved q8_0 block size/padding.");
+
+	NIHILUS_FORCE_INLINE float fp16_to_fp32(fp16_t value) noexcept {
+		const uint32_t w					   = static_cast<uint32_t>(value) << 16;
+		const uint32_t sign					   = w & 0x80000000u;
+		const uint32_t two_w				   = w + w;
+		static constexpr uint32_t exp_offset   = 0xE0u << 23;
+		const float normalized_value		   = std::bit_cast<float>((two_w >> 4) + exp_offset) * 0x1.0p-112f;
+		const float denormalized_value		   = std::bit_cast<float>((two_w >> 17) | (126u << 23)) - 0.5f;
+		static constexpr uint32_t denorm_cutoff = 1u << 27;
+		return std::bit_cast<float>(sign | (two_w < denorm_cutoff ? std::bit_cast<uint32_t>(denormalized_value) : std::bit_cast<uint32_t>(normalized_value)));
+	}
+
+	NIHILUS_FORCE_INLINE fp16_t fp32_to_fp16(float value) noexcept {
+		float base			 = (std::fabs(value) * 0x1.0p+112f) * 0x1.0p-110f;
+		const uint32_t w	 = std::bit_cast<uint32_t>(value);
+		const uint32_t shl1_w = w + w;
+		const uint32_t sign	 = w & 0x80000000u;
+		uint32_t bias		 = shl1_w & 0xFF000000u;
+		if (bias < 0x71000000u) {
+			bias = 0x71000000u;
+		}
+		base						 = std::bit_cast<float>((bias >> 1) + 0x07800000u) + base;
+		const uint32_t bits			 = std::bit_cast<uint32_t>(base);
+		const uint32_t exp_bits		 = (bits >> 13) & 0x00007C00u;
+		const uint32_t mantissa_bits = bits & 0x00000FFFu;
+		return static_cast<fp16_t>((sign >> 16) | (shl1_w > 0xFF000000u ? 0x7E00u : exp_bits + mantissa_bits));
+	}
+
 }
@@ -0,0 +1,383 @@
+/*
+Copyright (c) 2025 RealTimeChris (Chris M.)
+
+This file is part of software offered under a restricted-use license to a designated Licensee,
+whose identity is confirmed in writing by the Author.
+
+License Terms (Summary):
+- Exclusive, non-transferable license for internal use only.
+- Redistribution, sublicensing, or public disclosure is prohibited without written consent.
+- Full ownership remains with the Author.
+- License may terminate if unused for [X months], if materially breached, or by mutual agreement.
+- No warranty is provided, express or implied.
+
+Full license terms are provided in the LICENSE file distributed with this software.
+
+Signed,
+RealTimeChris (Chris M.)
+2025
+*/
+
+#pragma once
+
+#include <nihilus/common/allocator.hpp>
+#include <nihilus/common/config.hpp>
+#include <nihilus/common/common.hpp>
+#include <filesystem>
+#include <stdexcept>
+#include <iostream>
+#include <string>
+#include <atomic>
+
+#if defined(NIHILUS_PLATFORM_WINDOWS)
+	#include <Windows.h>
+#else
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <fcntl.h>
+	#include <unistd.h>
+	#include <cerrno>
+	#if defined(NIHILUS_PLATFORM_LINUX) && __has_include(<linux/io_uring.h>)
+		#include <linux/io_uring.h>
+		#include <sys/syscall.h>
+		#define NIHILUS_IO_URING 1
+	#endif
+#endif
+
+namespace nihilus {
+
+	// Reads large aligned ranges of a file straight into caller-owned memory, around the page cache where the platform allows it. Used for storage on
+	// which mmap faults are slow (network and overlay filesystems) or where the page cache is shared with other tenants.
+	template<bool exceptions> class direct_file_reader {
+	  public:
+		// Offsets, lengths and destinations handed to read() must be multiples of this; it covers the logical block size of every device we target.
+		static constexpr uint64_t alignment{ 4096 };
+		static constexpr uint64_t chunk_bytes{ 4ull * 1024ull * 1024ull };
+		static constexpr uint32_t queue_depth{ 32 };
+
+		NIHILUS_FORCE_INLINE direct_file_reader() noexcept = default;
+
+		NIHILUS_FORCE_INLINE direct_file_reader& operator=(const direct_file_reader&) = delete;
+		NIHILUS_FORCE_INLINE direct_file_reader(const direct_file_reader&)			  = delete;
+		NIHILUS_FORCE_INLINE direct_file_reader& operator=(direct_file_reader&&)	  = delete;
+		NIHILUS_FORCE_INLINE direct_file_reader(direct_file_reader&&)				  = delete;
+
+		NIHILUS_FORCE_INLINE explicit direct_file_reader(const std::filesystem::path& path, weight_reader requested = weight_reader::io_uring) {
+			open(path, requested);
+		}
+
+		NIHILUS_FORCE_INLINE bool open(const std::filesystem::path& path, weight_reader requested = weight_reader::io_uring) {
+			close();
+#if defined(NIHILUS_PLATFORM_WINDOWS)
+			file_handle = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_NO_BUFFERING | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+			if (file_handle == INVALID_HANDLE_VALUE) {
+				return report_error("Failed to open file: " + path.string());
+			}
+			LARGE_INTEGER file_size{};
+			if (!GetFileSizeEx(file_handle, &file_size)) {
+				return report_error("Failed to query file size: " + path.string());
+			}
+			size_val = static_cast<uint64_t>(file_size.QuadPart);
+			type_val = weight_reader::pread;
+			(void)requested;
+#else
+	#if defined(O_DIRECT)
+			file_descriptor = ::open(path.c_str(), O_RDONLY | O_DIRECT);
+			// tmpfs and some FUSE filesystems reject O_DIRECT outright; buffered reads are still better than faulting there.
+			if (file_descriptor == -1 && errno == EINVAL) {
+				file_descriptor = ::open(path.c_str(), O_RDONLY);
+			}
+	#else
+			file_descriptor = ::open(path.c_str(), O_RDONLY);
+		#if defined(F_NOCACHE)
+			if (file_descriptor != -1) {
+				fcntl(file_descriptor, F_NOCACHE, 1);
+			}
+		#endif
+	#endif
+			if (file_descriptor == -1) {
+				return report_error("Failed to open file: " + path.string());
+			}
+			struct stat file_stat {};
+			if (fstat(file_descriptor, &file_stat) != 0) {
+				return report_error("Failed to query file size: " + path.string());
+			}
+			size_val = static_cast<uint64_t>(file_stat.st_size);
+			type_val = weight_reader::pread;
+	#if defined(NIHILUS_IO_URING)
+			if (requested == weight_reader::io_uring && setup_ring()) {
+				type_val = weight_reader::io_uring;
+			}
+	#else
+			(void)requested;
+	#endif
+#endif
+			return true;
+		}
+
+		// Fills output with [offset, offset + length) of the file, or up to its end; bytes past the end of the file are left untouched.
+		NIHILUS_FORCE_INLINE bool read(uint8_t* output, uint64_t offset, uint64_t length) {
+			if (offset % alignment != 0 || length % alignment != 0 || reinterpret_cast<uintptr_t>(output) % alignment != 0) {
+				return report_error("Sorry, but direct reads must be aligned to " + std::to_string(alignment) + " bytes!");
+			}
+			length = std::min(length, roundUpToMultiple(size_val, alignment) - std::min(offset, roundUpToMultiple(size_val, alignment)));
+#if defined(NIHILUS_IO_URING)
+			if (type_val == weight_reader::io_uring) {
+				return read_ring(output, offset, length) || report_error("Sorry, but an io_uring read of the model file failed!");
+			}
+#endif
+			return read_blocking(output, offset, length) || report_error("Sorry, but a direct read of the model file failed!");
+		}
+
+		// The backend actually in use, after any fallback from the one requested.
+		NIHILUS_FORCE_INLINE weight_reader type() const noexcept {
+			return type_val;
+		}
+
+		NIHILUS_FORCE_INLINE uint64_t size() const noexcept {
+			return size_val;
+		}
+
+		NIHILUS_FORCE_INLINE explicit operator bool() const noexcept {
+#if defined(NIHILUS_PLATFORM_WINDOWS)
+			return file_handle != INVALID_HANDLE_VALUE;
+#else
+			return file_descriptor != -1;
+#endif
+		}
+
+		NIHILUS_FORCE_INLINE void close() noexcept {
+#if defined(NIHILUS_PLATFORM_WINDOWS)
+			if (file_handle != INVALID_HANDLE_VALUE) {
+				CloseHandle(file_handle);
+				file_handle = INVALID_HANDLE_VALUE;
+			}
+#else
+	#if defined(NIHILUS_IO_URING)
+			close_ring();
+	#endif
+			if (file_descriptor != -1) {
+				::close(file_descriptor);
+				file_descriptor = -1;
+			}
+#endif
+			size_val = 0;
+			type_val = weight_reader::pread;
+		}
+
+		NIHILUS_FORCE_INLINE ~direct_file_reader() noexcept {
+			close();
+		}
+
+	  protected:
+		uint64_t size_val{};
+		weight_reader type_val{ weight_reader::pread };
+#if defined(NIHILUS_PLATFORM_WINDOWS)
+		HANDLE file_handle{ INVALID_HANDLE_VALUE };
+#else
+		int file_descriptor{ -1 };
+#endif
+
+		// Reads one chunk at a time, resuming short reads; stops cleanly at the end of the file.
+		NIHILUS_FORCE_INLINE bool read_blocking(uint8_t* output, uint64_t offset, uint64_t length) {
+			uint64_t done{};
+			while (done < length) {
+				const uint64_t request{ std::min(chunk_bytes, length - done) };
+#if defined(NIHILUS_PLATFORM_WINDOWS)
+				OVERLAPPED overlapped{};
+				overlapped.Offset	  = static_cast<DWORD>((offset + done) & 0xFFFFFFFFull);
+				overlapped.OffsetHigh = static_cast<DWORD>((offset + done) >> 32);
+				DWORD result{};
+				if (!ReadFile(file_handle, output + done, static_cast<DWORD>(request), &result, &overlapped)) {
+					if (GetLastError() == ERROR_HANDLE_EOF) {
+						return true;
+					}
+					return false;
+				}
+#else
+				const ssize_t result{ ::pread(file_descriptor, output + done, request, static_cast<off_t>(offset + done)) };
+				if (result < 0) {
+					if (errno == EINTR) {
+						continue;
+					}
+					if (errno == EINVAL && drop_direct()) {
+						continue;
+					}
+					return false;
+				}
+#endif
+				if (result == 0) {
+					return true;
+				}
+				done += static_cast<uint64_t>(result);
+			}
+			return true;
+		}
+
+#if !defined(NIHILUS_PLATFORM_WINDOWS)
+		// Some filesystems accept O_DIRECT at open and only refuse it on the first read.
+		NIHILUS_FORCE_INLINE bool drop_direct() noexcept {
+	#if defined(O_DIRECT)
+			const int flags{ fcntl(file_descriptor, F_GETFL) };
+			return flags != -1 && (flags & O_DIRECT) && fcntl(file_descriptor, F_SETFL, flags & ~O_DIRECT) == 0;
+	#else
+			return false;
+	#endif
+		}
+#endif
+
+#if defined(NIHILUS_IO_URING)
+		int ring_descriptor{ -1 };
+		uint8_t* submission_ring{};
+		uint8_t* completion_ring{};
+		io_uring_sqe* submission_entries{};
+		uint64_t submission_ring_bytes{};
+		uint64_t completion_ring_bytes{};
+		uint64_t submission_entries_bytes{};
+		io_uring_params ring_params{};
+
+		template<typename value_type> NIHILUS_FORCE_INLINE value_type* ring_field(uint8_t* ring, uint32_t offset) noexcept {
+			return reinterpret_cast<value_type*>(ring + offset);
+		}
+
+		NIHILUS_FORCE_INLINE bool setup_ring() noexcept {
+			ring_params			  = io_uring_params{};
+			const long descriptor = syscall(__NR_io_uring_setup, queue_depth, &ring_params);
+			if (descriptor < 0) {
+				return false;
+			}
+			ring_descriptor			 = static_cast<int>(descriptor);
+			submission_ring_bytes	 = ring_params.sq_off.array + ring_params.sq_entries * sizeof(uint32_t);
+			completion_ring_bytes	 = ring_params.cq_off.cqes + ring_params.cq_entries * sizeof(io_uring_cqe);
+			submission_entries_bytes = ring_params.sq_entries * sizeof(io_uring_sqe);
+			const bool single_mmap{ (ring_params.features & IORING_FEAT_SINGLE_MMAP) != 0 };
+			if (single_mmap) {
+				submission_ring_bytes = completion_ring_bytes = std::max(submission_ring_bytes, completion_ring_bytes);
+			}
+			void* mapping{ mmap(nullptr, submission_ring_bytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_descriptor, IORING_OFF_SQ_RING) };
+			if (mapping == MAP_FAILED) {
+				close_ring();
+				return false;
+			}
+			submission_ring = static_cast<uint8_t*>(mapping);
+			if (single_mmap) {
+				completion_ring = submission_ring;
+			} else {
+				mapping = mmap(nullptr, completion_ring_bytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_descriptor, IORING_OFF_CQ_RING);
+				if (mapping == MAP_FAILED) {
+					close_ring();
+					return false;
+				}
+				completion_ring = static_cast<uint8_t*>(mapping);
+			}
+			mapping = mmap(nullptr, submission_entries_bytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_descriptor, IORING_OFF_SQES);
+			if (mapping == MAP_FAILED) {
+				close_ring();
+				return false;
+			}
+			submission_entries = static_cast<io_uring_sqe*>(mapping);
+			return true;
+		}
+
+		NIHILUS_FORCE_INLINE void close_ring() noexcept {
+			if (submission_entries) {
+				munmap(submission_entries, submission_entries_bytes);
+				submission_entries = nullptr;
+			}
+			if (completion_ring && completion_ring != submission_ring) {
+				munmap(completion_ring, completion_ring_bytes);
+			}
+			completion_ring = nullptr;
+			if (submission_ring) {
+				munmap(submission_ring, submission_ring_bytes);
+				submission_ring = nullptr;
+			}
+			if (ring_descriptor != -1) {
+				::close(ring_descriptor);
+				ring_descriptor = -1;
+			}
+		}
+
+		// Keeps up to queue_depth chunk reads in flight; a short completion (end of file, or a device that split the request) finishes its chunk
+		// with blocking reads, which is rare enough not to matter.
+		NIHILUS_FORCE_INLINE bool read_ring(uint8_t* output, uint64_t offset, uint64_t length) {
+			const uint64_t chunk_count{ (length + chunk_bytes - 1) / chunk_bytes };
+			const uint32_t submission_mask{ *ring_field<uint32_t>(submission_ring, ring_params.sq_off.ring_mask) };
+			const uint32_t completion_mask{ *ring_field<uint32_t>(completion_ring, ring_params.cq_off.ring_mask) };
+			uint32_t* submission_array{ ring_field<uint32_t>(submission_ring, ring_params.sq_off.array) };
+			std::atomic_ref<uint32_t> submission_tail{ *ring_field<uint32_t>(submission_ring, ring_params.sq_off.tail) };
+			std::atomic_ref<uint32_t> completion_head{ *ring_field<uint32_t>(completion_ring, ring_params.cq_off.head) };
+			std::atomic_ref<uint32_t> completion_tail{ *ring_field<uint32_t>(completion_ring, ring_params.cq_off.tail) };
+			io_uring_cqe* completions{ ring_field<io_uring_cqe>(completion_ring, ring_params.cq_off.cqes) };
+			uint64_t submitted{};
+			uint64_t completed{};
+			uint32_t pending{};
+			bool success{ true };
+			while (completed < chunk_count) {
+				uint32_t tail{ submission_tail.load(std::memory_order_relaxed) };
+				while (submitted < chunk_count && submitted - completed < ring_params.sq_entries) {
+					const uint64_t chunk_offset{ submitted * chunk_bytes };
+					io_uring_sqe& entry{ submission_entries[tail & submission_mask] };
+					entry			= io_uring_sqe{};
+					entry.opcode	= IORING_OP_READ;
+					entry.fd		= file_descriptor;
+					entry.addr		= reinterpret_cast<uint64_t>(output + chunk_offset);
+					entry.len		= static_cast<uint32_t>(std::min(chunk_bytes, length - chunk_offset));
+					entry.off		= offset + chunk_offset;
+					entry.user_data = submitted;
+					submission_array[tail & submission_mask] = tail & submission_mask;
+					++tail;
+					++pending;
+					++submitted;
+				}
+				submission_tail.store(tail, std::memory_order_release);
+				const long entered{ syscall(__NR_io_uring_enter, ring_descriptor, pending, 1u, IORING_ENTER_GETEVENTS, nullptr, 0) };
+				if (entered >= 0) {
+					pending -= static_cast<uint32_t>(entered);
+				} else if (errno != EINTR && errno != EAGAIN && errno != EBUSY) {
+					return false;
+				}
+				uint32_t head{ completion_head.load(std::memory_order_relaxed) };
+				while (head != completion_tail.load(std::memory_order_acquire)) {
+					const io_uring_cqe& completion{ completions[head & completion_mask] };
+					const uint64_t chunk_offset{ completion.user_data * chunk_bytes };
+					const uint64_t requested{ std::min(chunk_bytes, length - chunk_offset) };
+					if (completion.res < 0) {
+						// EINVAL here is O_DIRECT being refused late; the blocking path drops it and retries.
+						success = success && completion.res == -EINVAL && read_blocking(output + chunk_offset, offset + chunk_offset, requested);
+					} else if (static_cast<uint64_t>(completion.res) < requested) {
+						success = success &&
+							read_tail(output + chunk_offset + completion.res, offset + chunk_offset + completion.res, requested - static_cast<uint64_t>(completion.res));
+					}
+					++head;
+					++completed;
+				}
+				completion_head.store(head, std::memory_order_release);
+			}
+			return success;
+		}
+
+		NIHILUS_FORCE_INLINE bool read_tail(uint8_t* output, uint64_t offset, uint64_t length) {
+			if (offset >= size_val) {
+				return true;
+			}
+			// An unaligned remainder cannot go through O_DIRECT.
+			if (offset % alignment != 0) {
+				drop_direct();
+			}
+			return read_blocking(output, offset, length);
+		}
+#endif
+
+		NIHILUS_FORCE_INLINE bool report_error(const std::string& message) {
+			close();
+			if constexpr (exceptions) {
+				throw std::runtime_error{ message };
+			} else {
+				std::cerr << message << std::endl;
+				return false;
+			}
+		}
+	};
+
+}
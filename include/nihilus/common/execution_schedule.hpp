@@ -0,0 +1,94 @@
+/*
+Copyright (c) 2025 RealTimeChris (Chris M.)
+
+This file is part of software offered under a restricted-use license to a designated Licensee,
+whose identity is confirmed in writing by the Author.
+
+License Terms (Summary):
+- Exclusive, non-transferable license for internal use only.
+- Redistribution, sublicensing, or public disclosure is prohibited without written consent.
+- Full ownership remains with the Author.
+- License may terminate if unused for [X months], if materially breached, or by mutual agreement.
+- No warranty is provided, express or implied.
+
+Full license terms are provided in the LICENSE file distributed with this software.
+
+Signed,
+RealTimeChris (Chris M.)
+2025
+*/
+
+#pragma once
+
+#include <nihilus/common/core_traits.hpp>
+#include <nihilus/common/common.hpp>
+#include <nihilus/common/array.hpp>
+
+namespace nihilus {
+
+	template<typename base_type_new> struct execution_planner_constexpr {
+		NIHILUS_FORCE_INLINE execution_planner_constexpr() noexcept												 = default;
+		NIHILUS_FORCE_INLINE execution_planner_constexpr& operator=(const execution_planner_constexpr&) noexcept = delete;
+		NIHILUS_FORCE_INLINE execution_planner_constexpr(const execution_planner_constexpr&) noexcept			 = delete;
+		NIHILUS_FORCE_INLINE execution_planner_constexpr& operator=(execution_planner_constexpr&&) noexcept		 = delete;
+		NIHILUS_FORCE_INLINE execution_planner_constexpr(execution_planner_constexpr&&) noexcept				 = delete;
+		using output_type																						 = base_type_new::output_type;
+		using base_type																							 = base_type_new;
+		using op_type_type																						 = base_type_new::model_traits_type::op_type_type;
+		static constexpr bool executes{ base_type::krn_type != kernel_type::permute && base_type::krn_type != kernel_type::reshape &&
+			base_type::krn_type != kernel_type::transpose && base_type::krn_type != kernel_type::view };
+		NIHILUS_FORCE_INLINE constexpr static void impl(uint64_t& count_new, layer_op_type op_type) {
+			count_new += base_type::layer_type == op_type && executes;
+		}
+		template<uint64_t size> NIHILUS_FORCE_INLINE constexpr static void impl(array<op_type_type, size>& value, layer_op_type op_type, uint64_t& current_index) {
+			if (base_type::layer_type == op_type && executes) {
+				value[current_index] = base_type::type;
+				++current_index;
+			}
+		}
+	};
+
+	template<model_config config> struct execution_schedule {
+		using op_type_type = op_type_type_t<config>;
+
+		static constexpr uint64_t global_input_count{ [] {
+			uint64_t return_value{};
+			get_core_traits_config_base_t<config>::template impl_constexpr<execution_planner_constexpr>(return_value, layer_op_type::global_input);
+			return return_value;
+		}() };
+
+		static constexpr uint64_t per_block_count{ [] {
+			uint64_t return_value{};
+			get_core_traits_config_base_t<config>::template impl_constexpr<execution_planner_constexpr>(return_value, layer_op_type::per_block);
+			return return_value;
+		}() };
+
+		static constexpr uint64_t global_output_count{ [] {
+			uint64_t return_value{};
+			get_core_traits_config_base_t<config>::template impl_constexpr<execution_planner_constexpr>(return_value, layer_op_type::global_output);
+			return return_value;
+		}() };
+
+		static constexpr auto global_input{ [] {
+			uint64_t current_index{};
+			array<op_type_type, global_input_count> return_value{};
+			get_core_traits_config_base_t<config>::template impl_constexpr<execution_planner_constexpr>(return_value, layer_op_type::global_input, current_index);
+			return return_value;
+		}() };
+
+		static constexpr auto per_block{ [] {
+			uint64_t current_index{};
+			array<op_type_type, per_block_count> return_value{};
+			get_core_traits_config_base_t<config>::template impl_constexpr<execution_planner_constexpr>(return_value, layer_op_type::per_block, current_index);
+			return return_value;
+		}() };
+
+		static constexpr auto global_output{ [] {
+			uint64_t current_index{};
+			array<op_type_type, global_output_count> return_value{};
+			get_core_traits_config_base_t<config>::template impl_constexpr<execution_planner_constexpr>(return_value, layer_op_type::global_output, current_index);
+			return return_value;
+		}() };
+	};
+
+}
@@ -0,0 +1,524 @@
+/*
+Copyright (c) 2025 RealTimeChris (Chris M.)
+
+This file is part of software offered under a restricted-use license to a designated Licensee,
+whose identity is confirmed in writing by the Author.
+
+License Terms (Summary):
+- Exclusive, non-transferable license for internal use only.
+- Redistribution, sublicensing, or public disclosure is prohibited without written consent.
+- Full ownership remains with the Author.
+- License may terminate if unused for [X months], if materially breached, or by mutual agreement.
+- No warranty is provided, express or implied.
+
+Full license terms are provided in the LICENSE file distributed with this software.
+
+Signed,
+RealTimeChris (Chris M.)
+2025
+*/
+
+#pragma once
+
+#include <nihilus/common/config.hpp>
+#include <string_view>
+#include <stdexcept>
+#include <iostream>
+#include <cstring>
+#include <variant>
+#include <vector>
+
+namespace nihilus {
+
+	enum class gguf_metadata_value_type : uint32_t {
+		GGUF_METADATA_VALUE_TYPE_UINT8	 = 0,
+		GGUF_METADATA_VALUE_TYPE_INT8	 = 1,
+		GGUF_METADATA_VALUE_TYPE_UINT16	 = 2,
+		GGUF_METADATA_VALUE_TYPE_INT16	 = 3,
+		GGUF_METADATA_VALUE_TYPE_UINT32	 = 4,
+		GGUF_METADATA_VALUE_TYPE_INT32	 = 5,
+		GGUF_METADATA_VALUE_TYPE_FLOAT32 = 6,
+		GGUF_METADATA_VALUE_TYPE_BOOL	 = 7,
+		GGUF_METADATA_VALUE_TYPE_STRING	 = 8,
+		GGUF_METADATA_VALUE_TYPE_ARRAY	 = 9,
+		GGUF_METADATA_VALUE_TYPE_UINT64	 = 10,
+		GGUF_METADATA_VALUE_TYPE_INT64	 = 11,
+		GGUF_METADATA_VALUE_TYPE_FLOAT64 = 12,
+		GGUF_METADATA_VALUE_TYPE_UNSET	 = 13,
+	};
+
+	struct string_iterator {
+		const char* first_index{};
+		uint64_t current_index{};
+		uint64_t length{};
+
+		template<typename value_type> NIHILUS_FORCE_INLINE bool operator()(uint64_t size = 0) {
+			return (current_index + sizeof(value_type) + size) < length;
+		}
+	};
+
+	template<typename value_type, auto...> struct value_reader {
+		NIHILUS_FORCE_INLINE static gguf_metadata_value_type gather_value(string_iterator& input) {
+			gguf_metadata_value_type value{};
+			if (input.template operator()<value_type>()) {
+				std::memcpy(&value, input.first_index + input.current_index, sizeof(value));
+				input.current_index += sizeof(value);
+			} else {
+				throw std::runtime_error{ "Sorry, but that index is out of range!" };
+			}
+			if (static_cast<uint64_t>(value) >= 13) {
+				throw std::runtime_error{ "Sorry, but that type is out of range!" };
+			}
+			return value;
+		}
+	};
+
+	template<> struct value_reader<uint8_t> {
+		NIHILUS_FORCE_INLINE static uint8_t gather_value(string_iterator& input) {
+			uint8_t value{};
+			if (input.template operator()<uint8_t>()) {
+				std::memcpy(&value, input.first_index + input.current_index, sizeof(value));
+				input.current_index += sizeof(value);
+			} else {
+				throw std::runtime_error{ "Sorry, but that index is out of range!" };
+			}
+			return value;
+		}
+	};
+
+	template<> struct value_reader<uint16_t> {
+		NIHILUS_FORCE_INLINE static uint16_t gather_value(string_iterator& input) {
+			uint16_t value{};
+			if (input.template operator()<uint16_t>()) {
+				std::memcpy(&value, input.first_index + input.current_index, sizeof(value));
+				input.current_index += sizeof(value);
+			} else {
+				throw std::runtime_error{ "Sorry, but that index is out of range!" };
+			}
+			return value;
+		}
+	};
+
+	template<> struct value_reader<uint32_t> {
+		NIHILUS_FORCE_INLINE static uint32_t gather_value(string_iterator& input) {
+			uint32_t value{};
+			if (input.template operator()<uint32_t>()) {
+				std::memcpy(&value, input.first_index + input.current_index, sizeof(value));
+				input.current_index += sizeof(value);
+			} else {
+				throw std::runtime_error{ "Sorry, but that index is out of range!" };
+			}
+			return value;
+		}
+	};
+
+	template<> struct value_reader<uint64_t> {
+		NIHILUS_FORCE_INLINE static uint64_t gather_value(string_iterator& input) {
+			uint64_t value{};
+			if (input.template operator()<uint64_t>()) {
+				std::memcpy(&value, input.first_index + input.current_index, sizeof(value));
+				input.current_index += sizeof(value);
+			} else {
+				throw std::runtime_error{ "Sorry, but that index is out of range!" };
+			}
+			return value;
+		}
+	};
+
+	template<> struct value_reader<int8_t> {
+		NIHILUS_FORCE_INLINE static int8_t gather_value(string_iterator& input) {
+			int8_t value{};
+			if (input.template operator()<int8_t>()) {
+				std::memcpy(&value, input.first_index + input.current_index, sizeof(value));
+				input.current_index += sizeof(value);
+			} else {
+				throw std::runtime_error{ "Sorry, but that index is out of range!" };
+			}
+			return value;
+		}
+	};
+
+	template<> struct value_reader<int16_t> {
+		NIHILUS_FORCE_INLINE static int16_t gather_value(string_iterator& input) {
+			int16_t value{};
+			if (input.template operator()<int16_t>()) {
+				std::memcpy(&value, input.first_index + input.current_index, sizeof(value));
+				input.current_index += sizeof(value);
+			} else {
+				throw std::runtime_error{ "Sorry, but that index is out of range!" };
+			}
+			return value;
+		}
+	};
+
+	template<> struct value_reader<int32_t> {
+		NIHILUS_FORCE_INLINE static int32_t gather_value(string_iterator& input) {
+			int32_t value{};
+			if (input.template operator()<int32_t>()) {
+				std::memcpy(&value, input.first_index + input.current_index, sizeof(value));
+				input.current_index += sizeof(value);
+			} else {
+				throw std::runtime_error{ "Sorry, but that index is out of range!" };
+			}
+			return value;
+		}
+	};
+
+	template<> struct value_reader<int64_t> {
+		NIHILUS_FORCE_INLINE static int64_t gather_value(string_iterator& input) {
+			int64_t value{};
+			if (input.template operator()<int64_t>()) {
+				std::memcpy(&value, input.first_index + input.current_index, sizeof(value));
+				input.current_index += sizeof(value);
+			} else {
+				throw std::runtime_error{ "Sorry, but that index is out of range!" };
+			}
+			return value;
+		}
+	};
+
+	template<> struct value_reader<bool> {
+		NIHILUS_FORCE_INLINE static bool gather_value(string_iterator& input) {
+			bool value{};
+			if (input.template operator()<bool>()) {
+				std::memcpy(&value, input.first_index + input.current_index, sizeof(value));
+				input.current_index += sizeof(value);
+			} else {
+				throw std::runtime_error{ "Sorry, but that index is out of range!" };
+			}
+			return value;
+		}
+	};
+
+	template<> struct value_reader<float> {
+		NIHILUS_FORCE_INLINE static float gather_value(string_iterator& input) {
+			float value{};
+			if (input.template operator()<float>()) {
+				std::memcpy(&value, input.first_index + input.current_index, sizeof(value));
+				input.current_index += sizeof(value);
+			} else {
+				throw std::runtime_error{ "Sorry, but that index is out of range!" };
+			}
+			return value;
+		}
+	};
+
+	template<> struct value_reader<double> {
+		NIHILUS_FORCE_INLINE static double gather_value(string_iterator& input) {
+			double value{};
+			if (input.template operator()<double>()) {
+				std::memcpy(&value, input.first_index + input.current_index, sizeof(value));
+				input.current_index += sizeof(value);
+			} else {
+				throw std::runtime_error{ "Sorry, but that index is out of range!" };
+			}
+			return value;
+		}
+	};
+
+	// Metadata is decoded straight off the mapped file: strings are views into it and arrays stay undecoded until walked, so parsing the header
+	// allocates nothing per value. Everything here lives only as long as the mapping it was read from.
+	using gguf_string_t = std::string_view;
+
+	NIHILUS_FORCE_INLINE constexpr uint64_t gguf_scalar_size(gguf_metadata_value_type type) noexcept {
+		switch (type) {
+			case gguf_metadata_value_type::GGUF_METADATA_VALUE_TYPE_UINT8:
+			case gguf_metadata_value_type::GGUF_METADATA_VALUE_TYPE_INT8:
+			case gguf_metadata_value_type::GGUF_METADATA_VALUE_TYPE_BOOL:
+				return 1;
+			case gguf_metadata_value_type::GGUF_METADATA_VALUE_TYPE_UINT16:
+			case gguf_metadata_value_type::GGUF_METADATA_VALUE_TYPE_INT16:
+				return 2;
+			case gguf_metadata_value_type::GGUF_METADATA_VALUE_TYPE_UINT32:
+			case gguf_metadata_value_type::GGUF_METADATA_VALUE_TYPE_INT32:
+			case gguf_metadata_value_type::GGUF_METADATA_VALUE_TYPE_FLOAT32:
+				return 4;
+			case gguf_metadata_value_type::GGUF_METADATA_VALUE_TYPE_UINT64:
+			case gguf_metadata_value_type::GGUF_METADATA_VALUE_TYPE_INT64:
+			case gguf_metadata_value_type::GGUF_METADATA_VALUE_TYPE_FLOAT64:
+				return 8;
+			default:
+				return 0;
+		}
+	}
+
+	NIHILUS_FORCE_INLINE void skip_bytes(string_iterator& input, uint64_t count) {
+		if (input.current_index + count > input.length) {
+			throw std::runtime_error{ "Sorry, but that index is out of range!" };
+		}
+		input.current_index += count;
+	}
+
+	template<> struct value_reader<gguf_string_t> {
+		NIHILUS_FORCE_INLINE static gguf_string_t gather_value(string_iterator& input) {
+			uint64_t length{ value_reader<uint64_t>::gather_value(input) };
+			constexpr uint64_t MAX_STRING_LENGTH = 1024 * 1024 * 100;
+			if (length > MAX_STRING_LENGTH) {
+				throw std::runtime_error{ "String length exceeds maximum allowed size!" };
+			}
+			const char* value{ input.first_index + input.current_index };
+			skip_bytes(input, length);
+			return gguf_string_t{ value, length };
+		}
+	};
+
+	// Undecoded GGUF array: element count, element type and the raw bytes. Scalar elements are random access; strings (and nested arrays) are
+	// length-prefixed, so they are walked in order.
+	struct gguf_array_t {
+		const char* data{};
+		uint64_t byte_length{};
+		uint64_t length{};
+		gguf_metadata_value_type type{};
+
+		template<typename value_type> NIHILUS_FORCE_INLINE value_type at(uint64_t index) const {
+			value_type value{};
+			switch (type) {
+				case gguf_metadata_value_type::GGUF_METADATA_VALUE_TYPE_UINT8:
+					return static_cast<value_type>(load<uint8_t>(index));
+				case gguf_metadata_value_type::GGUF_METADATA_VALUE_TYPE_INT8:
+					return static_cast<value_type>(load<int8_t>(index));
+				case gguf_metadata_value_type::GGUF_METADATA_VALUE_TYPE_UINT16:
+					return static_cast<value_type>(load<uint16_t>(index));
+				case gguf_metadata_value_type::GGUF_METADATA_VALUE_TYPE_INT16:
+					return static_cast<value_type>(load<int16_t>(index));
+				case gguf_metadata_value_type::GGUF_METADATA_VALUE_TYPE_UINT32:
+					return static_cast<value_type>(load<uint32_t>(index));
+				case gguf_metadata_value_type::GGUF_METADATA_VALUE_TYPE_INT32:
+					return static_cast<value_type>(load<int32_t>(index));
+				case gguf_metadata_value_type::GGUF_METADATA_VALUE_TYPE_UINT64:
+					return static_cast<value_type>(load<uint64_t>(index));
+				case gguf_metadata_value_type::GGUF_METADATA_VALUE_TYPE_INT64:
+					return static_cast<value_type>(load<int64_t>(index));
+				case gguf_metadata_value_type::GGUF_METADATA_VALUE_TYPE_FLOAT32:
+					return static_cast<value_type>(load<float>(index));
+				case gguf_metadata_value_type::GGUF_METADATA_VALUE_TYPE_FLOAT64:
+					return static_cast<value_type>(load<double>(index));
+				case gguf_metadata_value_type::GGUF_METADATA_VALUE_TYPE_BOOL:
+					return static_cast<value_type>(load<bool>(index));
+				default:
+					return value;
+			}
+		}
+
+		// Calls fn(index, element) for every string element, in order.
+		template<typename function_type> NIHILUS_FORCE_INLINE void for_each_string(function_type&& fn) const {
+			if (type != gguf_metadata_value_type::GGUF_METADATA_VALUE_TYPE_STRING) {
+				return;
+			}
+			// string_iterator's bounds check is exclusive of the last byte, hence the + 1.
+			string_iterator input{ data, 0, byte_length + 1 };
+			for (uint64_t x = 0; x < length; ++x) {
+				fn(x, value_reader<gguf_string_t>::gather_value(input));
+			}
+		}
+
+	  protected:
+		template<typename value_type> NIHILUS_FORCE_INLINE value_type load(uint64_t index) const {
+			value_type value{};
+			if (index < length) {
+				std::memcpy(&value, data + index * sizeof(value_type), sizeof(value_type));
+			}
+			return value;
+		}
+	};
+
+	using gguf_metadata_value_variant = std::variant<float, uint64_t, int64_t, double, bool, gguf_string_t, gguf_array_t>;
+
+	template<> struct value_reader<gguf_array_t> {
+		NIHILUS_FORCE_INLINE static gguf_array_t gather_value(string_iterator& input);
+	};
+
+	NIHILUS_FORCE_INLINE void skip_value(string_iterator& input, gguf_metadata_value_type type) {
+		if (type == gguf_metadata_value_type::GGUF_METADATA_VALUE_TYPE_STRING) {
+			value_reader<gguf_string_t>::gather_value(input);
+		} else if (type == gguf_metadata_value_type::GGUF_METADATA_VALUE_TYPE_ARRAY) {
+			value_reader<gguf_array_t>::gather_value(input);
+		} else {
+			skip_bytes(input, gguf_scalar_size(type));
+		}
+	}
+
+	template<> struct value_reader<gguf_metadata_value_variant> {
+		NIHILUS_INLINE static gguf_metadata_value_variant gather_value(string_iterator& input, gguf_metadata_value_type type) {
+			gguf_metadata_value_variant value{};
+			switch (type) {
+				case gguf_metadata_value_type::GGUF_METADATA_VALUE_TYPE_INT8: {
+					value.emplace<int64_t>(value_reader<int8_t>::gather_value(input));
+					break;
+				}
+				case gguf_metadata_value_type::GGUF_METADATA_VALUE_TYPE_INT16: {
+					value.emplace<int64_t>(value_reader<int16_t>::gather_value(input));
+					break;
+				}
+				case gguf_metadata_value_type::GGUF_METADATA_VALUE_TYPE_INT32: {
+					value.emplace<int64_t>(value_reader<int32_t>::gather_value(input));
+					break;
+				}
+				case gguf_metadata_value_type::GGUF_METADATA_VALUE_TYPE_INT64: {
+					value.emplace<int64_t>(value_reader<int64_t>::gather_value(input));
+					break;
+				}
+				case gguf_metadata_value_type::GGUF_METADATA_VALUE_TYPE_UINT8: {
+					value.emplace<uint64_t>(value_reader<uint8_t>::gather_value(input));
+					break;
+				}
+				case gguf_metadata_value_type::GGUF_METADATA_VALUE_TYPE_UINT16: {
+					value.emplace<uint64_t>(value_reader<uint16_t>::gather_value(input));
+					break;
+				}
+				case gguf_metadata_value_type::GGUF_METADATA_VALUE_TYPE_UINT32: {
+					value.emplace<uint64_t>(value_reader<uint32_t>::gather_value(input));
+					break;
+				}
+				case gguf_metadata_value_type::GGUF_METADATA_VALUE_TYPE_UINT64: {
+					value.emplace<uint64_t>(value_reader<uint64_t>::gather_value(input));
+					break;
+				}
+				case gguf_metadata_value_type::GGUF_METADATA_VALUE_TYPE_BOOL: {
+					value.emplace<bool>(value_reader<bool>::gather_value(input));
+					break;
+				}
+				case gguf_metadata_value_type::GGUF_METADATA_VALUE_TYPE_FLOAT32: {
+					value.emplace<float>(value_reader<float>::gather_value(input));
+					break;
+				}
+				case gguf_metadata_value_type::GGUF_METADATA_VALUE_TYPE_FLOAT64: {
+					value.emplace<double>(value_reader<double>::gather_value(input));
+					break;
+				}
+				case gguf_metadata_value_type::GGUF_METADATA_VALUE_TYPE_STRING: {
+					value.emplace<gguf_string_t>(value_reader<gguf_string_t>::gather_value(input));
+					break;
+				}
+				case gguf_metadata_value_type::GGUF_METADATA_VALUE_TYPE_ARRAY: {
+					value.emplace<gguf_array_t>(value_reader<gguf_array_t>::gather_value(input));
+					break;
+				}
+				case gguf_metadata_value_type::GGUF_METADATA_VALUE_TYPE_UNSET: {
+					break;
+				}
+			}
+			return value;
+		}
+	};
+
+	gguf_array_t value_reader<gguf_array_t>::gather_value(string_iterator& input) {
+		gguf_array_t value{};
+		value.type = value_reader<gguf_metadata_value_type>::gather_value(input);
+		value.length = value_reader<uint64_t>::gather_value(input);
+		constexpr uint64_t MAX_ARRAY_LENGTH = 1024 * 1024;
+		if (value.length > MAX_ARRAY_LENGTH) {
+			throw std::runtime_error{ "Array length exceeds maximum allowed size!" };
+		}
+		value.data = input.first_index + input.current_index;
+		const uint64_t scalar_size{ gguf_scalar_size(value.type) };
+		if (scalar_size > 0) {
+			skip_bytes(input, scalar_size * value.length);
+		} else {
+			for (uint64_t x = 0; x < value.length; ++x) {
+				skip_value(input, value.type);
+			}
+		}
+		value.byte_length = static_cast<uint64_t>(input.first_index + input.current_index - value.data);
+		return value;
+	}
+
+	struct gguf_metadata_kv_t {
+		gguf_string_t key{};
+		gguf_metadata_value_type value_type{};
+		gguf_metadata_value_variant value{};
+	};
+
+	template<> struct value_reader<gguf_metadata_kv_t> {
+		NIHILUS_FORCE_INLINE static gguf_metadata_kv_t gather_value(string_iterator& input) {
+			gguf_metadata_kv_t value{};
+			value.key		 = value_reader<gguf_string_t>::gather_value(input);
+			value.value_type = value_reader<gguf_metadata_value_type>::gather_value(input);
+			value.value		 = value_reader<gguf_metadata_value_variant>::gather_value(input, value.value_type);
+			return value;
+		}
+	};
+
+	// One entry per key, in file order; lookups are linear since a model carries a few dozen keys at most.
+	struct gguf_metadata_t {
+		std::vector<gguf_metadata_kv_t> entries{};
+
+		// Matches prefix + suffix without building the concatenated key.
+		NIHILUS_FORCE_INLINE const gguf_metadata_kv_t* find(std::string_view prefix, std::string_view suffix = {}) const {
+			for (const auto& entry: entries) {
+				if (entry.key.size() == prefix.size() + suffix.size() && entry.key.starts_with(prefix) && entry.key.ends_with(suffix)) {
+					return &entry;
+				}
+			}
+			return nullptr;
+		}
+	};
+
+	struct gguf_header_t {
+		gguf_metadata_t metadata_kv{};
+		uint64_t metadata_kv_count{};
+		uint64_t tensor_count{};
+		uint32_t version{};
+		uint32_t magic{};
+	};
+
+	template<typename value_type>
+	NIHILUS_FORCE_INLINE void gather_scalar(std::string_view prefix, std::string_view suffix, value_type& out, const gguf_metadata_t& metadata_kv) {
+		const gguf_metadata_kv_t* entry{ metadata_kv.find(prefix, suffix) };
+		if (!entry) {
+			return;
+		}
+		if (std::holds_alternative<value_type>(entry->value)) {
+			out = std::get<value_type>(entry->value);
+		}
+	};
+
+	template<typename value_type> NIHILUS_FORCE_INLINE void gather_scalar(std::string_view key, value_type& out, const gguf_metadata_t& metadata_kv) {
+		gather_scalar(key, std::string_view{}, out, metadata_kv);
+	};
+
+	NIHILUS_FORCE_INLINE void print_variant(auto variant) {
+		if (std::holds_alternative<float>(variant)) {
+			std::cout << "Value: " << std::get<float>(variant) << std::endl;
+		} else if (std::holds_alternative<uint64_t>(variant)) {
+			std::cout << "Value: " << std::get<uint64_t>(variant) << std::endl;
+		} else if (std::holds_alternative<int64_t>(variant)) {
+			std::cout << "Value: " << std::get<int64_t>(variant) << std::endl;
+		} else if (std::holds_alternative<double>(variant)) {
+			std::cout << "Value: " << std::get<double>(variant) << std::endl;
+		} else if (std::holds_alternative<bool>(variant)) {
+			std::cout << "Value: " << std::get<bool>(variant) << std::endl;
+		} else if (std::holds_alternative<gguf_string_t>(variant)) {
+			std::cout << "Value: " << std::get<gguf_string_t>(variant) << std::endl;
+		} else if (std::holds_alternative<gguf_array_t>(variant)) {
+			std::cout << "Value: [" << std::get<gguf_array_t>(variant).length << " elements]" << std::endl;
+		}
+	}
+
+	template<> struct value_reader<gguf_header_t> {
+		NIHILUS_FORCE_INLINE static gguf_header_t gather_value(string_iterator& input) {
+			gguf_header_t value{};
+			value.magic = value_reader<uint32_t>::gather_value(input);
+			if (value.magic != 0x46554747) {
+				throw std::runtime_error{ "Sorry, but that magic value was incorrect!" };
+			}
+			value.version						  = value_reader<uint32_t>::gather_value(input);
+			value.tensor_count					  = value_reader<uint64_t>::gather_value(input);
+			value.metadata_kv_count				  = value_reader<uint64_t>::gather_value(input);
+			constexpr uint64_t MAX_TENSOR_COUNT	  = 100000;
+			constexpr uint64_t MAX_METADATA_COUNT = 10000;
+			if (value.tensor_count > MAX_TENSOR_COUNT) {
+				throw std::runtime_error{ "Tensor count exceeds reasonable maximum!" };
+			}
+			if (value.metadata_kv_count > MAX_METADATA_COUNT) {
+				throw std::runtime_error{ "Metadata count exceeds reasonable maximum!" };
+			}
+			value.metadata_kv.entries.reserve(value.metadata_kv_count);
+			for (uint64_t x = 0; x < value.metadata_kv_count; ++x) {
+				value.metadata_kv.entries.emplace_back(value_reader<gguf_metadata_kv_t>::gather_value(input));
+			}
+			return value;
+		}
+	};
+
+}
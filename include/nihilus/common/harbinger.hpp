@@ -31,9 +31,11 @@ namespace nihilus {
 		NIHILUS_FORCE_INLINE static consteval auto generate_model_config(auto model_generation, auto model_size, kernel_type_profile kernel_profile, model_arch arch,
 			bool exceptions = false, kv_cache_strategy cache_strategy = kv_cache_strategy::paged, bool use_gradient_checkpointing = false,
 			rope_scaling_type rope_scaling = rope_scaling_type::linear, bool use_rotary_embeddings = true, uint64_t kv_cache_block_size = 16, bool use_flash_attention = true,
-			norm_type rms_norm_type = norm_type::rms_standard, model_format format = model_format::gguf, float norm_epsilon = 1e-6f) {
+			norm_type rms_norm_type = norm_type::rms_standard, model_format format = model_format::gguf, float norm_epsilon = 1e-6f,
+			attention_mask_type mask_type = attention_mask_type::causal, uint64_t sliding_window_size = 4096, uint64_t max_context_length = 0, uint64_t max_batch_size = 0) {
 			model_config<decltype(model_generation), decltype(model_size)> config{ model_generation, model_size, kernel_profile, arch, exceptions, cache_strategy,
-				use_gradient_checkpointing, rope_scaling, use_rotary_embeddings, kv_cache_block_size, use_flash_attention, rms_norm_type, format, norm_epsilon };
+				use_gradient_checkpointing, rope_scaling, use_rotary_embeddings, kv_cache_block_size, use_flash_attention, rms_norm_type, format, norm_epsilon, mask_type,
+				sliding_window_size, max_context_length, max_batch_size };
 			return config;
 		};
 
@@ -41,7 +43,9 @@ namespace nihilus {
 			using model_type = model<config>;
 			using base_type	 = model_type::base_type;
 			std::unique_ptr<base_type> return_value{};
-			model_type* new_model{ new model_type{ path } };
+			cli_params params{};
+			params.model_file = path;
+			model_type* new_model{ new model_type{ params } };
 			return_value.reset(new_model);
 			return return_value;
 		}
@@ -66,9 +70,17 @@ namespace nihilus {
 
 				if (token[0] == '-') {
 					current_flag = token;
+					if (token == "--serve-while-loading") {
+						result.weight_mapping.background = true;
+					}
+					if (token == "--memory-report") {
+						result.memory_report = true;
+					}
 					if (token == "-m" || token == "-t" || token == "-p" || token == "-s" || token == "-n" || token == "-b") {
 						std::cout << "CURRENT TOKEN: " << token << std::endl;
 						expect_value = true;
+					} else if (token == "-c" || token == "--weight-reader" || token == "--stream-layers" || token == "--huge-pages" || token == "--numa" || token == "--warmup") {
+						expect_value = true;
 					} else {
 						expect_value = false;
 					}
@@ -101,6 +113,62 @@ namespace nihilus {
 						} catch (const std::exception&) {
 							result.batch_size = 512;
 						}
+					} else if (current_flag == "-c") {
+						try {
+							result.context_length = std::stoull(token);
+						} catch (const std::exception&) {
+							result.context_length = 0;
+						}
+					} else if (current_flag == "--weight-reader") {
+						if (token == "pread") {
+							result.weight_mapping.reader = weight_reader::pread;
+						} else if (token == "io_uring") {
+							result.weight_mapping.reader = weight_reader::io_uring;
+						} else if (token == "mmap") {
+							result.weight_mapping.reader = weight_reader::mmap;
+						} else {
+							report_bad_value(current_flag, token, "mmap, pread or io_uring");
+						}
+					} else if (current_flag == "--huge-pages") {
+						if (token == "none") {
+							result.huge_pages = huge_page_policy::none;
+						} else if (token == "2m") {
+							result.huge_pages = huge_page_policy::explicit_2m;
+						} else if (token == "1g") {
+							result.huge_pages = huge_page_policy::explicit_1g;
+						} else if (token == "transparent") {
+							result.huge_pages = huge_page_policy::transparent;
+						} else {
+							report_bad_value(current_flag, token, "none, transparent, 2m or 1g");
+						}
+					} else if (current_flag == "--numa") {
+						if (token == "interleave") {
+							result.numa = numa_placement::interleave;
+						} else if (token == "partition") {
+							result.numa = numa_placement::partition;
+						} else if (token == "none") {
+							result.numa = numa_placement::none;
+						} else {
+							report_bad_value(current_flag, token, "none, interleave or partition");
+						}
+					} else if (current_flag == "--warmup") {
+						if (token == "prefault") {
+							result.warmup = startup_warmup::prefault;
+						} else if (token == "lock") {
+							result.warmup = startup_warmup::lock;
+						} else if (token == "full") {
+							result.warmup = startup_warmup::full;
+						} else if (token == "none") {
+							result.warmup = startup_warmup::none;
+						} else {
+							report_bad_value(current_flag, token, "none, prefault, lock or full");
+						}
+					} else if (current_flag == "--stream-layers") {
+						try {
+							result.weight_mapping.stream_distance = std::stoull(token);
+						} catch (const std::exception&) {
+							result.weight_mapping.stream_distance = 0;
+						}
 					}
 					expect_value = false;
 				}
@@ -108,6 +176,12 @@ namespace nihilus {
 
 			return result;
 		}
+
+	  protected:
+		// An unrecognized value leaves the flag at its default.
+		NIHILUS_FORCE_INLINE static void report_bad_value(const std::string& flag, const std::string& value, const char* accepted) {
+			std::cerr << "Sorry, but " << flag << " does not accept \"" << value << "\"; expected " << accepted << "." << std::endl;
+		}
 	};
 
 }
@@ -0,0 +1,154 @@
+/*
+Copyright (c) 2025 RealTimeChris (Chris M.)
+
+This file is part of software offered under a restricted-use license to a designated Licensee,
+whose identity is confirmed in writing by the Author.
+
+License Terms (Summary):
+- Exclusive, non-transferable license for internal use only.
+- Redistribution, sublicensing, or public disclosure is prohibited without written consent.
+- Full ownership remains with the Author.
+- License may terminate if unused for [X months], if materially breached, or by mutual agreement.
+- No warranty is provided, express or implied.
+
+Full license terms are provided in the LICENSE file distributed with this software.
+
+Signed,
+RealTimeChris (Chris M.)
+2025
+*/
+
+#pragma once
+
+#include <nihilus/common/allocator.hpp>
+#include <nihilus/common/config.hpp>
+#include <nihilus/common/common.hpp>
+#include <fstream>
+#include <string>
+
+#if defined(NIHILUS_PLATFORM_WINDOWS)
+	#include <Windows.h>
+#else
+	#include <sys/mman.h>
+#endif
+
+namespace nihilus {
+
+	struct page_allocation {
+		uint8_t* data{};
+		uint64_t bytes{};
+		huge_page_policy backing{};
+	};
+
+	// Page-granular anonymous memory for the multi-GB arenas. Tries the requested policy and then each weaker one; returns an empty allocation
+	// for none (or when nothing could be mapped), leaving the caller on its usual allocator.
+	struct huge_page_allocator {
+		static constexpr uint64_t huge_page_2m{ 2ull * 1024ull * 1024ull };
+		static constexpr uint64_t huge_page_1g{ 1024ull * 1024ull * 1024ull };
+
+		NIHILUS_FORCE_INLINE static page_allocation allocate(uint64_t size, huge_page_policy policy) noexcept {
+			if (size == 0) {
+				return {};
+			}
+			switch (policy) {
+				case huge_page_policy::explicit_1g:
+					if (page_allocation return_value{ allocate_explicit(size, huge_page_1g, huge_page_policy::explicit_1g) }; return_value.data) {
+						return return_value;
+					}
+					[[fallthrough]];
+				case huge_page_policy::explicit_2m:
+					if (page_allocation return_value{ allocate_explicit(size, huge_page_2m, huge_page_policy::explicit_2m) }; return_value.data) {
+						return return_value;
+					}
+					[[fallthrough]];
+				case huge_page_policy::transparent:
+					return allocate_transparent(size);
+				default:
+					return {};
+			}
+		}
+
+		NIHILUS_FORCE_INLINE static void deallocate(const page_allocation& allocation) noexcept {
+			if (!allocation.data) {
+				return;
+			}
+#if defined(NIHILUS_PLATFORM_WINDOWS)
+			VirtualFree(allocation.data, 0, MEM_RELEASE);
+#else
+			munmap(allocation.data, allocation.bytes);
+#endif
+		}
+
+		// Heap-backed buffers are freed without unmapping, so their lock has to be dropped explicitly; unmapped pages unlock on their own.
+		NIHILUS_FORCE_INLINE static bool lock(const void* data, uint64_t size) noexcept {
+#if defined(NIHILUS_PLATFORM_WINDOWS)
+			return VirtualLock(const_cast<void*>(data), static_cast<SIZE_T>(size)) != 0;
+#else
+			return mlock(data, size) == 0;
+#endif
+		}
+
+		NIHILUS_FORCE_INLINE static void unlock(const void* data, uint64_t size) noexcept {
+#if defined(NIHILUS_PLATFORM_WINDOWS)
+			VirtualUnlock(const_cast<void*>(data), static_cast<SIZE_T>(size));
+#else
+			munlock(data, size);
+#endif
+		}
+
+	  protected:
+		// hugetlbfs pages are reserved at map time, so failure (an empty or too small pool) shows up here rather than as a fault later.
+		NIHILUS_FORCE_INLINE static page_allocation allocate_explicit(uint64_t size, uint64_t page_size, huge_page_policy backing) noexcept {
+			const uint64_t bytes{ roundUpToMultiple(size, page_size) };
+#if defined(NIHILUS_PLATFORM_WINDOWS)
+			// Windows has one large page size and needs SeLockMemoryPrivilege; report it as 2 MiB, which it is on every x64 and arm64 host.
+			if (backing != huge_page_policy::explicit_2m || GetLargePageMinimum() == 0) {
+				return {};
+			}
+			const uint64_t large_bytes{ roundUpToMultiple(size, static_cast<uint64_t>(GetLargePageMinimum())) };
+			void* mapping{ VirtualAlloc(nullptr, large_bytes, MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, PAGE_READWRITE) };
+			return mapping ? page_allocation{ static_cast<uint8_t*>(mapping), large_bytes, backing } : page_allocation{};
+#elif defined(MAP_HUGETLB) && defined(MAP_HUGE_SHIFT)
+			const int size_flag{ (page_size == huge_page_1g ? 30 : 21) << MAP_HUGE_SHIFT };
+			void* mapping{ mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB | size_flag, -1, 0) };
+			return mapping != MAP_FAILED ? page_allocation{ static_cast<uint8_t*>(mapping), bytes, backing } : page_allocation{};
+#else
+			(void)bytes;
+			(void)backing;
+			return {};
+#endif
+		}
+
+		// Maps 2 MiB-aligned anonymous memory and asks for THP; the kernel may still back it with 4 KiB pages, which is reported when THP is off.
+		NIHILUS_FORCE_INLINE static page_allocation allocate_transparent(uint64_t size) noexcept {
+#if defined(NIHILUS_PLATFORM_LINUX) && defined(MADV_HUGEPAGE)
+			const uint64_t bytes{ roundUpToMultiple(size, huge_page_2m) };
+			void* mapping{ mmap(nullptr, bytes + huge_page_2m, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0) };
+			if (mapping == MAP_FAILED) {
+				return {};
+			}
+			uint8_t* begin{ static_cast<uint8_t*>(mapping) };
+			uint8_t* aligned{ reinterpret_cast<uint8_t*>(roundUpToMultiple(reinterpret_cast<uintptr_t>(begin), huge_page_2m)) };
+			if (aligned > begin) {
+				munmap(begin, static_cast<uint64_t>(aligned - begin));
+			}
+			if (const uint64_t tail{ huge_page_2m - static_cast<uint64_t>(aligned - begin) }; tail > 0) {
+				munmap(aligned + bytes, tail);
+			}
+			const bool advised{ madvise(aligned, bytes, MADV_HUGEPAGE) == 0 && transparent_enabled() };
+			return page_allocation{ aligned, bytes, advised ? huge_page_policy::transparent : huge_page_policy::none };
+#else
+			(void)size;
+			return {};
+#endif
+		}
+
+		NIHILUS_FORCE_INLINE static bool transparent_enabled() noexcept {
+			std::ifstream file{ "/sys/kernel/mm/transparent_hugepage/enabled" };
+			std::string modes{};
+			std::getline(file, modes);
+			return !modes.empty() && modes.find("[never]") == std::string::npos;
+		}
+	};
+
+}
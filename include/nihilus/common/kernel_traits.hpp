@@ -20,6 +20,7 @@ RealTimeChris (Chris M.)
 
 #pragma once
 
+#include <nihilus/common/type_traits.hpp>
 #include <nihilus/common/common.hpp>
 #include <nihilus/common/array.hpp>
 #include <latch>
@@ -55,6 +56,8 @@ namespace nihilus {
 		using input_type01					  = typename input01::output_type;
 		using input_type02					  = typename input02::output_type;
 		using output_type					  = typename output::output_type;
+		// Elementwise (or row-local) kernels may be handed output == input01 by the memory plan.
+		static constexpr bool in_place_capable = std::is_same_v<input_type01, output_type>;
 		static constexpr bool is_broadcasting		   = (input02_dims[1] == 1 && input01_dims[1] > 1);
 		static constexpr uint64_t total_elements		   = output_dims[0] * output_dims[1] * output_dims[2] * output_dims[3];
 		static constexpr uint64_t input01_total_elements = input01_dims[0] * input01_dims[1] * input01_dims[2] * input01_dims[3];
@@ -80,6 +83,7 @@ namespace nihilus {
 		static constexpr auto output_dims			  = output::dims;
 		using input_type01							  = typename input01::output_type;
 		using output_type							  = typename output::output_type;
+		static constexpr bool in_place_capable = std::is_same_v<input_type01, output_type>;
 		static constexpr uint64_t input_total_elements  = input01_dims[0] * input01_dims[1] * input01_dims[2] * input01_dims[3];
 		static constexpr uint64_t output_total_elements = output_dims[0] * output_dims[1] * output_dims[2] * output_dims[3];
 		static_assert(static_assert_printer<(input_total_elements == output_total_elements), kernel_traits, output, input01>::impl,
@@ -98,26 +102,21 @@ namespace nihilus {
 		static constexpr auto output_dims	   = output::dims;
 		using input_type01					   = typename input01::output_type;
 		using output_type					   = typename output::output_type;
+		static constexpr bool in_place_capable = std::is_same_v<input_type01, output_type>;
 		static constexpr uint64_t total_elements = input01_dims[0] * input01_dims[1] * input01_dims[2] * input01_dims[3];
 	};
 
-	template<typename output, typename input01, typename input02> struct kernel_traits<kernel_type::softmax, output, input01, input02> {
-		static_assert(static_assert_printer<(input01::dims[0] == output::dims[0]), kernel_traits, output, input01, input02>::impl,
-			"SOFTMAX: Output dimensions[0] must match input01");
-		static_assert(static_assert_printer<(input01::dims[1] == output::dims[1]), kernel_traits, output, input01, input02>::impl,
-			"SOFTMAX: Output dimensions[1] must match input01");
-		static_assert(static_assert_printer<(input01::dims[2] == output::dims[2]), kernel_traits, output, input01, input02>::impl,
-			"SOFTMAX: Output dimensions[2] must match input01");
-		static_assert(static_assert_printer<(input01::dims[3] == output::dims[3]), kernel_traits, output, input01, input02>::impl,
-			"SOFTMAX: Output dimensions[3] must match input01");
-		static_assert(static_assert_printer<(input02::dims[0] == input01::dims[0]), kernel_traits, output, input01, input02>::impl,
-			"SOFTMAX: Mask dimensions[0] must match scores");
+	template<typename output, typename input01> struct kernel_traits<kernel_type::softmax, output, input01> {
+		static_assert(static_assert_printer<(input01::dims[0] == output::dims[0]), kernel_traits, output, input01>::impl, "SOFTMAX: Output dimensions[0] must match input01");
+		static_assert(static_assert_printer<(input01::dims[1] == output::dims[1]), kernel_traits, output, input01>::impl, "SOFTMAX: Output dimensions[1] must match input01");
+		static_assert(static_assert_printer<(input01::dims[2] == output::dims[2]), kernel_traits, output, input01>::impl, "SOFTMAX: Output dimensions[2] must match input01");
+		static_assert(static_assert_printer<(input01::dims[3] == output::dims[3]), kernel_traits, output, input01>::impl, "SOFTMAX: Output dimensions[3] must match input01");
 		static constexpr auto input01_dims = input01::dims;
-		static constexpr auto input02_dims = input02::dims;
 		static constexpr auto output_dims  = output::dims;
 		using input_type01				   = typename input01::output_type;
-		using input_type02				   = typename input02::output_type;
 		using output_type				   = typename output::output_type;
+		// Per-thread temporaries: running max and sum for each row, so a thread can fold its split of the row into the final normalization.
+		static constexpr uint64_t scratch_bytes{ 2 * sizeof(float) * input01_dims[1] };
 	};
 
 	template<typename output, typename input01> struct kernel_traits<kernel_type::reshape, output, input01> {
@@ -216,6 +215,12 @@ namespace nihilus {
 		static constexpr uint64_t batch_size = input01_dims[2] * input01_dims[3];
 		static constexpr uint64_t expected_output_elements = M * (input02_dims[1] == 1 ? 1 : N) * batch_size;
 		static constexpr uint64_t actual_output_elements	 = output_dims[0] * output_dims[1] * output_dims[2] * output_dims[3];
+		// Per-thread temporaries: the activation row being multiplied, quantized to the weight's block type when only the weight is quantized,
+		// and one 8 x 8 float accumulator panel, enough for the widest interleaved weight layout.
+		static constexpr uint64_t quantized_row_bytes{ type_traits<input_type01>::is_quantized && !type_traits<input_type02>::is_quantized
+				? type_traits<input_type01>::total_byte_size({ { input02_dims[0], 1, 1, 1 } })
+				: 0 };
+		static constexpr uint64_t scratch_bytes{ (quantized_row_bytes + 63) / 64 * 64 + 8 * 8 * sizeof(float) };
 	};
 
 	template<typename output, typename input01, typename input02> struct kernel_traits<kernel_type::get_rows, output, input01, input02> {
@@ -261,6 +266,7 @@ namespace nihilus {
 		using input_type02						= typename input02::output_type;
 		using input_type03						= typename input03::output_type;
 		using output_type						= typename output::output_type;
+		static constexpr bool in_place_capable = std::is_same_v<input_type01, output_type>;
 		static constexpr uint64_t head_dim		= input01::dims[0];
 		static constexpr uint64_t sequence_length = input01::dims[1];
 		static constexpr uint64_t num_heads		= input01::dims[2];
@@ -288,6 +294,7 @@ namespace nihilus {
 		using input_type01					   = typename input01::output_type;
 		using input_type02					   = typename input02::output_type;
 		using output_type					   = typename output::output_type;
+		static constexpr bool in_place_capable = std::is_same_v<input_type01, output_type>;
 		static constexpr uint64_t total_elements = input01_dims[0] * input01_dims[1] * input01_dims[2] * input01_dims[3];
 	};
 
@@ -313,6 +320,7 @@ namespace nihilus {
 		using input_type01					   = typename input01::output_type;
 		using input_type02					   = typename input02::output_type;
 		using output_type					   = typename output::output_type;
+		static constexpr bool in_place_capable = std::is_same_v<input_type01, output_type>;
 		static constexpr uint64_t total_elements = input01_dims[0] * input01_dims[1] * input01_dims[2] * input01_dims[3];
 	};
 
@@ -0,0 +1,156 @@
+/*
+Copyright (c) 2025 RealTimeChris (Chris M.)
+
+This file is part of software offered under a restricted-use license to a designated Licensee,
+whose identity is confirmed in writing by the Author.
+
+License Terms (Summary):
+- Exclusive, non-transferable license for internal use only.
+- Redistribution, sublicensing, or public disclosure is prohibited without written consent.
+- Full ownership remains with the Author.
+- License may terminate if unused for [X months], if materially breached, or by mutual agreement.
+- No warranty is provided, express or implied.
+
+Full license terms are provided in the LICENSE file distributed with this software.
+
+Signed,
+RealTimeChris (Chris M.)
+2025
+*/
+
+#pragma once
+
+#include <nihilus/common/kernel_type_profile_traits.hpp>
+#include <nihilus/common/memory_mapped_file.hpp>
+#include <nihilus/common/core_traits.hpp>
+#include <nihilus/common/model_traits.hpp>
+#include <nihilus/common/common.hpp>
+#include <nihilus/common/array.hpp>
+#include <filesystem>
+#include <fstream>
+#include <cstring>
+#include <vector>
+
+namespace nihilus {
+
+	struct kv_snapshot_header {
+		static constexpr uint64_t magic_value{ 0x50414E53564B484Eull };
+		static constexpr uint32_t current_version{ 1 };
+		uint64_t magic{ magic_value };
+		uint32_t version{ current_version };
+		uint32_t kv_element_size{};
+		uint64_t block_count{};
+		uint64_t kv_dim{};
+		uint64_t token_count{};
+	};
+
+	// File layout: header, token history, then per layer the K rows followed by the V channels, both in position order so positions stay implicit.
+	template<model_config config> struct kv_snapshot {
+		using model_traits_type = model_traits<config.arch, config.model_size, config.model_generation>;
+		using kv_cache_type		= typename kernel_type_profile_traits<config.kernel_profile>::kv_cache_type;
+		using cache_data_type	= array<kv_cache_type*, model_traits_type::block_count>;
+		static constexpr uint64_t kv_dim{ model_traits_type::head_count_kv * model_traits_type::head_dim };
+		static constexpr uint64_t context_length{ sequence_traits<config>::context_length };
+		static constexpr uint64_t page_size{ config.kv_cache_block_size };
+
+		NIHILUS_FORCE_INLINE static constexpr kv_snapshot_header make_header(uint64_t token_count) {
+			kv_snapshot_header return_value{};
+			return_value.kv_element_size = sizeof(kv_cache_type);
+			return_value.block_count	 = model_traits_type::block_count;
+			return_value.kv_dim			 = kv_dim;
+			return_value.token_count	 = token_count;
+			return return_value;
+		}
+
+		NIHILUS_FORCE_INLINE static constexpr uint64_t file_size(uint64_t token_count) {
+			return sizeof(kv_snapshot_header) + token_count * sizeof(int32_t) + 2 * model_traits_type::block_count * token_count * kv_dim * sizeof(kv_cache_type);
+		}
+
+		NIHILUS_FORCE_INLINE static uint64_t physical_row(const std::vector<uint32_t>& pages, uint64_t token) {
+			return pages[token / page_size] * page_size + token % page_size;
+		}
+
+		NIHILUS_FORCE_INLINE static bool save(const std::filesystem::path& path, const cache_data_type& cache_k, const cache_data_type& cache_v,
+			const std::vector<int32_t>& tokens, const std::vector<uint32_t>& pages) {
+			std::ofstream file(path, std::ios::binary | std::ios::trunc);
+			if (!file) {
+				return report_error("Failed to open file for writing: " + path.string());
+			}
+			const uint64_t token_count{ tokens.size() };
+			const kv_snapshot_header header{ make_header(token_count) };
+			file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+			file.write(reinterpret_cast<const char*>(tokens.data()), static_cast<std::streamsize>(token_count * sizeof(int32_t)));
+			std::vector<kv_cache_type> staging(token_count * kv_dim);
+			for (uint64_t x = 0; x < model_traits_type::block_count; ++x) {
+				for (uint64_t y = 0; y < token_count; ++y) {
+					std::memcpy(staging.data() + y * kv_dim, cache_k[x] + physical_row(pages, y) * kv_dim, kv_dim * sizeof(kv_cache_type));
+				}
+				file.write(reinterpret_cast<const char*>(staging.data()), static_cast<std::streamsize>(staging.size() * sizeof(kv_cache_type)));
+				for (uint64_t y = 0; y < kv_dim; ++y) {
+					for (uint64_t z = 0; z < token_count; ++z) {
+						staging[y * token_count + z] = cache_v[x][y * context_length + physical_row(pages, z)];
+					}
+				}
+				file.write(reinterpret_cast<const char*>(staging.data()), static_cast<std::streamsize>(staging.size() * sizeof(kv_cache_type)));
+			}
+			if (!file) {
+				return report_error("Failed to write data to file: " + path.string());
+			}
+			return true;
+		}
+
+		NIHILUS_FORCE_INLINE static const kv_snapshot_header* validate(const memory_mapped_file<config.exceptions>& file) {
+			if (file.size() < sizeof(kv_snapshot_header)) {
+				report_error("Sorry, but this kv snapshot is truncated!");
+				return nullptr;
+			}
+			const kv_snapshot_header* header{ reinterpret_cast<const kv_snapshot_header*>(file.data()) };
+			const kv_snapshot_header expected{ make_header(header->token_count) };
+			if (header->magic != expected.magic || header->version != expected.version) {
+				report_error("Sorry, but this file is not a kv snapshot!");
+				return nullptr;
+			}
+			if (header->kv_element_size != expected.kv_element_size || header->block_count != expected.block_count || header->kv_dim != expected.kv_dim) {
+				report_error("Sorry, but this kv snapshot was written for a different model configuration!");
+				return nullptr;
+			}
+			if (header->token_count > context_length || file.size() < file_size(header->token_count)) {
+				report_error("Sorry, but this kv snapshot is truncated!");
+				return nullptr;
+			}
+			return header;
+		}
+
+		NIHILUS_FORCE_INLINE static void restore(const memory_mapped_file<config.exceptions>& file, const kv_snapshot_header& header, cache_data_type& cache_k,
+			cache_data_type& cache_v, std::vector<int32_t>& tokens, const std::vector<uint32_t>& pages) {
+			const uint64_t token_count{ header.token_count };
+			const uint8_t* current{ file.data() + sizeof(kv_snapshot_header) };
+			tokens.resize(token_count);
+			std::memcpy(tokens.data(), current, token_count * sizeof(int32_t));
+			current += token_count * sizeof(int32_t);
+			for (uint64_t x = 0; x < model_traits_type::block_count; ++x) {
+				for (uint64_t y = 0; y < token_count; ++y) {
+					std::memcpy(cache_k[x] + physical_row(pages, y) * kv_dim, current, kv_dim * sizeof(kv_cache_type));
+					current += kv_dim * sizeof(kv_cache_type);
+				}
+				for (uint64_t y = 0; y < kv_dim; ++y) {
+					for (uint64_t z = 0; z < token_count; ++z) {
+						std::memcpy(cache_v[x] + y * context_length + physical_row(pages, z), current, sizeof(kv_cache_type));
+						current += sizeof(kv_cache_type);
+					}
+				}
+			}
+		}
+
+	  protected:
+		NIHILUS_FORCE_INLINE static bool report_error(const std::string& message) {
+			if constexpr (config.exceptions) {
+				throw std::runtime_error{ message };
+			} else {
+				std::cerr << message << std::endl;
+				return false;
+			}
+		}
+	};
+
+}
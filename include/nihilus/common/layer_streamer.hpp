@@ -0,0 +1,89 @@
+/*
+Copyright (c) 2025 RealTimeChris (Chris M.)
+
+This file is part of software offered under a restricted-use license to a designated Licensee,
+whose identity is confirmed in writing by the Author.
+
+License Terms (Summary):
+- Exclusive, non-transferable license for internal use only.
+- Redistribution, sublicensing, or public disclosure is prohibited without written consent.
+- Full ownership remains with the Author.
+- License may terminate if unused for [X months], if materially breached, or by mutual agreement.
+- No warranty is provided, express or implied.
+
+Full license terms are provided in the LICENSE file distributed with this software.
+
+Signed,
+RealTimeChris (Chris M.)
+2025
+*/
+
+#pragma once
+
+#include <nihilus/common/memory_mapped_file.hpp>
+#include <nihilus/common/model_traits.hpp>
+#include <nihilus/common/common.hpp>
+#include <nihilus/common/array.hpp>
+#include <limits>
+
+namespace nihilus {
+
+	// Keeps only a window of layers of the mapped weights resident, so a model larger than RAM runs at storage bandwidth: as the schedule enters
+	// layer N, layer N + distance is prefetched and layer N - 1 is dropped from the mapping. Weights outside the mapping (repacked copies, reader
+	// images) are never recorded, so they stay resident; streaming a GGUF whose mul_mat weights get repacked therefore saves little, and the
+	// prepacked format, which stores them already repacked inside the file, is the one to stream.
+	template<model_config config> struct layer_streamer {
+		using model_traits_type = model_traits<config.arch, config.model_size, config.model_generation>;
+		static constexpr uint64_t block_count{ model_traits_type::block_count };
+
+		struct layer_span {
+			uint64_t begin{ std::numeric_limits<uint64_t>::max() };
+			uint64_t end{};
+		};
+
+		NIHILUS_FORCE_INLINE void reset(uint64_t distance_new) {
+			distance = distance_new;
+			for (uint64_t x = 0; x < block_count; ++x) {
+				spans[x] = layer_span{};
+			}
+		}
+
+		// Widens layer's span to cover [offset, offset + length) of the mapping; the span is a hull, since GGUF only groups a layer's tensors by convention.
+		NIHILUS_FORCE_INLINE void record(uint64_t layer, uint64_t offset, uint64_t length) {
+			spans[layer].begin = std::min(spans[layer].begin, offset);
+			spans[layer].end   = std::max(spans[layer].end, offset + length);
+		}
+
+		NIHILUS_FORCE_INLINE bool enabled() const {
+			return distance > 0;
+		}
+
+		// Called by a single thread as the schedule enters layer. Dropping a layer another thread is still finishing is harmless: its pages refault.
+		template<bool exceptions> NIHILUS_FORCE_INLINE void enter_layer(memory_mapped_file<exceptions>& file, uint64_t layer) {
+			if (layer == 0) {
+				for (uint64_t x = 0; x <= std::min(distance, block_count - 1); ++x) {
+					advise(file, map_advice::will_need, x);
+				}
+				if (block_count - 1 > distance) {
+					advise(file, map_advice::dont_need, block_count - 1);
+				}
+				return;
+			}
+			advise(file, map_advice::dont_need, layer - 1);
+			if (layer + distance < block_count) {
+				advise(file, map_advice::will_need, layer + distance);
+			}
+		}
+
+	  protected:
+		array<layer_span, block_count> spans{};
+		uint64_t distance{};
+
+		template<bool exceptions> NIHILUS_FORCE_INLINE void advise(memory_mapped_file<exceptions>& file, map_advice advice, uint64_t layer) {
+			if (spans[layer].end > spans[layer].begin) {
+				file.advise(advice, spans[layer].begin, spans[layer].end - spans[layer].begin);
+			}
+		}
+	};
+
+}
@@ -20,6 +20,8 @@ RealTimeChris (Chris M.)
 
 #pragma once
 
+#include <nihilus/common/huge_pages.hpp>
+#include <nihilus/common/numa.hpp>
 #include <nihilus/common/allocator.hpp>
 #include <nihilus/common/common.hpp>
 #include <nihilus/common/config.hpp>
@@ -44,6 +46,8 @@ namespace nihilus {
 				std::swap(current_offset, other.current_offset);
 				std::swap(data_val, other.data_val);
 				std::swap(size_val, other.size_val);
+				std::swap(pages, other.pages);
+				std::swap(locked, other.locked);
 			}
 			return *this;
 		}
@@ -52,22 +56,55 @@ namespace nihilus {
 			*this = std::move(other);
 		}
 
-		NIHILUS_FORCE_INLINE void init(uint64_t size) noexcept {
+		// Anything but huge_page_policy::none maps the buffer directly (falling back policy by policy); backing() reports what was obtained.
+		NIHILUS_FORCE_INLINE void init(uint64_t size, huge_page_policy policy = huge_page_policy::none) noexcept {
 			if (data_val) {
 				clear();
 			}
-			data_val = alloc::allocate(size);
-			size_val = size;
+			pages		   = huge_page_allocator::allocate(size, policy);
+			data_val	   = pages.data ? pages.data : alloc::allocate(size);
+			size_val	   = size;
+			current_offset = 0;
 		}
 
 		NIHILUS_FORCE_INLINE void clear() noexcept {
 			if (data_val) {
-				alloc::deallocate(data_val);
+				if (locked) {
+					huge_page_allocator::unlock(data_val, size_val);
+					locked = false;
+				}
+				if (pages.data) {
+					huge_page_allocator::deallocate(pages);
+					pages = page_allocation{};
+				} else {
+					alloc::deallocate(data_val);
+				}
 				data_val = nullptr;
 				size_val = 0;
 			}
 		}
 
+		// Places [offset, offset + length) of the buffer across NUMA nodes; call before the range is first written so pages are allocated in place.
+		NIHILUS_FORCE_INLINE bool place(numa_placement placement, uint64_t offset = 0, uint64_t length = 0) const noexcept {
+			if (!data_val || offset >= size_val) {
+				return false;
+			}
+			return numa_topology::get().place(data_val + offset, length == 0 || offset + length > size_val ? size_val - offset : length, placement);
+		}
+
+		// Pins the whole buffer in RAM, faulting in whatever was not touched yet; false when it exceeds the process's locked-memory limit.
+		NIHILUS_FORCE_INLINE bool lock() noexcept {
+			if (!data_val) {
+				return false;
+			}
+			locked = locked || huge_page_allocator::lock(data_val, size_val);
+			return locked;
+		}
+
+		NIHILUS_FORCE_INLINE huge_page_policy backing() const noexcept {
+			return pages.backing;
+		}
+
 		NIHILUS_FORCE_INLINE size_type size() noexcept {
 			return size_val;
 		}
@@ -102,6 +139,8 @@ namespace nihilus {
 		size_type current_offset{};
 		value_type* data_val{};
 		size_type size_val{};
+		page_allocation pages{};
+		bool locked{};
 	};
 
 }
@@ -0,0 +1,234 @@
+/*
+Copyright (c) 2025 RealTimeChris (Chris M.)
+
+This file is part of software offered under a restricted-use license to a designated Licensee,
+whose identity is confirmed in writing by the Author.
+
+License Terms (Summary):
+- Exclusive, non-transferable license for internal use only.
+- Redistribution, sublicensing, or public disclosure is prohibited without written consent.
+- Full ownership remains with the Author.
+- License may terminate if unused for [X months], if materially breached, or by mutual agreement.
+- No warranty is provided, express or implied.
+
+Full license terms are provided in the LICENSE file distributed with this software.
+
+Signed,
+RealTimeChris (Chris M.)
+2025
+*/
+
+#pragma once
+
+#include <nihilus/common/config.hpp>
+#include <nihilus/common/common.hpp>
+#include <filesystem>
+#include <stdexcept>
+#include <iostream>
+#include <string>
+
+#if defined(NIHILUS_PLATFORM_WINDOWS)
+	#include <Windows.h>
+#else
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <fcntl.h>
+	#include <unistd.h>
+#endif
+
+namespace nihilus {
+
+	template<bool exceptions> class memory_mapped_file {
+	  public:
+		NIHILUS_FORCE_INLINE memory_mapped_file() noexcept = default;
+
+		NIHILUS_FORCE_INLINE memory_mapped_file& operator=(const memory_mapped_file&) = delete;
+		NIHILUS_FORCE_INLINE memory_mapped_file(const memory_mapped_file&)			  = delete;
+
+		NIHILUS_FORCE_INLINE memory_mapped_file& operator=(memory_mapped_file&& other) noexcept {
+			if (this != &other) {
+				std::swap(data_val, other.data_val);
+				std::swap(size_val, other.size_val);
+#if defined(NIHILUS_PLATFORM_WINDOWS)
+				std::swap(file_handle, other.file_handle);
+				std::swap(mapping_handle, other.mapping_handle);
+#else
+				std::swap(file_descriptor, other.file_descriptor);
+#endif
+			}
+			return *this;
+		}
+
+		NIHILUS_FORCE_INLINE memory_mapped_file(memory_mapped_file&& other) noexcept {
+			*this = std::move(other);
+		}
+
+		NIHILUS_FORCE_INLINE explicit memory_mapped_file(const std::filesystem::path& path, map_options options = {}) {
+			open(path, options);
+		}
+
+		// Read-only and shared, so every process mapping the same file reads one page-cache copy.
+		NIHILUS_FORCE_INLINE bool open(const std::filesystem::path& path, map_options options = {}) {
+			close();
+#if defined(NIHILUS_PLATFORM_WINDOWS)
+			file_handle = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+			if (file_handle == INVALID_HANDLE_VALUE) {
+				return report_error("Failed to open file: " + path.string());
+			}
+			LARGE_INTEGER file_size{};
+			if (!GetFileSizeEx(file_handle, &file_size)) {
+				return report_error("Failed to query file size: " + path.string());
+			}
+			size_val = static_cast<uint64_t>(file_size.QuadPart);
+			if (size_val == 0) {
+				return true;
+			}
+			mapping_handle = CreateFileMappingW(file_handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+			if (!mapping_handle) {
+				return report_error("Failed to create file mapping: " + path.string());
+			}
+			data_val = static_cast<const uint8_t*>(MapViewOfFile(mapping_handle, FILE_MAP_READ, 0, 0, 0));
+			if (!data_val) {
+				return report_error("Failed to map file: " + path.string());
+			}
+			if (options.populate) {
+				advise(map_advice::will_need);
+			}
+#else
+			file_descriptor = ::open(path.c_str(), O_RDONLY);
+			if (file_descriptor == -1) {
+				return report_error("Failed to open file: " + path.string());
+			}
+			struct stat file_stat {};
+			if (fstat(file_descriptor, &file_stat) != 0) {
+				return report_error("Failed to query file size: " + path.string());
+			}
+			size_val = static_cast<uint64_t>(file_stat.st_size);
+			if (size_val == 0) {
+				return true;
+			}
+			int flags{ MAP_SHARED };
+	#if defined(MAP_POPULATE)
+			flags |= options.populate ? MAP_POPULATE : 0;
+	#endif
+			void* mapping = mmap(nullptr, size_val, PROT_READ, flags, file_descriptor, 0);
+			if (mapping == MAP_FAILED) {
+				return report_error("Failed to map file: " + path.string());
+			}
+			data_val = static_cast<const uint8_t*>(mapping);
+	#if !defined(MAP_POPULATE)
+			if (options.populate) {
+				advise(map_advice::will_need);
+			}
+	#endif
+#endif
+			if (options.advice != map_advice::normal) {
+				advise(options.advice);
+			}
+			return true;
+		}
+
+		// Paging hint for [offset, offset + length) of the mapping; a zero length covers the rest of the file. Hints are best effort. The mapping is
+		// read-only and file-backed, so dont_need only drops pages from this process; they refault from the file on the next touch.
+		NIHILUS_FORCE_INLINE bool advise(map_advice advice, uint64_t offset = 0, uint64_t length = 0) noexcept {
+			if (!data_val || offset >= size_val) {
+				return false;
+			}
+			length = length == 0 || offset + length > size_val ? size_val - offset : length;
+#if defined(NIHILUS_PLATFORM_WINDOWS)
+			if (advice == map_advice::dont_need) {
+				// Unlocking pages that were never locked trims them from the working set.
+				VirtualUnlock(const_cast<uint8_t*>(data_val) + offset, static_cast<SIZE_T>(length));
+				return true;
+			}
+			if (advice != map_advice::will_need) {
+				return true;
+			}
+			WIN32_MEMORY_RANGE_ENTRY range{ const_cast<uint8_t*>(data_val) + offset, static_cast<SIZE_T>(length) };
+			return PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0) != 0;
+#else
+			static const uint64_t page_size{ static_cast<uint64_t>(sysconf(_SC_PAGESIZE)) };
+			const uint64_t aligned_offset{ offset - offset % page_size };
+			static constexpr int advice_flags[]{ MADV_NORMAL, MADV_SEQUENTIAL, MADV_RANDOM, MADV_WILLNEED, MADV_DONTNEED };
+			return madvise(const_cast<uint8_t*>(data_val) + aligned_offset, length + (offset - aligned_offset), advice_flags[static_cast<uint64_t>(advice)]) == 0;
+#endif
+		}
+
+		// Pins [offset, offset + length) of the mapping in RAM, reading it in from the file first; a zero length covers the rest of the file. Fails
+		// when the range exceeds the process's locked-memory limit (RLIMIT_MEMLOCK, or the working-set minimum on Windows). Unmapping unlocks.
+		NIHILUS_FORCE_INLINE bool lock(uint64_t offset = 0, uint64_t length = 0) noexcept {
+			if (!data_val || offset >= size_val) {
+				return false;
+			}
+			length = length == 0 || offset + length > size_val ? size_val - offset : length;
+#if defined(NIHILUS_PLATFORM_WINDOWS)
+			return VirtualLock(const_cast<uint8_t*>(data_val) + offset, static_cast<SIZE_T>(length)) != 0;
+#else
+			return mlock(data_val + offset, length) == 0;
+#endif
+		}
+
+		NIHILUS_FORCE_INLINE void close() noexcept {
+#if defined(NIHILUS_PLATFORM_WINDOWS)
+			if (data_val) {
+				UnmapViewOfFile(data_val);
+			}
+			if (mapping_handle) {
+				CloseHandle(mapping_handle);
+				mapping_handle = nullptr;
+			}
+			if (file_handle != INVALID_HANDLE_VALUE) {
+				CloseHandle(file_handle);
+				file_handle = INVALID_HANDLE_VALUE;
+			}
+#else
+			if (data_val) {
+				munmap(const_cast<uint8_t*>(data_val), size_val);
+			}
+			if (file_descriptor != -1) {
+				::close(file_descriptor);
+				file_descriptor = -1;
+			}
+#endif
+			data_val = nullptr;
+			size_val = 0;
+		}
+
+		NIHILUS_FORCE_INLINE const uint8_t* data() const noexcept {
+			return data_val;
+		}
+
+		NIHILUS_FORCE_INLINE uint64_t size() const noexcept {
+			return size_val;
+		}
+
+		NIHILUS_FORCE_INLINE explicit operator bool() const noexcept {
+			return data_val != nullptr;
+		}
+
+		NIHILUS_FORCE_INLINE ~memory_mapped_file() noexcept {
+			close();
+		}
+
+	  protected:
+		const uint8_t* data_val{};
+		uint64_t size_val{};
+#if defined(NIHILUS_PLATFORM_WINDOWS)
+		HANDLE file_handle{ INVALID_HANDLE_VALUE };
+		HANDLE mapping_handle{};
+#else
+		int file_descriptor{ -1 };
+#endif
+
+		NIHILUS_FORCE_INLINE bool report_error(const std::string& message) {
+			close();
+			if constexpr (exceptions) {
+				throw std::runtime_error{ message };
+			} else {
+				std::cerr << message << std::endl;
+				return false;
+			}
+		}
+	};
+
+}
@@ -0,0 +1,407 @@
+/*
+Copyright (c) 2025 RealTimeChris (Chris M.)
+
+This file is part of software offered under a restricted-use license to a designated Licensee,
+whose identity is confirmed in writing by the Author.
+
+License Terms (Summary):
+- Exclusive, non-transferable license for internal use only.
+- Redistribution, sublicensing, or public disclosure is prohibited without written consent.
+- Full ownership remains with the Author.
+- License may terminate if unused for [X months], if materially breached, or by mutual agreement.
+- No warranty is provided, express or implied.
+
+Full license terms are provided in the LICENSE file distributed with this software.
+
+Signed,
+RealTimeChris (Chris M.)
+2025
+*/
+
+#pragma once
+
+#include <nihilus/common/execution_schedule.hpp>
+#include <nihilus/common/kernel_traits.hpp>
+#include <nihilus/common/core_traits.hpp>
+#include <nihilus/common/allocator.hpp>
+#include <nihilus/common/common.hpp>
+#include <nihilus/common/array.hpp>
+#include <limits>
+
+namespace nihilus {
+
+	struct op_lifetime_traits {
+		array<uint64_t, 3> inputs{};
+		uint64_t input_count{};
+		uint64_t bytes{};
+		// Zero-byte and view ops own no storage, so their reads are charged to the buffer they resolve to.
+		bool aliases_input{};
+		// Views (and zero-byte conts) reuse their source's memory outright.
+		bool shares_storage{};
+		bool activation{};
+		bool per_block{};
+		bool blocking{};
+		// The kernel tolerates output == input01, so the op may overwrite its first input when nothing reads it afterwards.
+		bool in_place_capable{};
+	};
+
+	template<typename base_type_new> struct lifetime_collector {
+		NIHILUS_FORCE_INLINE lifetime_collector() noexcept										= default;
+		NIHILUS_FORCE_INLINE lifetime_collector& operator=(const lifetime_collector&) noexcept = delete;
+		NIHILUS_FORCE_INLINE lifetime_collector(const lifetime_collector&) noexcept			= delete;
+		NIHILUS_FORCE_INLINE lifetime_collector& operator=(lifetime_collector&&) noexcept		= delete;
+		NIHILUS_FORCE_INLINE lifetime_collector(lifetime_collector&&) noexcept					= delete;
+		using base_type																			= base_type_new;
+		static constexpr bool view_kind{ base_type::krn_type == kernel_type::permute || base_type::krn_type == kernel_type::reshape ||
+			base_type::krn_type == kernel_type::transpose || base_type::krn_type == kernel_type::view };
+		NIHILUS_FORCE_INLINE static constexpr bool in_place_kernel() {
+			if constexpr (base_type::krn_type == kernel_type::mul || base_type::krn_type == kernel_type::add || base_type::krn_type == kernel_type::sub ||
+				base_type::krn_type == kernel_type::silu || base_type::krn_type == kernel_type::rms_norm || base_type::krn_type == kernel_type::rope) {
+				if constexpr (triple_input<base_type>) {
+					return kernel_traits<base_type::krn_type, base_type, typename base_type::input_type01, typename base_type::input_type02,
+						typename base_type::input_type03>::in_place_capable;
+				} else if constexpr (double_input<base_type>) {
+					return kernel_traits<base_type::krn_type, base_type, typename base_type::input_type01, typename base_type::input_type02>::in_place_capable;
+				} else {
+					return kernel_traits<base_type::krn_type, base_type, typename base_type::input_type01>::in_place_capable;
+				}
+			} else {
+				return false;
+			}
+		}
+		template<uint64_t size> NIHILUS_FORCE_INLINE constexpr static void impl(array<op_lifetime_traits, size>& values) {
+			op_lifetime_traits& value{ values[static_cast<uint64_t>(base_type::type)] };
+			if constexpr (requires { typename base_type::input_type01; }) {
+				value.inputs[value.input_count++] = static_cast<uint64_t>(base_type::input_type01::type);
+			}
+			if constexpr (requires { typename base_type::input_type02; }) {
+				value.inputs[value.input_count++] = static_cast<uint64_t>(base_type::input_type02::type);
+			}
+			if constexpr (requires { typename base_type::input_type03; }) {
+				value.inputs[value.input_count++] = static_cast<uint64_t>(base_type::input_type03::type);
+			}
+			value.bytes			 = base_type::total_required_bytes;
+			value.blocking		 = blocking<base_type>;
+			value.per_block		 = base_type::alc_type == alloc_type::per_block_alloc;
+			value.aliases_input	 = value.input_count > 0 && (view_kind || base_type::total_required_bytes == 0);
+			value.shares_storage = value.input_count > 0 && (view_kind || (base_type::krn_type == kernel_type::cont && base_type::total_required_bytes == 0));
+			value.activation	 = base_type::layer_type != layer_op_type::none && base_type::alc_type == alloc_type::single_alloc && !value.aliases_input &&
+				base_type::total_required_bytes > 0;
+			value.in_place_capable = value.activation && in_place_kernel();
+		}
+	};
+
+	// Compile-time placement of every activation into one shared arena. Live ranges come from the execution schedule and the input_type edges;
+	// buffers whose ranges never overlap are given overlapping offsets.
+	template<model_config config> struct memory_plan {
+		using op_type_type	= op_type_type_t<config>;
+		using schedule_type = execution_schedule<config>;
+		static constexpr uint64_t op_count{ static_cast<uint64_t>(op_type_type::count) };
+		static constexpr uint64_t no_position{ std::numeric_limits<uint64_t>::max() };
+		static constexpr uint64_t block_begin{ schedule_type::global_input_count };
+		static constexpr uint64_t block_end{ block_begin + schedule_type::per_block_count };
+		static constexpr uint64_t timeline_length{ block_end + schedule_type::global_output_count };
+
+		struct live_range {
+			uint64_t begin{ no_position };
+			uint64_t end{};
+		};
+
+		static constexpr array<op_lifetime_traits, op_count> traits{ [] {
+			array<op_lifetime_traits, op_count> return_value{};
+			get_core_traits_config_base_t<config>::template impl_constexpr<lifetime_collector>(return_value);
+			return return_value;
+		}() };
+
+		static constexpr array<uint64_t, op_count> roots{ [] {
+			array<uint64_t, op_count> return_value{};
+			for (uint64_t x = 0; x < op_count; ++x) {
+				uint64_t current{ x };
+				while (traits[current].aliases_input) {
+					current = traits[current].inputs[0];
+				}
+				return_value[x] = current;
+			}
+			return return_value;
+		}() };
+
+		NIHILUS_FORCE_INLINE static constexpr uint64_t op_at(uint64_t position) {
+			if (position < block_begin) {
+				return static_cast<uint64_t>(schedule_type::global_input[position]);
+			} else if (position < block_end) {
+				return static_cast<uint64_t>(schedule_type::per_block[position - block_begin]);
+			} else {
+				return static_cast<uint64_t>(schedule_type::global_output[position - block_end]);
+			}
+		}
+
+		NIHILUS_FORCE_INLINE static constexpr bool in_block(uint64_t position) {
+			return position >= block_begin && position < block_end;
+		}
+
+		static constexpr array<uint64_t, op_count> first_reads{ [] {
+			array<uint64_t, op_count> return_value{};
+			for (uint64_t x = 0; x < op_count; ++x) {
+				return_value[x] = no_position;
+			}
+			for (uint64_t x = 0; x < timeline_length; ++x) {
+				const op_lifetime_traits& consumer{ traits[op_at(x)] };
+				for (uint64_t y = 0; y < consumer.input_count; ++y) {
+					return_value[consumer.inputs[y]] = return_value[consumer.inputs[y]] == no_position ? x : return_value[consumer.inputs[y]];
+				}
+			}
+			return return_value;
+		}() };
+
+		// Order in which a load can make weights resident: stage 0 holds the single weights read before or inside the first block, 1 + layer the
+		// per-block weights of that layer, and the last stage whatever only the global output reads.
+		static constexpr uint64_t weight_stage_count{ model_traits<config.arch, config.model_size, config.model_generation>::block_count + 2 };
+
+		NIHILUS_FORCE_INLINE static constexpr uint64_t weight_stage(uint64_t op, uint64_t layer) {
+			if (traits[op].per_block) {
+				return 1 + layer;
+			}
+			return first_reads[op] < block_end ? 0 : weight_stage_count - 1;
+		}
+
+		struct weight_order {
+			array<uint64_t, op_count> leading{};
+			array<uint64_t, op_count> per_block{};
+			array<uint64_t, op_count> trailing{};
+			uint64_t leading_count{};
+			uint64_t per_block_count{};
+			uint64_t trailing_count{};
+		};
+
+		// Weights in the order the schedule first reads them: single weights needed before or inside the block loop, then the per-block weights
+		// of one layer (repeated for every layer), then the single weights only the global output reads. Storage laid out in this order is swept
+		// front to back by every pass.
+		static constexpr weight_order weight_sequence{ [] {
+			weight_order return_value{};
+			array<bool, op_count> seen{};
+			for (uint64_t x = 0; x < timeline_length; ++x) {
+				const op_lifetime_traits& consumer{ traits[op_at(x)] };
+				for (uint64_t y = 0; y < consumer.input_count; ++y) {
+					const uint64_t input{ consumer.inputs[y] };
+					if (!is_weight_op(input) || seen[input]) {
+						continue;
+					}
+					seen[input] = true;
+					if (traits[input].per_block) {
+						return_value.per_block[return_value.per_block_count++] = input;
+					} else if (x < block_end) {
+						return_value.leading[return_value.leading_count++] = input;
+					} else {
+						return_value.trailing[return_value.trailing_count++] = input;
+					}
+				}
+			}
+			return return_value;
+		}() };
+
+		NIHILUS_FORCE_INLINE static constexpr uint64_t previous_barrier(uint64_t position) {
+			for (uint64_t x = position; x > 0; --x) {
+				if (traits[op_at(x - 1)].blocking) {
+					return x - 1;
+				}
+			}
+			return no_position;
+		}
+
+		NIHILUS_FORCE_INLINE static constexpr uint64_t next_barrier(uint64_t position) {
+			for (uint64_t x = position + 1; x < timeline_length; ++x) {
+				if (traits[op_at(x)].blocking) {
+					return x;
+				}
+			}
+			return no_position;
+		}
+
+		static constexpr uint64_t last_block_barrier{ [] {
+			uint64_t return_value{ no_position };
+			for (uint64_t x = block_begin; x < block_end; ++x) {
+				if (traits[op_at(x)].blocking) {
+					return_value = x;
+				}
+			}
+			return return_value;
+		}() };
+
+		struct value_usage {
+			uint64_t definition{ no_position };
+			uint64_t last_use{};
+			uint64_t use_count{};
+			bool loop_carried{};
+			bool used_per_block{};
+		};
+
+		static constexpr array<value_usage, op_count> usages{ [] {
+			array<value_usage, op_count> return_value{};
+			for (uint64_t x = 0; x < timeline_length; ++x) {
+				if (return_value[op_at(x)].definition == no_position) {
+					return_value[op_at(x)].definition = x;
+				}
+			}
+			for (uint64_t x = 0; x < timeline_length; ++x) {
+				const op_lifetime_traits& consumer{ traits[op_at(x)] };
+				for (uint64_t y = 0; y < consumer.input_count; ++y) {
+					const uint64_t root{ roots[consumer.inputs[y]] };
+					value_usage& usage{ return_value[root] };
+					if (!traits[root].activation || usage.definition == no_position) {
+						continue;
+					}
+					++usage.use_count;
+					usage.last_use		 = x > usage.last_use ? x : usage.last_use;
+					usage.loop_carried	 = usage.loop_carried || (in_block(x) && in_block(usage.definition) && x <= usage.definition);
+					usage.used_per_block = usage.used_per_block || (in_block(x) && !in_block(usage.definition));
+				}
+			}
+			return return_value;
+		}() };
+
+		static constexpr array<live_range, op_count> live_ranges{ [] {
+			array<live_range, op_count> return_value{};
+			for (uint64_t x = 0; x < op_count; ++x) {
+				const value_usage& usage{ usages[x] };
+				if (!traits[x].activation || usage.definition == no_position) {
+					continue;
+				}
+				live_range& range{ return_value[x] };
+				range.begin = usage.loop_carried ? block_begin : usage.definition;
+				range.end	= usage.use_count > 0 ? usage.last_use : timeline_length - 1;
+				if ((usage.loop_carried || usage.used_per_block) && range.end < block_end - 1) {
+					range.end = block_end - 1;
+				}
+				// Between barriers threads drift apart, so a buffer stays reserved from the barrier before its first write to the barrier after its last read.
+				if (!traits[op_at(range.begin)].blocking) {
+					const uint64_t barrier{ previous_barrier(range.begin) };
+					range.begin = barrier == no_position ? 0 : barrier + 1;
+				}
+				if (!traits[op_at(range.end)].blocking) {
+					const uint64_t barrier{ next_barrier(range.end) };
+					range.end = barrier == no_position ? timeline_length - 1 : barrier - 1;
+				}
+				// The head of block n + 1 runs while stragglers finish the tail of block n.
+				if ((in_block(usage.definition) || usage.used_per_block) && last_block_barrier != no_position && range.end > last_block_barrier && range.begin > block_begin) {
+					range.begin = block_begin;
+				}
+			}
+			return return_value;
+		}() };
+
+		NIHILUS_FORCE_INLINE static constexpr uint64_t planned_bytes(uint64_t index) {
+			return roundUpToMultiple(traits[index].bytes, 64ull);
+		}
+
+		// An in-place capable op takes over its first input's storage when it is the only reader of that buffer and both sit in the same pass of the schedule.
+		static constexpr array<uint64_t, op_count> storage_roots{ [] {
+			array<uint64_t, op_count> return_value{};
+			for (uint64_t x = 0; x < op_count; ++x) {
+				return_value[x] = x;
+			}
+			for (uint64_t x = 0; x < timeline_length; ++x) {
+				const uint64_t current{ op_at(x) };
+				if (usages[current].definition != x || !traits[current].in_place_capable) {
+					continue;
+				}
+				const uint64_t input{ roots[traits[current].inputs[0]] };
+				const value_usage& usage{ usages[input] };
+				if (traits[input].activation && usage.definition != no_position && usage.use_count == 1 && usage.last_use == x && !usage.loop_carried &&
+					!usage.used_per_block && in_block(usage.definition) == in_block(x) && planned_bytes(return_value[input]) >= planned_bytes(current)) {
+					return_value[current] = return_value[input];
+				}
+			}
+			return return_value;
+		}() };
+
+		NIHILUS_FORCE_INLINE static constexpr bool in_place(uint64_t index) {
+			return storage_roots[index] != index;
+		}
+
+		static constexpr array<live_range, op_count> storage_ranges{ [] {
+			array<live_range, op_count> return_value{};
+			for (uint64_t x = 0; x < op_count; ++x) {
+				if (live_ranges[x].begin == no_position) {
+					continue;
+				}
+				live_range& range{ return_value[storage_roots[x]] };
+				range.begin = live_ranges[x].begin < range.begin ? live_ranges[x].begin : range.begin;
+				range.end	= live_ranges[x].end > range.end ? live_ranges[x].end : range.end;
+			}
+			return return_value;
+		}() };
+
+		NIHILUS_FORCE_INLINE static constexpr bool overlaps(uint64_t lhs, uint64_t rhs) {
+			return storage_ranges[lhs].begin <= storage_ranges[rhs].end && storage_ranges[rhs].begin <= storage_ranges[lhs].end;
+		}
+
+		static constexpr array<uint64_t, op_count> offsets{ [] {
+			array<uint64_t, op_count> return_value{};
+			array<uint64_t, op_count> order{};
+			array<bool, op_count> placed{};
+			uint64_t order_count{};
+			for (uint64_t x = 0; x < op_count; ++x) {
+				if (traits[x].activation && storage_roots[x] == x && storage_ranges[x].begin != no_position) {
+					uint64_t y{ order_count++ };
+					while (y > 0 && planned_bytes(order[y - 1]) < planned_bytes(x)) {
+						order[y] = order[y - 1];
+						--y;
+					}
+					order[y] = x;
+				}
+			}
+			for (uint64_t x = 0; x < order_count; ++x) {
+				const uint64_t current{ order[x] };
+				uint64_t candidate{};
+				bool moved{ true };
+				while (moved) {
+					moved = false;
+					for (uint64_t y = 0; y < op_count; ++y) {
+						if (placed[y] && overlaps(current, y) && candidate < return_value[y] + planned_bytes(y) && return_value[y] < candidate + planned_bytes(current)) {
+							candidate = return_value[y] + planned_bytes(y);
+							moved	  = true;
+						}
+					}
+				}
+				return_value[current] = candidate;
+				placed[current]		  = true;
+			}
+			for (uint64_t x = 0; x < op_count; ++x) {
+				const uint64_t storage_root{ storage_roots[roots[x]] };
+				if ((traits[x].activation || traits[x].shares_storage) && placed[storage_root]) {
+					return_value[x] = return_value[storage_root];
+				}
+			}
+			return return_value;
+		}() };
+
+		static constexpr array<bool, op_count> planned{ [] {
+			array<bool, op_count> return_value{};
+			for (uint64_t x = 0; x < op_count; ++x) {
+				const bool root_planned{ traits[roots[x]].activation && live_ranges[roots[x]].begin != no_position };
+				return_value[x] = (x == roots[x] && root_planned) || (traits[x].shares_storage && root_planned);
+			}
+			return return_value;
+		}() };
+
+		static constexpr uint64_t arena_bytes{ [] {
+			uint64_t return_value{};
+			for (uint64_t x = 0; x < op_count; ++x) {
+				if (planned[x] && x == storage_roots[x] && x == roots[x] && offsets[x] + planned_bytes(x) > return_value) {
+					return_value = offsets[x] + planned_bytes(x);
+				}
+			}
+			return return_value;
+		}() };
+
+		// What the same buffers cost with one private region each, as memory_mapper did before planning.
+		static constexpr uint64_t unplanned_bytes{ [] {
+			uint64_t return_value{};
+			for (uint64_t x = 0; x < op_count; ++x) {
+				return_value += planned[x] ? planned_bytes(x) : 0;
+			}
+			return return_value;
+		}() };
+	};
+
+}
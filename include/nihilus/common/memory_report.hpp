@@ -0,0 +1,188 @@
+/*
+Copyright (c) 2025 RealTimeChris (Chris M.)
+
+This file is part of software offered under a restricted-use license to a designated Licensee,
+whose identity is confirmed in writing by the Author.
+
+License Terms (Summary):
+- Exclusive, non-transferable license for internal use only.
+- Redistribution, sublicensing, or public disclosure is prohibited without written consent.
+- Full ownership remains with the Author.
+- License may terminate if unused for [X months], if materially breached, or by mutual agreement.
+- No warranty is provided, express or implied.
+
+Full license terms are provided in the LICENSE file distributed with this software.
+
+Signed,
+RealTimeChris (Chris M.)
+2025
+*/
+
+#pragma once
+
+#include <nihilus/common/weight_repacker.hpp>
+#include <nihilus/common/memory_planner.hpp>
+#include <nihilus/common/scratch_arena.hpp>
+#include <nihilus/cpu/thread_pool.hpp>
+#include <nihilus/common/common.hpp>
+#include <nihilus/common/array.hpp>
+#include <iostream>
+#include <iomanip>
+
+namespace nihilus {
+
+	enum class memory_category : uint8_t {
+		weights,
+		kv_cache,
+		activations,
+		scratch,
+		region_count,
+	};
+
+	inline static constexpr const char* memory_category_names[]{ "WEIGHTS", "KV CACHE", "ACTIVATIONS", "SCRATCH" };
+
+	struct op_footprint {
+		memory_category category{ memory_category::region_count };
+		uint64_t instance_bytes{};
+		uint64_t instances{};
+		// Planned activations share the arena with every op whose live range they do not overlap, so their bytes are not additive.
+		bool planned{};
+	};
+
+	template<typename base_type_new> struct footprint_collector {
+		NIHILUS_FORCE_INLINE footprint_collector() noexcept										= default;
+		NIHILUS_FORCE_INLINE footprint_collector& operator=(const footprint_collector&) noexcept = delete;
+		NIHILUS_FORCE_INLINE footprint_collector(const footprint_collector&) noexcept			= delete;
+		NIHILUS_FORCE_INLINE footprint_collector& operator=(footprint_collector&&) noexcept		= delete;
+		NIHILUS_FORCE_INLINE footprint_collector(footprint_collector&&) noexcept				= delete;
+		using base_type																			= base_type_new;
+
+		template<uint64_t size> NIHILUS_FORCE_INLINE constexpr static void impl(array<op_footprint, size>& values) {
+			if constexpr (requires { base_type::total_required_bytes; }) {
+				op_footprint& value{ values[static_cast<uint64_t>(base_type::type)] };
+				const uint64_t op{ static_cast<uint64_t>(base_type::type) };
+				value.category		 = is_weight_op(base_type::type) ? memory_category::weights
+						 : op == static_cast<uint64_t>(llama_op_types::cache_k) || op == static_cast<uint64_t>(llama_op_types::cache_v) ? memory_category::kv_cache
+																																		  : memory_category::activations;
+				value.instance_bytes = base_type::total_required_bytes;
+				value.instances		 = base_type::alc_type == alloc_type::per_block_alloc ? base_type::model_traits_type::block_count : 1;
+			}
+		}
+	};
+
+	// Where total_required_bytes and the weight storage go, split into weights, kv cache, activations and scratch, per op and per layer; all of it
+	// known at compile time, so capacity planning needs no allocation. Weights are what core_traits binds (the file's tensors, shareable through the
+	// page cache) plus the repacked copies in anonymous memory; everything else is paid again by every model instance.
+	template<model_config config> struct memory_report {
+		using plan_type			= memory_plan<config>;
+		using decode_plan_type	= memory_plan<decode_config<config>>;
+		using model_traits_type = model_traits<config.arch, config.model_size, config.model_generation>;
+		static constexpr uint64_t op_count{ plan_type::op_count };
+		static constexpr uint64_t block_count{ model_traits_type::block_count };
+		static constexpr uint64_t largest_count{ 8 };
+
+		static constexpr array<op_footprint, op_count> ops{ [] {
+			array<op_footprint, op_count> return_value{};
+			get_core_traits_config_base_t<config>::template impl_constexpr<footprint_collector>(return_value);
+			for (uint64_t x = 0; x < op_count; ++x) {
+				return_value[x].planned = plan_type::planned[x];
+				// A tied output projection is bound to the embedding table and owns nothing.
+				if (model_traits_type::tied_embeddings && x == static_cast<uint64_t>(llama_op_types::output_weight)) {
+					return_value[x].instances = 0;
+				}
+			}
+			return return_value;
+		}() };
+
+		NIHILUS_FORCE_INLINE static constexpr uint64_t op_bytes(uint64_t op) {
+			return ops[op].instance_bytes * ops[op].instances;
+		}
+
+		// Bytes owned outright; planned activations are covered by the arenas instead.
+		NIHILUS_FORCE_INLINE static constexpr uint64_t owned_bytes(uint64_t op) {
+			return ops[op].planned ? 0 : op_bytes(op);
+		}
+
+		NIHILUS_FORCE_INLINE static constexpr uint64_t category_op_bytes(memory_category category) {
+			uint64_t return_value{};
+			for (uint64_t x = 0; x < op_count; ++x) {
+				return_value += ops[x].category == category ? owned_bytes(x) : 0;
+			}
+			return return_value;
+		}
+
+		static constexpr uint64_t weight_bytes{ category_op_bytes(memory_category::weights) };
+		static constexpr uint64_t repacked_weight_bytes{ weight_layout_plan<config>::repacked_bytes };
+		static constexpr uint64_t kv_cache_bytes{ category_op_bytes(memory_category::kv_cache) };
+		static constexpr uint64_t activation_bytes{ category_op_bytes(memory_category::activations) + plan_type::arena_bytes + decode_plan_type::arena_bytes };
+		static constexpr uint64_t scratch_bytes_per_thread{ scratch_plan<config>::bytes_per_thread };
+		static_assert(kv_cache_bytes + activation_bytes == collect_required_bytes<config>::impl() + decode_plan_type::arena_bytes,
+			"Sorry, but the memory report no longer accounts for every byte of the activation buffer!");
+
+		NIHILUS_FORCE_INLINE static constexpr uint64_t layer_bytes(memory_category category) {
+			uint64_t return_value{};
+			for (uint64_t x = 0; x < op_count; ++x) {
+				return_value += ops[x].category == category && ops[x].instances == block_count && !ops[x].planned ? ops[x].instance_bytes : 0;
+			}
+			return return_value;
+		}
+
+		// Ranked by what each op would occupy on its own, planned or not, since the largest planned buffers size the arena.
+		static constexpr array<uint64_t, largest_count> largest{ [] {
+			array<uint64_t, largest_count> return_value{};
+			array<bool, op_count> taken{};
+			for (uint64_t x = 0; x < largest_count; ++x) {
+				uint64_t best{ op_count };
+				for (uint64_t y = 0; y < op_count; ++y) {
+					if (!taken[y] && ops[y].category != memory_category::weights && op_bytes(y) > 0 && (best == op_count || op_bytes(y) > op_bytes(best))) {
+						best = y;
+					}
+				}
+				return_value[x] = best;
+				if (best < op_count) {
+					taken[best] = true;
+				}
+			}
+			return return_value;
+		}() };
+
+		NIHILUS_FORCE_INLINE static void print(std::ostream& stream, uint64_t thread_count) {
+			const uint64_t scratch_bytes{ scratch_bytes_per_thread * thread_count };
+			const uint64_t instance_bytes{ kv_cache_bytes + activation_bytes + scratch_bytes };
+			stream << std::fixed << std::setprecision(2) << "NIHILUS MEMORY REPORT (" << block_count << " LAYERS, " << thread_count << " THREADS)" << std::endl;
+			stream << "PER OP:" << std::endl;
+			for (uint64_t x = 0; x < op_count; ++x) {
+				if (op_bytes(x) == 0) {
+					continue;
+				}
+				stream << "  " << std::left << std::setw(24) << llama_op_names[x] << std::setw(12) << memory_category_names[static_cast<uint64_t>(ops[x].category)] << std::right
+					   << std::setw(12) << mib(ops[x].instance_bytes) << " MiB x " << std::setw(3) << ops[x].instances << " = " << std::setw(12) << mib(op_bytes(x)) << " MiB"
+					   << (ops[x].planned ? " (IN SHARED ARENA)" : "") << std::endl;
+			}
+			stream << "PER LAYER: " << mib(layer_bytes(memory_category::weights)) << " MiB WEIGHTS, " << mib(layer_bytes(memory_category::kv_cache)) << " MiB KV CACHE"
+				   << std::endl;
+			stream << "LARGEST NON-WEIGHT BUFFERS:" << std::endl;
+			for (uint64_t x = 0; x < largest_count && largest[x] < op_count; ++x) {
+				stream << "  " << std::left << std::setw(24) << llama_op_names[largest[x]] << std::right << std::setw(12) << mib(op_bytes(largest[x])) << " MiB "
+					   << std::setw(6) << percent(op_bytes(largest[x]), instance_bytes) << "% OF PER-INSTANCE" << std::endl;
+			}
+			stream << "TOTALS:" << std::endl;
+			stream << "  " << std::left << std::setw(36) << "WEIGHTS (MAPPED, SHAREABLE)" << std::right << std::setw(12) << mib(weight_bytes) << " MiB" << std::endl;
+			stream << "  " << std::left << std::setw(36) << "WEIGHTS (REPACKED COPIES)" << std::right << std::setw(12) << mib(repacked_weight_bytes) << " MiB" << std::endl;
+			stream << "  " << std::left << std::setw(36) << "KV CACHE" << std::right << std::setw(12) << mib(kv_cache_bytes) << " MiB" << std::endl;
+			stream << "  " << std::left << std::setw(36) << "ACTIVATIONS (ARENAS + UNPLANNED)" << std::right << std::setw(12) << mib(activation_bytes) << " MiB" << std::endl;
+			stream << "  " << std::left << std::setw(36) << "SCRATCH" << std::right << std::setw(12) << mib(scratch_bytes) << " MiB" << std::endl;
+			stream << "  " << std::left << std::setw(36) << "PER INSTANCE (KV + ACT + SCRATCH)" << std::right << std::setw(12) << mib(instance_bytes) << " MiB" << std::endl;
+		}
+
+	  protected:
+		NIHILUS_FORCE_INLINE static double mib(uint64_t bytes) {
+			return static_cast<double>(bytes) / (1024.0 * 1024.0);
+		}
+
+		NIHILUS_FORCE_INLINE static double percent(uint64_t bytes, uint64_t total) {
+			return total > 0 ? 100.0 * static_cast<double>(bytes) / static_cast<double>(total) : 0.0;
+		}
+	};
+
+}
@@ -22,6 +22,13 @@ RealTimeChris (Chris M.)
 
 #include <nihilus/common/arch_traits.hpp>
 #include <nihilus/common/model_traits.hpp>
+#include <nihilus/common/prefix_cache.hpp>
+#include <nihilus/common/kv_snapshot.hpp>
+#include <nihilus/common/context_shift.hpp>
+#include <nihilus/common/weight_repacker.hpp>
+#include <nihilus/common/memory_report.hpp>
+#include <nihilus/common/layer_streamer.hpp>
+#include <nihilus/common/direct_file_reader.hpp>
 #include <nihilus/cpu/thread_pool.hpp>
 #include <nihilus/common/h_params.hpp>
 #include <nihilus/common/tuple.hpp>
@@ -37,31 +44,238 @@ namespace nihilus {
 
 	static constexpr impl_indices indices_new{};
 
+	template<model_config config, model_arch arch, model_format type> struct model_parser;
+
+	// Single-row instantiation of the op graph; its weights and kv cache point at the prefill graph's, only the activations get their own arena.
+	template<model_config config> struct decode_graph : public get_core_traits_config_base_t<config> {
+		NIHILUS_FORCE_INLINE decode_graph()								  = default;
+		NIHILUS_FORCE_INLINE decode_graph& operator=(decode_graph&&)	  = delete;
+		NIHILUS_FORCE_INLINE decode_graph(decode_graph&&)				  = delete;
+		NIHILUS_FORCE_INLINE decode_graph& operator=(const decode_graph&) = delete;
+		NIHILUS_FORCE_INLINE decode_graph(const decode_graph&)			  = delete;
+	};
+
 	template<model_config config> struct model : public model_base<decltype(config.model_size), decltype(config.model_generation)>,
 												 public get_core_traits_config_base_t<config>,
+												 public decode_graph<decode_config<config>>,
 												 public thread_pool<config, model<config>>,
 												 public hyper_parameters<config.arch> {
 		using core_bases_config_type		  = get_core_traits_config_base_t<config>;
+		using decode_bases_type				  = get_core_traits_config_base_t<decode_config<config>>;
+		using decode_plan_type				  = memory_plan<decode_config<config>>;
 		using model_traits_type				  = model_traits<config.arch, config.model_size, config.model_generation>;
 		using op_type_type					  = model_traits_type::op_type_type;
 		using kernel_type_profile_traits_type = kernel_type_profile_traits<config.kernel_profile>;
 		using base_type						  = model_base<decltype(config.model_size), decltype(config.model_generation)>;
+		using direct_layout_type			  = weight_memory_layout<config, direct_file_reader<config.exceptions>::alignment>;
 		inline static constexpr impl_indices indices{ indices_new };
-		inline static constexpr uint64_t total_required_bytes{ collect_required_bytes<config>::impl() };
+		inline static constexpr uint64_t total_required_bytes{ collect_required_bytes<config>::impl() + decode_plan_type::arena_bytes };
 		NIHILUS_FORCE_INLINE model()						  = default;
 		NIHILUS_FORCE_INLINE model& operator=(model&&)	  = delete;
 		NIHILUS_FORCE_INLINE model(model&&)				  = delete;
 		NIHILUS_FORCE_INLINE model& operator=(const model&) = delete;
 		NIHILUS_FORCE_INLINE model(const model&)			  = delete;
-		NIHILUS_FORCE_INLINE model(cli_params params) : thread_pool<config, model>{ params.thread_count } {
-			memory.init(total_required_bytes);
-			core_bases_config_type::template impl<memory_mapper>(memory);
-			core_bases_config_type::template impl<execution_planner>(params.thread_count);
+		NIHILUS_FORCE_INLINE ~model() {
+			finish_loading();
+		}
+		NIHILUS_FORCE_INLINE model(cli_params params) : thread_pool<config, model>{ params.thread_count, params.numa != numa_placement::none } {
+			setup(params);
 		}
 
 		NIHILUS_FORCE_INLINE void init(cli_params params) {
-			memory.init(total_required_bytes);
-			core_bases_config_type::template impl<memory_mapper>(memory);
+			setup(params);
+		}
+
+		NIHILUS_FORCE_INLINE void map_memory() {
+			uint8_t* arena{ static_cast<uint8_t*>(memory.claim_memory(memory_plan<config>::arena_bytes)) };
+			core_bases_config_type::template impl<memory_mapper>(memory, memory_plan<config>{}, arena);
+			decode_arena = static_cast<uint8_t*>(memory.claim_memory(decode_plan_type::arena_bytes));
+			bind_decode_graph();
+		}
+
+		// Weights are never copied: every weight core points straight into the read-only mapping of the model file, which the model keeps open.
+		NIHILUS_FORCE_INLINE bool load_weights(const std::filesystem::path& path, map_options options = {}) {
+			finish_loading();
+			weight_memory.clear();
+			repacked_weights = nullptr;
+			direct_weights	 = nullptr;
+			direct_reader.close();
+			layer_streamer_val.reset(options.stream_distance);
+			return model_parser<config, config.arch, config.format>::load_weights(*this, path, options);
+		}
+
+		// Storage for weights the parser rewrites into their kernel's preferred layout; the mapping itself is read-only.
+		NIHILUS_FORCE_INLINE uint8_t* claim_weight_memory(uint64_t size) {
+			if (!weight_memory.data()) {
+				weight_memory.init(weight_layout_plan<config>::repacked_bytes, page_policy);
+				report_placement("WEIGHT", weight_memory.place(numa_policy == numa_placement::none ? numa_placement::none : numa_placement::interleave));
+				report_backing("WEIGHT", weight_memory.backing());
+			}
+			return static_cast<uint8_t*>(weight_memory.claim_memory(size));
+		}
+
+		// Repacked weights go to their execution-order slot (see weight_memory_layout), whatever order the file lists them in.
+		NIHILUS_FORCE_INLINE uint8_t* claim_repacked_weight(uint64_t op, uint64_t layer) {
+			if (!weight_layout_plan<config>::repacked(op) || layer >= model_traits_type::block_count) {
+				return nullptr;
+			}
+			if (direct_weights) {
+				return claim_direct_weight(op, layer);
+			}
+			if (!repacked_weights) {
+				repacked_weights = claim_weight_memory(weight_layout_plan<config>::repacked_bytes);
+				if (!repacked_weights) {
+					return nullptr;
+				}
+			}
+			return repacked_weights + weight_memory_layout<config>::offset(op, layer);
+		}
+
+		// Opens path for direct reads and sizes weight memory for a slot per stored weight, in the execution order of weight_memory_layout.
+		NIHILUS_FORCE_INLINE direct_file_reader<config.exceptions>* open_direct_reader(const std::filesystem::path& path, weight_reader requested) {
+			static constexpr uint64_t alignment{ direct_file_reader<config.exceptions>::alignment };
+			if (!direct_reader.open(path, requested)) {
+				return nullptr;
+			}
+			weight_memory.init(direct_layout_type::total_bytes + alignment, page_policy);
+			report_placement("WEIGHT", weight_memory.place(numa_policy == numa_placement::none ? numa_placement::none : numa_placement::interleave));
+			report_backing("WEIGHT", weight_memory.backing());
+			uint8_t* base{ static_cast<uint8_t*>(weight_memory.claim_memory(direct_layout_type::total_bytes + alignment)) };
+			if (!base) {
+				return nullptr;
+			}
+			direct_weights = reinterpret_cast<uint8_t*>(roundUpToMultiple(reinterpret_cast<uintptr_t>(base), alignment));
+			return &direct_reader;
+		}
+
+		// The start of op's slot once open_direct_reader has run; nullptr for weights that keep no storage of their own.
+		NIHILUS_FORCE_INLINE uint8_t* claim_direct_weight(uint64_t op, uint64_t layer) {
+			if (!direct_weights || !direct_layout_type::owns(op) || layer >= model_traits_type::block_count) {
+				return nullptr;
+			}
+			return direct_weights + direct_layout_type::offset(op, layer);
+		}
+
+		NIHILUS_FORCE_INLINE void adopt_weight_file(memory_mapped_file<config.exceptions>&& file) {
+			weight_file = std::move(file);
+			bind_decode_graph();
+			if (layer_streamer_val.enabled()) {
+				record_layer_spans_impl(std::make_index_sequence<static_cast<uint64_t>(op_type_type::count)>{});
+			}
+		}
+
+		// Drains schedule on the pool before returning or, with background set, hands it to a loader thread that publishes each finished stage.
+		// Direct reads are issued by whichever thread runs the schedule, ahead of the repacks that consume them.
+		NIHILUS_FORCE_INLINE bool run_weight_schedule(weight_load_schedule<half>&& schedule, bool background) {
+			finish_loading();
+			// Placement goes first, so the repacks and page-ins below allocate each weight's pages on the node that will read them.
+			if (numa_policy != numa_placement::none) {
+				report_placement("WEIGHT", place_weights_impl(std::make_index_sequence<static_cast<uint64_t>(op_type_type::count)>{}));
+			}
+			if (!background) {
+				const bool read{ schedule.run_reads(direct_reader) };
+				direct_reader.close();
+				if (read && !schedule.empty()) {
+					this->execute_job(schedule);
+				}
+				return read;
+			}
+			weight_schedule = std::move(schedule);
+			resident_stages.store(0, std::memory_order_release);
+			weight_loader = std::thread{ [this] {
+				const bool read{ weight_schedule.run_in_order(resident_stages, memory_plan<config>::weight_stage_count, direct_reader) };
+				direct_reader.close();
+				if (!read) {
+					// The reader has reported why; releasing every stage keeps the workers from waiting on weights that will never arrive.
+					std::cerr << "Sorry, but the background weight load stopped early; the model's weights are incomplete!" << std::endl;
+					resident_stages.store(std::numeric_limits<uint64_t>::max(), std::memory_order_release);
+					resident_stages.notify_all();
+					return;
+				}
+				if (warmup_level >= startup_warmup::lock) {
+					lock_weights();
+				}
+			} };
+			return true;
+		}
+
+		NIHILUS_FORCE_INLINE void finish_loading() {
+			if (weight_loader.joinable()) {
+				weight_loader.join();
+			}
+			resident_stages.store(std::numeric_limits<uint64_t>::max(), std::memory_order_release);
+		}
+
+		// Takes the first request's page faults at startup instead (see startup_warmup) and reports what that cost. While weights load in the
+		// background, locking moves to the loader thread and the throwaway token is skipped, since either would block until loading is done.
+		NIHILUS_FORCE_INLINE void warmup(bool weights_loaded) {
+			if (warmup_level == startup_warmup::none) {
+				return;
+			}
+			stop_watch<std::chrono::microseconds> warmup_time{ 0 };
+			warmup_time.reset();
+			prefault_pages();
+			const bool loading{ weight_loader.joinable() };
+			if (warmup_level >= startup_warmup::lock && !loading) {
+				lock_weights();
+			}
+			if (warmup_level == startup_warmup::full && weights_loaded && !loading) {
+				run_warmup_token();
+			}
+			std::cout << "NIHILUS WARMUP (" << startup_warmup_names[static_cast<uint64_t>(warmup_level)] << "): " << std::fixed << std::setprecision(2)
+					  << static_cast<double>(warmup_time.total_time_elapsed_uint64()) / 1000.0 << " ms" << std::endl;
+		}
+
+		// Every worker calls this before each stage of the schedule (see memory_plan::weight_stage); once loading is done it is one load.
+		NIHILUS_FORCE_INLINE void wait_resident(uint64_t stage) {
+			uint64_t current{ resident_stages.load(std::memory_order_acquire) };
+			while (current <= stage) {
+				resident_stages.wait(current, std::memory_order_acquire);
+				current = resident_stages.load(std::memory_order_acquire);
+			}
+		}
+
+		// Called by one worker as both graphs enter each block; a no-op unless weights were loaded with a stream_distance.
+		NIHILUS_FORCE_INLINE void enter_layer(uint64_t layer) {
+			if (layer_streamer_val.enabled()) {
+				layer_streamer_val.enter_layer(weight_file, layer);
+			}
+		}
+
+		// Binds op (a weight op index) of the given layer to size bytes at data; returns false for non-weight ops, bad layers or short tensors.
+		NIHILUS_FORCE_INLINE bool bind_weight(uint64_t op, uint64_t layer, const uint8_t* data, uint64_t size) {
+			return bind_weight_impl(op, layer, data, size, std::make_index_sequence<static_cast<uint64_t>(op_type_type::count)>{});
+		}
+
+		// Points output_weight at token_embd_weight for checkpoints that tie the two (see model_traits::tied_embeddings); result_output then reads it
+		// through the row_major mul_mat kernel. When the layout plan repacks output_weight, because this config was not declared tied, it gets a
+		// repacked copy of the embedding instead of sharing it.
+		NIHILUS_FORCE_INLINE bool tie_output_weight(weight_load_schedule<half>& schedule) {
+			using embedding_type = core_traits<config, op_type_type::token_embd_weight>;
+			using output_type	 = core_traits<config, op_type_type::output_weight>;
+			static_assert(std::is_same_v<typename embedding_type::output_type, typename output_type::output_type> && embedding_type::dims == output_type::dims,
+				"Sorry, but tied weights must share a type and shape!");
+			static constexpr uint64_t op{ static_cast<uint64_t>(op_type_type::output_weight) };
+			const uint8_t* embedding{ reinterpret_cast<const uint8_t*>(get_core<op_type_type::token_embd_weight>().data) };
+			if (!embedding) {
+				return false;
+			}
+			if constexpr (weight_layout_plan<config>::repacked(op)) {
+				static constexpr const weight_repack_traits& traits{ weight_layout_plan<config>::traits[op] };
+				uint8_t* repacked_weight{ claim_repacked_weight(op, 0) };
+				if (!repacked_weight) {
+					return false;
+				}
+				schedule.add_repack(traits, repacked_weight, embedding, memory_plan<config>::weight_stage(op, 0));
+				return bind_weight(op, 0, repacked_weight, traits.bytes);
+			} else {
+				return bind_weight(op, 0, embedding, embedding_type::total_required_bytes);
+			}
+		}
+
+		// Re-run whenever prefill weights or caches are rebound, so both graphs keep reading the same tensors.
+		NIHILUS_FORCE_INLINE void bind_decode_graph() {
+			bind_decode_graph_impl(std::make_index_sequence<static_cast<uint64_t>(op_type_type::count)>{});
 		}
 
 		template<op_type_type type> NIHILUS_FORCE_INLINE auto& get_core() {
@@ -69,16 +283,428 @@ namespace nihilus {
 		}
 
 		NIHILUS_FORCE_INLINE void execute_model(execution_parameters& params) {
-			for (size_t x = 0; x < params.token_count + 1; ++x) {
-				core_bases_config_type::template impl<execution_planner>(thread_count);
-				this->execute_tasks();
+			if (params.clear_kv_cache) {
+				reset_sequence();
+			}
+			if (params.batch_size == 0 || params.batch_size > batch_length) {
+				params.batch_size = batch_length;
+			}
+			if (!prepare_sequence(params)) {
+				return;
+			}
+			auto& kq_soft_max			= get_core<op_type_type::kq_soft_max>();
+			kq_soft_max.mask.row_stride = core_traits<config, op_type_type::kq_soft_max>::dims[1];
+			params.generated_count		= 0;
+			if (params.token_count == 0) {
+				publish_sequence(params);
+				return;
+			}
+			// The prompt runs through the prefill graph in chunks of at most batch_size rows, each attending to everything before it; a single-token
+			// prompt takes the decode graph. Each of the max_new_tokens - 1 passes after it feeds back the previous sample, so a pass count only
+			// depends on the prompt's chunking and the generation count.
+			int32_t token{};
+			if (params.token_count > 1) {
+				for (size_t x = 0; x < params.token_count; x += params.batch_size) {
+					kq_soft_max.mask.position_offset = params.position_offset + x;
+					kq_soft_max.mask.query_count	 = std::min<uint64_t>(params.batch_size, params.token_count - x);
+					load_inputs<config>(params.input_tokens + x, kq_soft_max.mask.position_offset, kq_soft_max.mask.query_count);
+					core_bases_config_type::template impl<execution_planner>(this->thread_count);
+					this->execute_tasks(false);
+				}
+				token = pick_token<config>(kq_soft_max.mask.query_count - 1);
+			} else {
+				token = run_decode_pass(params.input_tokens, params.position_offset);
 			}
+			sequence_tokens.insert(sequence_tokens.end(), params.input_tokens, params.input_tokens + params.token_count);
+			while (params.generated_count < params.max_new_tokens) {
+				if (params.output_tokens) {
+					params.output_tokens[params.generated_count] = token;
+				}
+				if (++params.generated_count == params.max_new_tokens) {
+					break;
+				}
+				execution_parameters step{ params };
+				step.input_tokens = &token;
+				step.token_count  = 1;
+				step.use_cache	  = false;
+				if (!prepare_sequence(step)) {
+					break;
+				}
+				const int32_t fed_token{ token };
+				token = run_decode_pass(&fed_token, step.position_offset);
+				sequence_tokens.emplace_back(fed_token);
+			}
+			publish_sequence(params);
 			// Perform all of the necessary stuff to execute the model - along with all of the constexpr values stored globally inside the class LOL!.
 			// Because we only pay the "virtual overhead @ the top here == totally negligible.
 		};
 
+		NIHILUS_FORCE_INLINE void reset_sequence() {
+			prefix_cache_val.release_pages(sequence_pages);
+			sequence_tokens.clear();
+		}
+
+		// Drops tokens [keep_count, keep_count + discard_count) from the active sequence in place; returns the new sequence length.
+		NIHILUS_FORCE_INLINE uint64_t shift_context(uint64_t keep_count, uint64_t discard_count) {
+			static constexpr uint64_t page_size{ prefix_cache<config>::page_size };
+			const uint64_t token_count{ sequence_tokens.size() };
+			if (keep_count >= token_count) {
+				return token_count;
+			}
+			discard_count = std::min(discard_count, token_count - keep_count);
+			if (discard_count == 0) {
+				return token_count;
+			}
+			detach_shared_pages(keep_count / page_size);
+			context_shift<config>::impl(get_core<op_type_type::cache_k>().data, get_core<op_type_type::cache_v>().data, sequence_pages, token_count, keep_count, discard_count,
+				rope_freq_base(), get_core<op_type_type::rope_freqs_weight>().data);
+			sequence_tokens.erase(sequence_tokens.begin() + static_cast<std::ptrdiff_t>(keep_count),
+				sequence_tokens.begin() + static_cast<std::ptrdiff_t>(keep_count + discard_count));
+			const uint64_t required_pages{ (sequence_tokens.size() + page_size - 1) / page_size };
+			while (sequence_pages.size() > required_pages) {
+				prefix_cache_val.release_page(sequence_pages.back());
+				sequence_pages.pop_back();
+			}
+			return sequence_tokens.size();
+		}
+
+		NIHILUS_FORCE_INLINE bool save_sequence_state(const std::filesystem::path& path) {
+			return kv_snapshot<config>::save(path, get_core<op_type_type::cache_k>().data, get_core<op_type_type::cache_v>().data, sequence_tokens, sequence_pages);
+		}
+
+		// Returns the restored token count; execute_model then continues the sequence from that position.
+		NIHILUS_FORCE_INLINE uint64_t load_sequence_state(const std::filesystem::path& path) {
+			memory_mapped_file<config.exceptions> file{ path };
+			const kv_snapshot_header* header{ kv_snapshot<config>::validate(file) };
+			if (!header) {
+				return 0;
+			}
+			reset_sequence();
+			if (!reserve_pages(header->token_count)) {
+				return 0;
+			}
+			kv_snapshot<config>::restore(file, *header, get_core<op_type_type::cache_k>().data, get_core<op_type_type::cache_v>().data, sequence_tokens, sequence_pages);
+			return sequence_tokens.size();
+		}
+
 	  protected:
+		memory_mapped_file<config.exceptions> weight_file{};
+		memory_buffer<config> weight_memory{};
+		uint8_t* repacked_weights{};
+		direct_file_reader<config.exceptions> direct_reader{};
+		uint8_t* direct_weights{};
 		memory_buffer<config> memory{};
+		uint8_t* decode_arena{};
+		prefix_cache<config> prefix_cache_val{};
+		layer_streamer<config> layer_streamer_val{};
+		huge_page_policy page_policy{ huge_page_policy::none };
+		numa_placement numa_policy{ numa_placement::none };
+		startup_warmup warmup_level{ startup_warmup::none };
+		weight_load_schedule<half> weight_schedule{};
+		std::thread weight_loader{};
+		std::atomic<uint64_t> resident_stages{ std::numeric_limits<uint64_t>::max() };
+		// Page table of the active sequence: logical kv page x lives at rows [sequence_pages[x] * page_size, +page_size) of cache_k/cache_v. The cache
+		// views read rows by position, so the table is kept identity mapped (sequence_pages[x] == x); it records which pages the sequence holds.
+		std::vector<uint32_t> sequence_pages{};
+		std::vector<int32_t> sequence_tokens{};
+		// Runtime caps from cli_params; buffers are always sized for the compile-time sequence_traits limits.
+		uint64_t context_length{ sequence_traits<config>::context_length };
+		uint64_t batch_length{ sequence_traits<config>::batch_length };
+
+		template<uint64_t... index> NIHILUS_FORCE_INLINE void bind_decode_graph_impl(std::index_sequence<index...>) {
+			(bind_decode_op<static_cast<op_type_type>(index)>(), ...);
+		}
+
+		template<op_type_type type> NIHILUS_FORCE_INLINE void bind_decode_op() {
+			using decode_core_type = core_traits<decode_config<config>, type>;
+			decode_core_type& core{ *static_cast<decode_core_type*>(this) };
+			if constexpr (decode_plan_type::planned[static_cast<uint64_t>(type)]) {
+				core.data = reinterpret_cast<typename decode_core_type::output_type*>(decode_arena + decode_plan_type::offsets[static_cast<uint64_t>(type)]);
+			} else {
+				core.data = get_core<type>().data;
+			}
+		}
+
+		// Huge pages degrade silently (an empty hugetlb pool, THP switched off), so each arena says what it actually got.
+		NIHILUS_FORCE_INLINE void report_backing(const char* arena, huge_page_policy obtained) const {
+			if (page_policy != huge_page_policy::none) {
+				std::cout << "NIHILUS " << arena << " MEMORY: " << huge_page_policy_names[static_cast<uint64_t>(obtained)] << " (REQUESTED "
+						  << huge_page_policy_names[static_cast<uint64_t>(page_policy)] << ")" << std::endl;
+			}
+		}
+
+		// Everything the constructor and init share: memory, graph binding, sequence limits, weights and warmup. A failed load has already said
+		// why; warming up without weights would only fault pages for a model that cannot run, so it is skipped.
+		NIHILUS_FORCE_INLINE void setup(const cli_params& params) {
+			page_policy = params.huge_pages;
+			numa_policy = params.numa;
+			if (params.memory_report) {
+				memory_report<config>::print(std::cout, params.thread_count);
+			}
+			memory.init(total_required_bytes, page_policy);
+			// Activations are read by every thread, so they are interleaved whatever the weight placement.
+			report_placement("ACTIVATION", memory.place(numa_policy == numa_placement::none ? numa_placement::none : numa_placement::interleave));
+			report_backing("ACTIVATION", memory.backing());
+			map_memory();
+			apply_sequence_limits(params);
+			core_bases_config_type::template impl<execution_planner>(params.thread_count);
+			decode_bases_type::template impl<execution_planner>(params.thread_count);
+			warmup_level = params.warmup;
+			if (params.model_file.empty()) {
+				warmup(false);
+				return;
+			}
+			if (!load_weights(params.model_file, params.weight_mapping)) {
+				std::cerr << "Sorry, but the model's weights could not be loaded from: " << params.model_file << std::endl;
+				return;
+			}
+			warmup(true);
+		}
+
+		NIHILUS_FORCE_INLINE static void report_placement(const char* arena, bool placed) {
+			if (!placed) {
+				std::cerr << "Sorry, but the NIHILUS " << arena << " memory could not be placed across the NUMA nodes!" << std::endl;
+			}
+		}
+
+		// Writes one byte per page of the activation arena (reading would only map the shared zero page) and reads one per page of the weight
+		// mapping, each split across the pool. A streamed mapping is left alone: the streamer decides which of its layers are resident.
+		NIHILUS_FORCE_INLINE void prefault_pages() {
+			static constexpr uint64_t page_size{ 4096 };
+			uint8_t* activations{ memory.data() };
+			const uint64_t activation_pages{ (memory.size() + page_size - 1) / page_size };
+			const uint8_t* mapping{ layer_streamer_val.enabled() ? nullptr : weight_file.data() };
+			const uint64_t mapping_pages{ mapping ? (weight_file.size() + page_size - 1) / page_size : 0 };
+			this->execute_job([&](uint64_t thread_index, uint64_t worker_count) {
+				volatile uint8_t* activation_bytes{ activations };
+				for (uint64_t x = activation_pages * thread_index / worker_count; x < activation_pages * (thread_index + 1) / worker_count; ++x) {
+					activation_bytes[x * page_size] = activation_bytes[x * page_size];
+				}
+				const volatile uint8_t* mapping_bytes{ mapping };
+				uint8_t sink{};
+				for (uint64_t x = mapping_pages * thread_index / worker_count; x < mapping_pages * (thread_index + 1) / worker_count; ++x) {
+					sink ^= mapping_bytes[x * page_size];
+				}
+				static_cast<void>(sink);
+			});
+		}
+
+		// A streamed mapping is never locked: madvise refuses to drop locked pages, which would pin every layer the streamer meant to release.
+		NIHILUS_FORCE_INLINE bool lock_weights() {
+			bool return_value{ true };
+			if (weight_memory.data()) {
+				return_value = weight_memory.lock();
+			}
+			if (weight_file && !layer_streamer_val.enabled()) {
+				return_value = weight_file.lock() && return_value;
+			}
+			if (!return_value) {
+				std::cout << "NIHILUS WARMUP: WEIGHTS NOT FULLY LOCKED (RAISE THE LOCKED-MEMORY LIMIT, E.G. ulimit -l unlimited)" << std::endl;
+			}
+			return return_value;
+		}
+
+		// One throwaway decode token at position zero faults in the decode arena, the kv cache rows it writes and the kernels' code; the sequence
+		// is left empty again, and the prefix cache never sees it.
+		NIHILUS_FORCE_INLINE void run_warmup_token() {
+			const int32_t token{};
+			execution_parameters params{};
+			params.input_tokens	  = &token;
+			params.token_count	  = 1;
+			params.clear_kv_cache = true;
+			execute_model(params);
+			reset_sequence();
+		}
+
+		template<uint64_t... index> NIHILUS_FORCE_INLINE bool place_weights_impl(std::index_sequence<index...>) {
+			return (place_weights<static_cast<op_type_type>(index)>() & ...);
+		}
+
+		// Only weights in weight_memory are placed; the rest are page-cache pages of the mapping, which mbind cannot move.
+		template<op_type_type type> NIHILUS_FORCE_INLINE bool place_weights() {
+			using core_type = core_traits<config, type>;
+			if constexpr (is_weight_op(type)) {
+				static constexpr uint64_t op{ static_cast<uint64_t>(type) };
+				static constexpr uint64_t rows{ core_type::dims[1] * core_type::dims[2] * core_type::dims[3] };
+				static constexpr uint64_t bytes{ weight_layout_plan<config>::repacked(op) ? weight_layout_plan<config>::traits[op].bytes : core_type::total_required_bytes };
+				// Repacked rows are interleaved in groups, so a group is the smallest unit a thread can take.
+				static constexpr uint64_t unit_bytes{ weight_layout_plan<config>::repacked(op) ? weight_repacker<half>::group_bytes(weight_layout_plan<config>::traits[op])
+																							   : core_type::total_required_bytes / rows };
+				const uint8_t* begin{ weight_memory.data() };
+				const uint8_t* end{ begin + weight_memory.size() };
+				auto place = [&](const void* data) {
+					const uint8_t* weight{ static_cast<const uint8_t*>(data) };
+					return !begin || weight < begin || weight >= end || numa_topology::get().place(weight, bytes, numa_policy, unit_bytes, this->thread_count);
+				};
+				bool return_value{ true };
+				if constexpr (core_type::alc_type == alloc_type::per_block_alloc) {
+					for (uint64_t x = 0; x < model_traits_type::block_count; ++x) {
+						return_value = place(get_core<type>().data[x]) && return_value;
+					}
+				} else {
+					return_value = place(get_core<type>().data);
+				}
+				return return_value;
+			} else {
+				return true;
+			}
+		}
+
+		template<uint64_t... index> NIHILUS_FORCE_INLINE void record_layer_spans_impl(std::index_sequence<index...>) {
+			(record_layer_spans<static_cast<op_type_type>(index)>(), ...);
+		}
+
+		// Only per-block weights that point into the mapping are streamed; anything in weight_memory would be lost to dont_need.
+		template<op_type_type type> NIHILUS_FORCE_INLINE void record_layer_spans() {
+			using core_type = core_traits<config, type>;
+			if constexpr (is_weight_op(type) && core_type::alc_type == alloc_type::per_block_alloc) {
+				const uintptr_t mapping_begin{ reinterpret_cast<uintptr_t>(weight_file.data()) };
+				for (uint64_t x = 0; x < model_traits_type::block_count; ++x) {
+					const uintptr_t weight{ reinterpret_cast<uintptr_t>(get_core<type>().data[x]) };
+					if (weight >= mapping_begin && weight + core_type::total_required_bytes <= mapping_begin + weight_file.size()) {
+						layer_streamer_val.record(x, weight - mapping_begin, core_type::total_required_bytes);
+					}
+				}
+			}
+		}
+
+		template<uint64_t... index> NIHILUS_FORCE_INLINE bool bind_weight_impl(uint64_t op, uint64_t layer, const uint8_t* data, uint64_t size, std::index_sequence<index...>) {
+			return ((op == index && bind_weight_op<static_cast<op_type_type>(index)>(layer, data, size)) || ...);
+		}
+
+		// The mapping is read-only; kernels only ever read weights, so dropping const here is safe.
+		template<op_type_type type> NIHILUS_FORCE_INLINE bool bind_weight_op(uint64_t layer, const uint8_t* data, uint64_t size) {
+			if constexpr (is_weight_op(type)) {
+				using core_type	  = core_traits<config, type>;
+				using output_type = typename core_type::output_type;
+				if (size < type_traits<output_type>::total_byte_size(core_type::dims)) {
+					return false;
+				}
+				output_type* weight{ reinterpret_cast<output_type*>(const_cast<uint8_t*>(data)) };
+				if constexpr (core_type::alc_type == alloc_type::per_block_alloc) {
+					if (layer >= model_traits_type::block_count) {
+						return false;
+					}
+					get_core<type>().data[layer] = weight;
+				} else {
+					get_core<type>().data = weight;
+				}
+				return true;
+			} else {
+				return false;
+			}
+		}
+
+		NIHILUS_FORCE_INLINE void apply_sequence_limits(const cli_params& params) {
+			context_length = params.context_length > 0 ? std::min(params.context_length, sequence_traits<config>::context_length) : sequence_traits<config>::context_length;
+			batch_length   = params.batch_size > 0 ? std::min(params.batch_size, sequence_traits<config>::batch_length) : sequence_traits<config>::batch_length;
+			batch_length   = std::min(batch_length, context_length);
+		}
+
+		// The active sequence is tracked whether or not use_cache is set, so shifting and save_sequence_state always see it. With use_cache, a fresh
+		// sequence skips prefill for the longest cached prefix (always leaving one token to produce logits). At the context limit, shifts out the
+		// oldest tokens after context_keep_count instead of starting over; then reserves pages for the new rows. A pass that still cannot fit, because
+		// the prompt is longer than context_length - context_keep_count or the shift failed, is rejected rather than truncated.
+		NIHILUS_FORCE_INLINE bool prepare_sequence(execution_parameters& params) {
+			if (params.use_cache && sequence_tokens.empty() && params.token_count > 1) {
+				const uint64_t matched{ prefix_cache_val.match(params.input_tokens, params.token_count - 1, sequence_pages) };
+				sequence_tokens.insert(sequence_tokens.end(), params.input_tokens, params.input_tokens + matched);
+				params.input_tokens += matched;
+				params.token_count -= matched;
+			}
+			if (sequence_tokens.size() + params.token_count > context_length) {
+				const uint64_t keep_count{ std::min(static_cast<uint64_t>(params.context_keep_count), static_cast<uint64_t>(sequence_tokens.size())) };
+				const uint64_t overflow{ sequence_tokens.size() + params.token_count - context_length };
+				shift_context(keep_count, std::max(overflow, (sequence_tokens.size() - keep_count) / 2));
+			}
+			if (sequence_tokens.size() + params.token_count > context_length) {
+				if constexpr (config.exceptions) {
+					throw std::runtime_error{ "Sorry, but the prompt does not fit in the context window!" };
+				} else {
+					std::cerr << "Sorry, but the prompt does not fit in the context window! (" << params.token_count << " tokens after " << sequence_tokens.size()
+							  << " kept, context length " << context_length << ")" << std::endl;
+					return false;
+				}
+			}
+			params.position_offset	= sequence_tokens.size();
+			params.kv_cache_seq_len = sequence_tokens.size();
+			return reserve_pages(sequence_tokens.size() + params.token_count);
+		}
+
+		// Copies a pass's tokens and absolute positions into a graph's input rows; rows past row_count, the tail of a short last chunk, are zeroed
+		// and already masked out of attention.
+		template<model_config graph_config> NIHILUS_FORCE_INLINE void load_inputs(const int32_t* tokens, uint64_t position, uint64_t row_count) {
+			using tokens_type	 = core_traits<graph_config, op_type_type::inp_tokens>;
+			using positions_type = core_traits<graph_config, op_type_type::inp_pos>;
+			static constexpr uint64_t row_capacity{ tokens_type::dims[0] };
+			typename tokens_type::output_type* token_rows{ static_cast<tokens_type*>(this)->data };
+			typename positions_type::output_type* position_rows{ static_cast<positions_type*>(this)->data };
+			for (uint64_t x = 0; x < row_capacity; ++x) {
+				token_rows[x]	 = static_cast<typename tokens_type::output_type>(x < row_count ? tokens[x] : 0);
+				position_rows[x] = static_cast<typename positions_type::output_type>(x < row_count ? position + x : 0);
+			}
+		}
+
+		NIHILUS_FORCE_INLINE int32_t run_decode_pass(const int32_t* token, uint64_t position) {
+			auto& decode_kq_soft_max{ *static_cast<core_traits<decode_config<config>, op_type_type::kq_soft_max>*>(this) };
+			decode_kq_soft_max.mask.row_stride		= 1;
+			decode_kq_soft_max.mask.query_count		= 1;
+			decode_kq_soft_max.mask.position_offset = position;
+			load_inputs<decode_config<config>>(token, position, 1);
+			decode_bases_type::template impl<execution_planner>(this->thread_count);
+			this->execute_tasks(true);
+			return pick_token<decode_config<config>>(0);
+		}
+
+		// Greedy pick over one row of a graph's logits; temperature, top_k and top_p are not applied yet.
+		template<model_config graph_config> NIHILUS_FORCE_INLINE int32_t pick_token(uint64_t row) {
+			using logits_type = core_traits<graph_config, op_type_type::result_output>;
+			const typename logits_type::output_type* logits{ static_cast<logits_type*>(this)->data + row * logits_type::dims[0] };
+			return static_cast<int32_t>(std::max_element(logits, logits + logits_type::dims[0]) - logits);
+		}
+
+		// The gguf's <arch>.rope.freq_base when load_weights found one, otherwise the model traits' default for the generation.
+		NIHILUS_FORCE_INLINE float rope_freq_base() const {
+			return this->rope_freqs > 0.0 ? static_cast<float>(this->rope_freqs) : model_traits_type::rope_freq_base;
+		}
+
+		// Pages still referenced by the prefix cache must not be rewritten, and with identity-mapped pages there is nowhere else to move them, so the
+		// cache gives up the suffix that starts at the first shared page the shift touches.
+		NIHILUS_FORCE_INLINE void detach_shared_pages(uint64_t first_page) {
+			for (uint64_t x = first_page; x < sequence_pages.size(); ++x) {
+				if (prefix_cache_val.is_shared(sequence_pages[x])) {
+					prefix_cache_val.evict_from(sequence_pages[x]);
+					return;
+				}
+			}
+		}
+
+		NIHILUS_FORCE_INLINE bool reserve_pages(uint64_t token_count) {
+			static constexpr uint64_t page_size{ prefix_cache<config>::page_size };
+			const uint64_t required_pages{ (token_count + page_size - 1) / page_size };
+			while (sequence_pages.size() < required_pages) {
+				const uint32_t page{ static_cast<uint32_t>(sequence_pages.size()) };
+				if (!prefix_cache_val.acquire_page(page)) {
+					if constexpr (config.exceptions) {
+						throw std::runtime_error{ "Sorry, but the kv cache has no free pages left!" };
+					} else {
+						std::cerr << "Sorry, but the kv cache has no free pages left!" << std::endl;
+						return false;
+					}
+				}
+				sequence_pages.emplace_back(page);
+			}
+			return true;
+		}
+
+		// Reports where the sequence now ends, prompt and fed-back samples included; only use_cache offers its full pages to later requests.
+		NIHILUS_FORCE_INLINE void publish_sequence(execution_parameters& params) {
+			params.position_offset	= sequence_tokens.size();
+			params.kv_cache_seq_len = sequence_tokens.size();
+			if (params.use_cache) {
+				prefix_cache_val.insert(sequence_tokens.data(), sequence_tokens.size(), sequence_pages);
+			}
+		}
 	};
 
 }
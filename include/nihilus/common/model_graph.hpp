@@ -20,6 +20,8 @@ RealTimeChris (Chris M.)
 
 #pragma once
 
+#include <nihilus/common/memory_mapped_file.hpp>
+#include <nihilus/common/gguf_metadata.hpp>
 #include <nihilus/common/memory_buffer.hpp>
 #include <nihilus/common/core_base.hpp>
 #include <nihilus/common/common.hpp>
@@ -29,14 +31,15 @@ namespace nihilus {
 
 	template<model_arch arch> struct tokenizer_parameters;
 
+	// Views into the model file's mapping; valid while the model_graph that owns it is alive.
 	template<> struct tokenizer_parameters<model_arch::llama> {
-		std::vector<int64_t> token_types{};
-		std::vector<std::string> tokens{};
-		std::vector<std::string> merges{};
-		std::string chat_template{};
+		gguf_array_t token_types{};
+		gguf_array_t tokens{};
+		gguf_array_t merges{};
+		gguf_string_t chat_template{};
 		uint64_t bos_token_id{};
 		uint64_t eos_token_id{};
-		std::string pre{};
+		gguf_string_t pre{};
 	};
 
 	template<model_arch arch> struct construction_parameters;
@@ -73,7 +76,7 @@ namespace nihilus {
 		tokenizer_parameters<config.arch> tokenizer_params{};
 		construction_parameters<config.arch> cparams{};
 		hyper_parameters<config.arch> hparams{};
-		memory_buffer<config> leaf_core_data{};
+		memory_mapped_file<config.exceptions> weight_file{};
 	};
 
 }
\ No newline at end of file
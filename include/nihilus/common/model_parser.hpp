@@ -21,9 +21,13 @@ RealTimeChris (Chris M.)
 #pragma once
 
 #include <nihilus/common/type_traits.hpp>
+#include <nihilus/common/direct_file_reader.hpp>
+#include <nihilus/common/weight_repacker.hpp>
+#include <nihilus/common/memory_planner.hpp>
 #include <nihilus/common/model_graph.hpp>
 #include <nihilus/common/debugging_io.hpp>
 #include <nihilus/common/core_base.hpp>
+#include <nihilus/common/array.hpp>
 #include <unordered_set>
 #include <variant>
 #include <regex>
@@ -32,591 +36,155 @@ RealTimeChris (Chris M.)
 
 namespace nihilus {
 
-	enum class gguf_metadata_value_type : uint32_t {
-		GGUF_METADATA_VALUE_TYPE_UINT8	 = 0,
-		GGUF_METADATA_VALUE_TYPE_INT8	 = 1,
-		GGUF_METADATA_VALUE_TYPE_UINT16	 = 2,
-		GGUF_METADATA_VALUE_TYPE_INT16	 = 3,
-		GGUF_METADATA_VALUE_TYPE_UINT32	 = 4,
-		GGUF_METADATA_VALUE_TYPE_INT32	 = 5,
-		GGUF_METADATA_VALUE_TYPE_FLOAT32 = 6,
-		GGUF_METADATA_VALUE_TYPE_BOOL	 = 7,
-		GGUF_METADATA_VALUE_TYPE_STRING	 = 8,
-		GGUF_METADATA_VALUE_TYPE_ARRAY	 = 9,
-		GGUF_METADATA_VALUE_TYPE_UINT64	 = 10,
-		GGUF_METADATA_VALUE_TYPE_INT64	 = 11,
-		GGUF_METADATA_VALUE_TYPE_FLOAT64 = 12,
-		GGUF_METADATA_VALUE_TYPE_UNSET	 = 13,
-	};
-
-	struct string_iterator {
-		const char* first_index{};
-		uint64_t current_index{};
-		uint64_t length{};
-
-		template<typename value_type> NIHILUS_FORCE_INLINE bool operator()(uint64_t size = 0) {
-			return (current_index + sizeof(value_type) + size) < length;
-		}
-	};
-
-	template<typename value_type, auto...> struct value_reader {
-		NIHILUS_FORCE_INLINE static gguf_metadata_value_type gather_value(string_iterator& input) {
-			gguf_metadata_value_type value{};
-			if (input.template operator()<value_type>()) {
-				std::memcpy(&value, input.first_index + input.current_index, sizeof(value));
-				input.current_index += sizeof(value);
-			} else {
-				throw std::runtime_error{ "Sorry, but that index is out of range!" };
-			}
-			if (static_cast<uint64_t>(value) >= 13) {
-				throw std::runtime_error{ "Sorry, but that type is out of range!" };
-			}
-			return value;
-		}
-	};
-
-	template<> struct value_reader<uint8_t> {
-		NIHILUS_FORCE_INLINE static uint8_t gather_value(string_iterator& input) {
-			uint8_t value{};
-			if (input.template operator()<uint8_t>()) {
-				std::memcpy(&value, input.first_index + input.current_index, sizeof(value));
-				input.current_index += sizeof(value);
-			} else {
-				throw std::runtime_error{ "Sorry, but that index is out of range!" };
-			}
-			return value;
-		}
-	};
-
-	template<> struct value_reader<uint16_t> {
-		NIHILUS_FORCE_INLINE static uint16_t gather_value(string_iterator& input) {
-			uint16_t value{};
-			if (input.template operator()<uint16_t>()) {
-				std::memcpy(&value, input.first_index + input.current_index, sizeof(value));
-				input.current_index += sizeof(value);
-			} else {
-				throw std::runtime_error{ "Sorry, but that index is out of range!" };
-			}
-			return value;
-		}
-	};
-
-	template<> struct value_reader<uint32_t> {
-		NIHILUS_FORCE_INLINE static uint32_t gather_value(string_iterator& input) {
-			uint32_t value{};
-			if (input.template operator()<uint32_t>()) {
-				std::memcpy(&value, input.first_index + input.current_index, sizeof(value));
-				input.current_index += sizeof(value);
-			} else {
-				throw std::runtime_error{ "Sorry, but that index is out of range!" };
-			}
-			return value;
-		}
-	};
-
-	template<> struct value_reader<uint64_t> {
-		NIHILUS_FORCE_INLINE static uint64_t gather_value(string_iterator& input) {
-			uint64_t value{};
-			if (input.template operator()<uint64_t>()) {
-				std::memcpy(&value, input.first_index + input.current_index, sizeof(value));
-				input.current_index += sizeof(value);
-			} else {
-				throw std::runtime_error{ "Sorry, but that index is out of range!" };
-			}
-			return value;
-		}
-	};
-
-	template<> struct value_reader<int8_t> {
-		NIHILUS_FORCE_INLINE static int8_t gather_value(string_iterator& input) {
-			int8_t value{};
-			if (input.template operator()<int8_t>()) {
-				std::memcpy(&value, input.first_index + input.current_index, sizeof(value));
-				input.current_index += sizeof(value);
-			} else {
-				throw std::runtime_error{ "Sorry, but that index is out of range!" };
-			}
-			return value;
-		}
-	};
+	template<> struct value_reader<construction_parameters<model_arch::llama>, model_arch::llama> {
+		NIHILUS_FORCE_INLINE static construction_parameters<model_arch::llama> gather_value(const gguf_metadata_t& metadata_kv) {
+			construction_parameters<model_arch::llama> value{};
+			gguf_string_t architecture{};
+			gather_scalar("general.architecture", architecture, metadata_kv);
+			gather_scalar(architecture, ".rope.dimension_count", value.rope_dimension_count, metadata_kv);
+			gather_scalar(architecture, ".feed_forward_length", value.feed_forward_length, metadata_kv);
+			gather_scalar(architecture, ".embedding_length", value.embedding_length, metadata_kv);
+			gather_scalar(architecture, ".context_length", value.context_length, metadata_kv);
+			gather_scalar(architecture, ".attention.head_count_kv", value.head_count_kv, metadata_kv);
+			gather_scalar(architecture, ".block_count", value.block_count, metadata_kv);
+			gather_scalar(architecture, ".attention.head_count", value.head_count, metadata_kv);
+			gather_scalar(architecture, ".vocab_size", value.vocab_size, metadata_kv);
+			gather_scalar(architecture, ".rope.type", value.rope_type, metadata_kv);
+			gather_scalar(architecture, ".expert_count", value.n_expert, metadata_kv);
+			gather_scalar(architecture, ".expert_used_count", value.n_expert_used, metadata_kv);
+			gather_scalar(architecture, ".rope.freq_base", value.rope_freq_base, metadata_kv);
+			gather_scalar(architecture, ".rope.scaling.factor", value.rope_freq_scale, metadata_kv);
+			gather_scalar(architecture, ".rope.scaling.attn_factor", value.rope_attn_factor, metadata_kv);
+			gather_scalar(architecture, ".rope.scaling.beta_fast", value.rope_beta_fast, metadata_kv);
+			gather_scalar(architecture, ".rope.scaling.beta_slow", value.rope_beta_slow, metadata_kv);
+			gather_scalar(architecture, ".attention.layer_norm_rms_epsilon", value.rms_norm_epsilon, metadata_kv);
+			gather_scalar(architecture, ".attention.scale", value.f_attention_scale, metadata_kv);
+			gather_scalar(architecture, ".rope.scaling.ext_factor", value.rope_ext_factor, metadata_kv);
 
-	template<> struct value_reader<int16_t> {
-		NIHILUS_FORCE_INLINE static int16_t gather_value(string_iterator& input) {
-			int16_t value{};
-			if (input.template operator()<int16_t>()) {
-				std::memcpy(&value, input.first_index + input.current_index, sizeof(value));
-				input.current_index += sizeof(value);
-			} else {
-				throw std::runtime_error{ "Sorry, but that index is out of range!" };
-			}
 			return value;
 		}
 	};
 
-	template<> struct value_reader<int32_t> {
-		NIHILUS_FORCE_INLINE static int32_t gather_value(string_iterator& input) {
-			int32_t value{};
-			if (input.template operator()<int32_t>()) {
-				std::memcpy(&value, input.first_index + input.current_index, sizeof(value));
-				input.current_index += sizeof(value);
-			} else {
-				throw std::runtime_error{ "Sorry, but that index is out of range!" };
-			}
-			return value;
-		}
-	};
+	template<> struct value_reader<tokenizer_parameters<model_arch::llama>, model_arch::llama> {
+		NIHILUS_FORCE_INLINE static tokenizer_parameters<model_arch::llama> gather_value(const gguf_metadata_t& metadata_kv) {
+			tokenizer_parameters<model_arch::llama> value{};
 
-	template<> struct value_reader<int64_t> {
-		NIHILUS_FORCE_INLINE static int64_t gather_value(string_iterator& input) {
-			int64_t value{};
-			if (input.template operator()<int64_t>()) {
-				std::memcpy(&value, input.first_index + input.current_index, sizeof(value));
-				input.current_index += sizeof(value);
-			} else {
-				throw std::runtime_error{ "Sorry, but that index is out of range!" };
-			}
+			gather_scalar("tokenizer.ggml.bos_token_id", value.bos_token_id, metadata_kv);
+			gather_scalar("tokenizer.ggml.eos_token_id", value.eos_token_id, metadata_kv);
+			gather_scalar("tokenizer.chat_template", value.chat_template, metadata_kv);
+			gather_scalar("tokenizer.ggml.merges", value.merges, metadata_kv);
+			gather_scalar("tokenizer.ggml.pre", value.pre, metadata_kv);
+			gather_scalar("tokenizer.ggml.tokens", value.tokens, metadata_kv);
+			gather_scalar("tokenizer.ggml.token_type", value.token_types, metadata_kv);
 			return value;
 		}
 	};
 
-	template<> struct value_reader<bool> {
-		NIHILUS_FORCE_INLINE static bool gather_value(string_iterator& input) {
-			bool value{};
-			if (input.template operator()<bool>()) {
-				std::memcpy(&value, input.first_index + input.current_index, sizeof(value));
-				input.current_index += sizeof(value);
-			} else {
-				throw std::runtime_error{ "Sorry, but that index is out of range!" };
-			}
-			return value;
-		}
+	struct gguf_tensor_info_t {
+		array<uint64_t, 8> dimensions{};
+		uint32_t n_dimensions{};
+		gguf_string_t name{};
+		uint64_t offset{};
+		data_type type{};
 	};
 
-	template<> struct value_reader<float> {
-		NIHILUS_FORCE_INLINE static float gather_value(string_iterator& input) {
-			float value{};
-			if (input.template operator()<float>()) {
-				std::memcpy(&value, input.first_index + input.current_index, sizeof(value));
-				input.current_index += sizeof(value);
-			} else {
-				throw std::runtime_error{ "Sorry, but that index is out of range!" };
-			}
-			return value;
-		}
+	struct tensor_name_entry {
+		uint64_t op{};
+		uint64_t layer{};
 	};
 
-	template<> struct value_reader<double> {
-		NIHILUS_FORCE_INLINE static double gather_value(string_iterator& input) {
-			double value{};
-			if (input.template operator()<double>()) {
-				std::memcpy(&value, input.first_index + input.current_index, sizeof(value));
-				input.current_index += sizeof(value);
+	NIHILUS_FORCE_INLINE constexpr uint64_t parse_number(std::string_view str) noexcept {
+		uint64_t result = 0;
+		for (char c: str) {
+			if (c >= '0' && c <= '9') {
+				result = result * 10 + (c - '0');
 			} else {
-				throw std::runtime_error{ "Sorry, but that index is out of range!" };
-			}
-			return value;
-		}
-	};
-
-	using gguf_string_t = std::string;
-
-	struct gguf_array_t;
-
-	using gguf_metadata_value_variant = std::variant<float, uint64_t, int64_t, double, bool, gguf_string_t, gguf_array_t*>;
-
-	struct gguf_metadata_value_t {
-		gguf_metadata_value_t() noexcept = default;
-		gguf_metadata_value_t& operator=(const gguf_metadata_value_t& other) noexcept;
-		gguf_metadata_value_t(const gguf_metadata_value_t& other) noexcept {
-			*this = other;
-		};
-		gguf_metadata_value_t(const gguf_metadata_value_variant& other) noexcept;
-		gguf_metadata_value_variant value{};
-		~gguf_metadata_value_t();
-	};
-
-	struct gguf_array_t {
-		std::vector<gguf_metadata_value_t> array{};
-		gguf_metadata_value_type type{};
-	};
-
-	gguf_metadata_value_t::~gguf_metadata_value_t() {
-		if (std::holds_alternative<gguf_array_t*>(value)) {
-			if (std::get<gguf_array_t*>(value)) {
-				delete std::get<gguf_array_t*>(value);
+				break;
 			}
 		}
+		return result;
 	}
 
-	gguf_metadata_value_t& gguf_metadata_value_t::operator=(const gguf_metadata_value_t& other) noexcept {
-		if (std::holds_alternative<float>(other.value)) {
-			value.emplace<float>(std::get<float>(other.value));
-		} else if (std::holds_alternative<uint64_t>(other.value)) {
-			value.emplace<uint64_t>(std::get<uint64_t>(other.value));
-		} else if (std::holds_alternative<int64_t>(other.value)) {
-			value.emplace<int64_t>(std::get<int64_t>(other.value));
-		} else if (std::holds_alternative<double>(other.value)) {
-			value.emplace<double>(std::get<double>(other.value));
-		} else if (std::holds_alternative<bool>(other.value)) {
-			value.emplace<bool>(std::get<bool>(other.value));
-		} else if (std::holds_alternative<gguf_string_t>(other.value)) {
-			value.emplace<gguf_string_t>(std::get<gguf_string_t>(other.value));
-		} else if (std::holds_alternative<gguf_array_t*>(other.value)) {
-			if (std::holds_alternative<gguf_array_t*>(value)) {
-				if (std::get<gguf_array_t*>(value)) {
-					delete std::get<gguf_array_t*>(value);
-				}
-			}
-			value.emplace<gguf_array_t*>(new gguf_array_t{ *std::get<gguf_array_t*>(other.value) });
-		}
-		return *this;
-	};
-
-	gguf_metadata_value_t::gguf_metadata_value_t(const gguf_metadata_value_variant& other) noexcept {
-		if (std::holds_alternative<float>(other)) {
-			value.emplace<float>(std::get<float>(other));
-		} else if (std::holds_alternative<uint64_t>(other)) {
-			value.emplace<uint64_t>(std::get<uint64_t>(other));
-		} else if (std::holds_alternative<int64_t>(other)) {
-			value.emplace<int64_t>(std::get<int64_t>(other));
-		} else if (std::holds_alternative<double>(other)) {
-			value.emplace<double>(std::get<double>(other));
-		} else if (std::holds_alternative<bool>(other)) {
-			value.emplace<bool>(std::get<bool>(other));
-		} else if (std::holds_alternative<gguf_string_t>(other)) {
-			value.emplace<gguf_string_t>(std::get<gguf_string_t>(other));
-		} else if (std::holds_alternative<gguf_array_t*>(other)) {
-			value.emplace<gguf_array_t*>(new gguf_array_t{ *std::get<gguf_array_t*>(other) });
-		}
-	};
-
-	template<> struct value_reader<gguf_string_t> {
-		NIHILUS_FORCE_INLINE static gguf_string_t gather_value(string_iterator& input) {
-			uint64_t length{ value_reader<uint64_t>::gather_value(input) };
-			constexpr uint64_t MAX_STRING_LENGTH = 1024 * 1024 * 100;
-			if (length > MAX_STRING_LENGTH) {
-				throw std::runtime_error{ "String length exceeds maximum allowed size!" };
-			}
-			if (length == 0) {
-				return gguf_string_t{};
-			}
-			gguf_string_t value{};
-			value.resize(length);
-			if (input.current_index + length < input.length) {
-				std::memcpy(value.data(), input.first_index + input.current_index, length);
-				input.current_index += length;
-			} else {
-				throw std::runtime_error{ "Sorry, but that index is out of range!" };
-			}
-			return value;
-		}
-	};
-
-	template<> struct value_reader<gguf_array_t> {
-		NIHILUS_FORCE_INLINE static gguf_array_t gather_value(string_iterator& input);
-	};
-
-	template<> struct value_reader<gguf_metadata_value_variant> {
-		NIHILUS_INLINE static gguf_metadata_value_variant gather_value(string_iterator& input, gguf_metadata_value_type type) {
-			gguf_metadata_value_variant value{};
-			switch (type) {
-				case gguf_metadata_value_type::GGUF_METADATA_VALUE_TYPE_INT8: {
-					value.emplace<int64_t>(value_reader<int8_t>::gather_value(input));
-					break;
-				}
-				case gguf_metadata_value_type::GGUF_METADATA_VALUE_TYPE_INT16: {
-					value.emplace<int64_t>(value_reader<int16_t>::gather_value(input));
-					break;
-				}
-				case gguf_metadata_value_type::GGUF_METADATA_VALUE_TYPE_INT32: {
-					value.emplace<int64_t>(value_reader<int32_t>::gather_value(input));
-					break;
-				}
-				case gguf_metadata_value_type::GGUF_METADATA_VALUE_TYPE_INT64: {
-					value.emplace<int64_t>(value_reader<int64_t>::gather_value(input));
-					break;
-				}
-				case gguf_metadata_value_type::GGUF_METADATA_VALUE_TYPE_UINT8: {
-					value.emplace<uint64_t>(value_reader<uint8_t>::gather_value(input));
-					break;
-				}
-				case gguf_metadata_value_type::GGUF_METADATA_VALUE_TYPE_UINT16: {
-					value.emplace<uint64_t>(value_reader<uint16_t>::gather_value(input));
-					break;
-				}
-				case gguf_metadata_value_type::GGUF_METADATA_VALUE_TYPE_UINT32: {
-					value.emplace<uint64_t>(value_reader<uint32_t>::gather_value(input));
-					break;
-				}
-				case gguf_metadata_value_type::GGUF_METADATA_VALUE_TYPE_UINT64: {
-					value.emplace<uint64_t>(value_reader<uint64_t>::gather_value(input));
-					break;
-				}
-				case gguf_metadata_value_type::GGUF_METADATA_VALUE_TYPE_BOOL: {
-					value.emplace<bool>(value_reader<bool>::gather_value(input));
-					break;
-				}
-				case gguf_metadata_value_type::GGUF_METADATA_VALUE_TYPE_FLOAT32: {
-					value.emplace<float>(value_reader<float>::gather_value(input));
-					break;
-				}
-				case gguf_metadata_value_type::GGUF_METADATA_VALUE_TYPE_FLOAT64: {
-					value.emplace<double>(value_reader<double>::gather_value(input));
-					break;
-				}
-				case gguf_metadata_value_type::GGUF_METADATA_VALUE_TYPE_STRING: {
-					value.emplace<gguf_string_t>(value_reader<gguf_string_t>::gather_value(input));
-					break;
-				}
-				case gguf_metadata_value_type::GGUF_METADATA_VALUE_TYPE_ARRAY: {
-					value.emplace<gguf_array_t*>(new gguf_array_t{ value_reader<gguf_array_t>::gather_value(input) });
-					break;
-				}
-				case gguf_metadata_value_type::GGUF_METADATA_VALUE_TYPE_UNSET: {
-					break;
-				}
-			}
-			return value;
-		}
+	struct tensor_name_key {
+		std::string_view name{};
+		llama_op_types op{};
 	};
 
-	gguf_array_t value_reader<gguf_array_t>::gather_value(string_iterator& input) {
-		gguf_metadata_value_type type{ value_reader<gguf_metadata_value_type>::gather_value(input) };
-		uint64_t length{ value_reader<uint64_t>::gather_value(input) };
-		constexpr uint64_t MAX_ARRAY_LENGTH = 1024 * 1024;
-		if (length > MAX_ARRAY_LENGTH) {
-			throw std::runtime_error{ "Array length exceeds maximum allowed size!" };
-		}
-		gguf_array_t value{};
-		value.type = type;
-		value.array.reserve(length);
-		for (uint64_t x = 0; x < length; ++x) {
-			value.array.emplace_back(value_reader<gguf_metadata_value_variant>::gather_value(input, type));
+	template<uint64_t table_size> NIHILUS_FORCE_INLINE constexpr uint64_t tensor_name_hash(std::string_view name, uint64_t seed) noexcept {
+		uint64_t value{ 14695981039346656037ULL ^ seed };
+		for (char c: name) {
+			value = (value ^ static_cast<uint8_t>(c)) * 1099511628211ULL;
 		}
-		return value;
+		return (value >> 32) & (table_size - 1);
 	}
 
-	struct gguf_metadata_kv_t;
-
-	struct gguf_metadata_kv_t {
-		gguf_metadata_value_type value_type{};
-
-		gguf_metadata_value_t value{};
-
-		NIHILUS_FORCE_INLINE operator bool() const {
-			return std::get<bool>(value.value);
-		}
-
-		NIHILUS_FORCE_INLINE operator int64_t() const {
-			return std::get<int64_t>(value.value);
-		}
-
-		NIHILUS_FORCE_INLINE operator uint64_t() const {
-			return std::get<uint64_t>(value.value);
-		}
-
-		NIHILUS_FORCE_INLINE operator gguf_string_t() const {
-			return std::get<gguf_string_t>(value.value);
-		}
-
-		NIHILUS_FORCE_INLINE operator gguf_array_t() const {
-			return *std::get<gguf_array_t*>(value.value);
-		}
-
-		NIHILUS_FORCE_INLINE operator float() const {
-			return std::get<float>(value.value);
-		}
-
-		NIHILUS_FORCE_INLINE operator double() const {
-			return std::get<double>(value.value);
-		}
-	};
-
-	template<> struct value_reader<gguf_metadata_kv_t> {
-		NIHILUS_FORCE_INLINE static gguf_metadata_kv_t gather_value(string_iterator& input) {
-			gguf_metadata_kv_t value{};
-			value.value_type  = value_reader<gguf_metadata_value_type>::gather_value(input);
-			value.value.value = value_reader<gguf_metadata_value_variant>::gather_value(input, value.value_type);
-			return value;
-		}
-	};
-
-	struct gguf_header_t {
-		std::map<std::string, gguf_metadata_kv_t> metadata_kv{};
-		uint64_t metadata_kv_count{};
-		uint64_t tensor_count{};
-		uint32_t version{};
-		uint32_t magic{};
-	};
-
-	template<typename value_type> NIHILUS_FORCE_INLINE void gather_scalar(const std::string& key, value_type& out, const std::map<std::string, gguf_metadata_kv_t>& metadata_kv) {
-		auto it = metadata_kv.find(key);
-		if (it == metadata_kv.end())
-			return;
-		const auto& v = it->second.value.value;
-		if (std::holds_alternative<value_type>(v)) {
-			out = std::get<value_type>(v);
-		}
-	};
-
-	template<typename value_type>
-	NIHILUS_FORCE_INLINE void gather_array(const std::string& key, std::vector<value_type>& out, const std::map<std::string, gguf_metadata_kv_t>& metadata_kv) {
-		auto it = metadata_kv.find(key);
-		if (it == metadata_kv.end())
-			return;
-		const auto& v = it->second.value.value;
-		if (std::holds_alternative<gguf_array_t*>(v)) {
-			gguf_array_t& new_array{ *std::get<gguf_array_t*>(v) };
-			for (auto& value: new_array.array) {
-				out.emplace_back(std::get<value_type>(value.value));
+	// Smallest seed under which every key lands in its own slot, or zero if none below the search limit does.
+	template<uint64_t table_size, auto key_count> constexpr uint64_t find_tensor_name_seed(const array<tensor_name_key, key_count>& keys) {
+		for (uint64_t candidate = 1; candidate < 65536; ++candidate) {
+			array<bool, table_size> used{};
+			bool collision{};
+			for (uint64_t x = 0; x < static_cast<uint64_t>(key_count) && !collision; ++x) {
+				const uint64_t slot{ tensor_name_hash<table_size>(keys[x].name, candidate) };
+				collision  = used[slot];
+				used[slot] = true;
 			}
-		}
-	};
-
-	NIHILUS_FORCE_INLINE void print_variant(auto variant) {
-		if (std::holds_alternative<float>(variant)) {
-			std::cout << "Value: " << std::get<float>(variant) << std::endl;
-		} else if (std::holds_alternative<uint64_t>(variant)) {
-			std::cout << "Value: " << std::get<uint64_t>(variant) << std::endl;
-		} else if (std::holds_alternative<int64_t>(variant)) {
-			std::cout << "Value: " << std::get<int64_t>(variant) << std::endl;
-		} else if (std::holds_alternative<double>(variant)) {
-			std::cout << "Value: " << std::get<double>(variant) << std::endl;
-		} else if (std::holds_alternative<bool>(variant)) {
-			std::cout << "Value: " << std::get<bool>(variant) << std::endl;
-		} else if (std::holds_alternative<gguf_string_t>(variant)) {
-			std::cout << "Value: " << std::get<gguf_string_t>(variant) << std::endl;
-		} else if (std::holds_alternative<gguf_array_t*>(variant)) {
-		}
-	}
-
-	template<> struct value_reader<construction_parameters<model_arch::llama>, model_arch::llama> {
-		NIHILUS_FORCE_INLINE static construction_parameters<model_arch::llama> gather_value(const std::map<std::string, gguf_metadata_kv_t>& metadata_kv) {
-			construction_parameters<model_arch::llama> value{};
-			std::string architecture{};
-			if (metadata_kv.contains("general.architecture")) {
-				architecture = metadata_kv.at("general.architecture").operator gguf_string_t();
+			if (!collision) {
+				return candidate;
 			}
-			gather_scalar(architecture + ".rope.dimension_count", value.rope_dimension_count, metadata_kv);
-			gather_scalar(architecture + ".feed_forward_length", value.feed_forward_length, metadata_kv);
-			gather_scalar(architecture + ".embedding_length", value.embedding_length, metadata_kv);
-			gather_scalar(architecture + ".context_length", value.context_length, metadata_kv);
-			gather_scalar(architecture + ".attention.head_count_kv", value.head_count_kv, metadata_kv);
-			gather_scalar(architecture + ".block_count", value.block_count, metadata_kv);
-			gather_scalar(architecture + ".attention.head_count", value.head_count, metadata_kv);
-			gather_scalar(architecture + ".vocab_size", value.vocab_size, metadata_kv);
-			gather_scalar(architecture + ".rope.type", value.rope_type, metadata_kv);
-			gather_scalar(architecture + ".expert_count", value.n_expert, metadata_kv);
-			gather_scalar(architecture + ".expert_used_count", value.n_expert_used, metadata_kv);
-			gather_scalar(architecture + ".rope.freq_base", value.rope_freq_base, metadata_kv);
-			gather_scalar(architecture + ".rope.scaling.factor", value.rope_freq_scale, metadata_kv);
-			gather_scalar(architecture + ".rope.scaling.attn_factor", value.rope_attn_factor, metadata_kv);
-			gather_scalar(architecture + ".rope.scaling.beta_fast", value.rope_beta_fast, metadata_kv);
-			gather_scalar(architecture + ".rope.scaling.beta_slow", value.rope_beta_slow, metadata_kv);
-			gather_scalar(architecture + ".attention.layer_norm_rms_epsilon", value.rms_norm_epsilon, metadata_kv);
-			gather_scalar(architecture + ".attention.scale", value.f_attention_scale, metadata_kv);
-			gather_scalar(architecture + ".rope.scaling.ext_factor", value.rope_ext_factor, metadata_kv);
-
-			return value;
-		}
-	};
-
-	template<> struct value_reader<tokenizer_parameters<model_arch::llama>, model_arch::llama> {
-		NIHILUS_FORCE_INLINE static tokenizer_parameters<model_arch::llama> gather_value(const std::map<std::string, gguf_metadata_kv_t>& metadata_kv) {
-			tokenizer_parameters<model_arch::llama> value{};
-
-			gather_scalar("tokenizer.ggml.bos_token_id", value.bos_token_id, metadata_kv);
-			gather_scalar("tokenizer.ggml.eos_token_id", value.eos_token_id, metadata_kv);
-			gather_scalar("tokenizer.chat_template", value.chat_template, metadata_kv);
-			gather_array("tokenizer.ggml.merges", value.merges, metadata_kv);
-			gather_scalar("tokenizer.ggml.pre", value.pre, metadata_kv);
-			gather_array("tokenizer.ggml.tokens", value.tokens, metadata_kv);
-			gather_array("tokenizer.ggml.token_type", value.token_types, metadata_kv);
-			return value;
 		}
-	};
+		return 0;
+	}
 
-	template<> struct value_reader<gguf_header_t> {
-		NIHILUS_FORCE_INLINE static gguf_header_t gather_value(string_iterator& input) {
-			gguf_header_t value{};
-			value.magic = value_reader<uint32_t>::gather_value(input);
-			if (value.magic != 0x46554747) {
-				throw std::runtime_error{ "Sorry, but that magic value was incorrect!" };
-			}
-			value.version						  = value_reader<uint32_t>::gather_value(input);
-			value.tensor_count					  = value_reader<uint64_t>::gather_value(input);
-			value.metadata_kv_count				  = value_reader<uint64_t>::gather_value(input);
-			constexpr uint64_t MAX_TENSOR_COUNT	  = 100000;
-			constexpr uint64_t MAX_METADATA_COUNT = 10000;
-			if (value.tensor_count > MAX_TENSOR_COUNT) {
-				throw std::runtime_error{ "Tensor count exceeds reasonable maximum!" };
-			}
-			if (value.metadata_kv_count > MAX_METADATA_COUNT) {
-				throw std::runtime_error{ "Metadata count exceeds reasonable maximum!" };
-			}
-			for (uint64_t x = 0; x < value.metadata_kv_count; ++x) {
-				std::string new_string		  = value_reader<gguf_string_t>::gather_value(input);
-				value.metadata_kv[new_string] = value_reader<gguf_metadata_kv_t>::gather_value(input);
+	template<model_arch arch> struct tensor_name_map;
+
+	// Every tensor name reduces to a fixed key once its "blk.N." prefix is stripped. Keys sit in a table indexed by a seeded FNV-1a hash whose seed
+	// is searched at compile time until no two keys collide, so resolving a name is one hash and one compare.
+	template<> struct tensor_name_map<model_arch::llama> {
+		static constexpr array<tensor_name_key, 13> keys{ { { "token_embd.weight", llama_op_types::token_embd_weight },
+			{ "rope_freqs.weight", llama_op_types::rope_freqs_weight }, { "output_norm.weight", llama_op_types::output_norm_weight },
+			{ "output.weight", llama_op_types::output_weight }, { "attn_q.weight", llama_op_types::attn_q_weight }, { "attn_k.weight", llama_op_types::attn_k_weight },
+			{ "attn_v.weight", llama_op_types::attn_v_weight }, { "attn_output.weight", llama_op_types::attn_output_weight },
+			{ "attn_norm.weight", llama_op_types::attn_norm_weight }, { "ffn_gate.weight", llama_op_types::ffn_gate_weight },
+			{ "ffn_up.weight", llama_op_types::ffn_up_weight }, { "ffn_down.weight", llama_op_types::ffn_down_weight },
+			{ "ffn_norm.weight", llama_op_types::ffn_norm_weight } } };
+		static constexpr uint64_t table_size{ 32 };
+		static constexpr uint64_t seed{ find_tensor_name_seed<table_size>(keys) };
+		static_assert(seed != 0, "Sorry, but no collision-free seed exists for these tensor names!");
+
+		// Slot -> key index + 1; zero marks an empty slot.
+		static constexpr array<uint64_t, table_size> slots{ [] {
+			array<uint64_t, table_size> return_value{};
+			for (uint64_t x = 0; x < static_cast<uint64_t>(keys.size()); ++x) {
+				return_value[tensor_name_hash<table_size>(keys[x].name, seed)] = x + 1;
 			}
-			return value;
-		}
-	};
-
-	struct gguf_tensor_info_t {
-		std::vector<uint64_t> dimensions{};
-		uint32_t n_dimensions{};
-		std::string name{};
-		uint64_t offset{};
-		data_type type{};
-	};
-
-	template<model_arch arch> struct string_to_tensor_name;
-
-	template<> struct string_to_tensor_name<model_arch::llama> {
-		NIHILUS_FORCE_INLINE static uint64_t impl(std::string_view input) noexcept {
-			if (input == "token_embd.weight")
-				return static_cast<uint64_t>(llama_op_types::token_embd_weight);
-			if (input == "rope_freqs.weight")
-				return static_cast<uint64_t>(llama_op_types::rope_freqs_weight);
-			if (input == "output_norm.weight")
-				return static_cast<uint64_t>(llama_op_types::output_norm_weight);
-			if (input == "output.weight")
-				return static_cast<uint64_t>(llama_op_types::output_weight);
-
-			if (input.find(".attn_q.weight") != std::string_view::npos)
-				return static_cast<uint64_t>(llama_op_types::attn_q_weight);
-			if (input.find(".attn_norm.weight") != std::string_view::npos)
-				return static_cast<uint64_t>(llama_op_types::attn_norm_weight);
-
-			if (input.starts_with("blk.") && input.ends_with(".weight")) {
-				auto second_dot = input.find('.', 4);
-				if (second_dot != std::string_view::npos) {
-					auto suffix = input.substr(second_dot + 1);
-
-					if (suffix == "attn_q.weight")
-						return static_cast<uint64_t>(llama_op_types::attn_q_weight);
-					if (suffix == "attn_norm.weight")
-						return static_cast<uint64_t>(llama_op_types::attn_norm);
-					if (suffix == "attn_k.weight")
-						return static_cast<uint64_t>(llama_op_types::attn_k_weight);
-					if (suffix == "attn_v.weight")
-						return static_cast<uint64_t>(llama_op_types::attn_v_weight);
-					if (suffix == "ffn_down.weight")
-						return static_cast<uint64_t>(llama_op_types::ffn_down_weight);
-					if (suffix == "ffn_gate.weight")
-						return static_cast<uint64_t>(llama_op_types::ffn_gate_weight);
-					if (suffix == "attn_output.weight")
-						return static_cast<uint64_t>(llama_op_types::attn_output_weight);
-					if (suffix == "ffn_norm.weight")
-						return static_cast<uint64_t>(llama_op_types::ffn_norm_weight);
-					if (suffix == "ffn_up.weight")
-						return static_cast<uint64_t>(llama_op_types::ffn_up_weight);
+			return return_value;
+		}() };
+
+		NIHILUS_FORCE_INLINE static constexpr tensor_name_entry impl(std::string_view name) noexcept {
+			tensor_name_entry return_value{ static_cast<uint64_t>(llama_op_types::count), 0 };
+			if (name.starts_with("blk.")) {
+				const uint64_t layer_end{ name.find('.', 4) };
+				const std::string_view layer{ name.substr(4, layer_end == std::string_view::npos ? 0 : layer_end - 4) };
+				// "blk.x." or "blk.." is not layer 0; it is not a tensor this model knows.
+				if (layer.empty() || layer.find_first_not_of("0123456789") != std::string_view::npos) {
+					return return_value;
 				}
+				return_value.layer = parse_number(layer);
+				name			   = name.substr(layer_end + 1);
 			}
-
-			return static_cast<uint64_t>(llama_op_types::count);
+			const uint64_t slot{ slots[tensor_name_hash<table_size>(name, seed)] };
+			if (slot != 0 && keys[slot - 1].name == name) {
+				return_value.op = static_cast<uint64_t>(keys[slot - 1].op);
+			}
+			return return_value;
 		}
 	};
+	static_assert(tensor_name_map<model_arch::llama>::impl("blk.17.ffn_down.weight").op == static_cast<uint64_t>(llama_op_types::ffn_down_weight));
+	static_assert(tensor_name_map<model_arch::llama>::impl("blk.17.ffn_down.weight").layer == 17);
+	static_assert(tensor_name_map<model_arch::llama>::impl("output.weight").op == static_cast<uint64_t>(llama_op_types::output_weight));
+	static_assert(tensor_name_map<model_arch::llama>::impl("blk.3.ffn_downs.weight").op == static_cast<uint64_t>(llama_op_types::count));
+	static_assert(tensor_name_map<model_arch::llama>::impl("blk.x.ffn_down.weight").op == static_cast<uint64_t>(llama_op_types::count));
+	static_assert(tensor_name_map<model_arch::llama>::impl("blk..ffn_down.weight").op == static_cast<uint64_t>(llama_op_types::count));
 
 	template<> struct value_reader<gguf_tensor_info_t> {
 		NIHILUS_FORCE_INLINE static gguf_tensor_info_t gather_value(string_iterator& input) {
@@ -633,7 +201,7 @@ namespace nihilus {
 				if (dim > MAX_DIM_SIZE) {
 					throw std::runtime_error{ "Tensor dimension size too large!" };
 				}
-				value.dimensions.emplace_back(dim);
+				value.dimensions[x] = dim;
 			}
 			value.type	 = static_cast<data_type>(value_reader<uint32_t>::gather_value(input));
 			value.offset = value_reader<uint64_t>::gather_value(input);
@@ -641,61 +209,53 @@ namespace nihilus {
 		}
 	};
 
-	NIHILUS_FORCE_INLINE bool operator<(const gguf_tensor_info_t& lhs, const gguf_tensor_info_t& rhs) noexcept {
-		const std::string& lhs_name{ lhs.name };
-		const std::string& rhs_name{ rhs.name };
-		if (lhs_name.find_first_of("1234567890") != std::string::npos && rhs_name.find_first_of("1234567890") != std::string::npos) {
-			uint64_t lhs_offset{ lhs_name.find_first_of("1234567890") };
-			uint64_t rhs_offset{ rhs_name.find_first_of("1234567890") };
-			std::string lhs_val_raw{ lhs_name.substr(lhs_offset, lhs_name.find_first_not_of("1234567890", lhs_offset) - lhs_offset + 1) };
-			std::string rhs_val_raw{ rhs_name.substr(rhs_offset, rhs_name.find_first_not_of("1234567890", rhs_offset) - rhs_offset + 1) };
-			auto* lhs_ptr_01 = lhs_val_raw.data();
-			auto* lhs_ptr_02 = lhs_val_raw.data() + lhs_val_raw.size();
-			uint64_t lhs_val{ std::strtoull(lhs_ptr_01, &lhs_ptr_02, 10) };
-			auto* rhs_ptr_01 = rhs_val_raw.data();
-			auto* rhs_ptr_02 = rhs_val_raw.data() + rhs_val_raw.size();
-			uint64_t rhs_val{ std::strtoull(rhs_ptr_01, &rhs_ptr_02, 10) };
-			return lhs_val < rhs_val;
-		} else {
-			return lhs_name < rhs_name;
-		}
-	}
-
-	NIHILUS_FORCE_INLINE void sort_tensor_infos(std::vector<gguf_tensor_info_t>& tensor_infos) noexcept {
-		std::sort(tensor_infos.begin(), tensor_infos.end(), std::less<gguf_tensor_info_t>{});
-	}
+	struct weight_tensor_spec {
+		array<uint64_t, 4> dims{};
+		uint64_t bytes{};
+		data_type type{ data_type::count };
+	};
 
-	NIHILUS_FORCE_INLINE constexpr uint64_t parse_number(std::string_view str) noexcept {
-		uint64_t result = 0;
-		for (char c: str) {
-			if (c >= '0' && c <= '9') {
-				result = result * 10 + (c - '0');
-			} else {
-				break;
+	template<typename base_type_new> struct weight_spec_collector {
+		NIHILUS_FORCE_INLINE weight_spec_collector() noexcept										  = default;
+		NIHILUS_FORCE_INLINE weight_spec_collector& operator=(const weight_spec_collector&) noexcept = delete;
+		NIHILUS_FORCE_INLINE weight_spec_collector(const weight_spec_collector&) noexcept			  = delete;
+		NIHILUS_FORCE_INLINE weight_spec_collector& operator=(weight_spec_collector&&) noexcept	  = delete;
+		NIHILUS_FORCE_INLINE weight_spec_collector(weight_spec_collector&&) noexcept				  = delete;
+		using base_type																			  = base_type_new;
+
+		template<uint64_t size> NIHILUS_FORCE_INLINE constexpr static void impl(array<weight_tensor_spec, size>& values) {
+			if constexpr (is_weight_op(base_type::type)) {
+				using output_type = typename base_type::output_type;
+				values[static_cast<uint64_t>(base_type::type)] =
+					weight_tensor_spec{ base_type::dims, type_traits<output_type>::total_byte_size(base_type::dims), type_traits<output_type>::type };
 			}
 		}
-		return result;
-	}
+	};
 
-	NIHILUS_FORCE_INLINE constexpr uint64_t extract_layer_number(std::string_view name) noexcept {
-		if NIHILUS_LIKELY (name[0] == 'c' && name.starts_with("cache_")) {
-			for (uint64_t i = 7; i < name.size(); ++i) {
-				if (name[i] == 'l' && i + 1 < name.size()) {
-					return parse_number(name.substr(i + 1));
-				}
+	// What core_traits declares for every weight op: a file tensor has to match it exactly before anything is bound to its bytes.
+	template<model_config config> struct weight_tensor_specs {
+		static constexpr uint64_t op_count{ static_cast<uint64_t>(op_type_type_t<config>::count) };
+
+		static constexpr array<weight_tensor_spec, op_count> specs{ [] {
+			array<weight_tensor_spec, op_count> return_value{};
+			get_core_traits_config_base_t<config>::template impl_constexpr<weight_spec_collector>(return_value);
+			return return_value;
+		}() };
+
+		// GGUF lists ne[0] first, as core_traits does; dimensions past the tensor's rank count as 1.
+		NIHILUS_FORCE_INLINE static bool matches(uint64_t op, const gguf_tensor_info_t& info) {
+			if (op >= op_count || info.type != specs[op].type) {
+				return false;
 			}
-			return 0;
-		}
-		if NIHILUS_LIKELY (name[0] == 'b' && name.starts_with("blk.")) {
-			uint64_t start = 4;
-			uint64_t end	 = name.find('.', start);
-			if (end != std::string_view::npos) {
-				return parse_number(name.substr(start, end - start));
+			for (uint64_t x = 0; x < static_cast<uint64_t>(info.dimensions.size()); ++x) {
+				const uint64_t dim{ x < info.n_dimensions ? info.dimensions[x] : 1 };
+				if (dim != (x < static_cast<uint64_t>(specs[op].dims.size()) ? specs[op].dims[x] : 1)) {
+					return false;
+				}
 			}
+			return true;
 		}
-
-		return 0;
-	}
+	};
 
 	struct gguf_file_t {
 		std::vector<gguf_tensor_info_t> tensor_infos{};
@@ -1333,55 +893,133 @@ namespace nihilus {
 			model.cores.shrink_to_fit();
 		}
 
+		// Maps the file, walks the tensor infos in place and points each weight core of model_new at its bytes inside the mapping, or at a copy
+		// rewritten into the layout its mul_mat kernel prefers. Binding is serial and cheap; the repacks, and the page-ins when options.populate is
+		// set or loading in the background, are deferred into one schedule that the model's own thread pool drains before returning, or that a loader
+		// thread works through in execution order while the model already serves (options.background). With a reader other than mmap, the mapping
+		// is only used for the header: each tensor is read with O_DIRECT into its execution-order slot (see weight_memory_layout) and repacked there
+		// in place, by the same thread that runs the schedule.
+		NIHILUS_FORCE_INLINE static bool load_weights(model<config>& model_new, const std::filesystem::path& path, map_options options) {
+			using repacker_type = weight_repacker<half>;
+			static constexpr const auto& repack_traits{ weight_layout_plan<config>::traits };
+			// Pages are faulted in by the pool below rather than by a single-threaded MAP_POPULATE.
+			memory_mapped_file<config.exceptions> file{ path, map_options{ false, options.advice } };
+			if (!file) {
+				return false;
+			}
+			string_iterator ptr{};
+			ptr.first_index = reinterpret_cast<const char*>(file.data());
+			ptr.length		= file.size();
+			gguf_header_t header{ value_reader<gguf_header_t>::gather_value(ptr) };
+			std::vector<gguf_tensor_info_t> tensor_infos{};
+			tensor_infos.reserve(header.tensor_count);
+			for (uint64_t x = 0; x < header.tensor_count; ++x) {
+				tensor_infos.emplace_back(value_reader<gguf_tensor_info_t>::gather_value(ptr));
+			}
+			uint64_t alignment{ 32 };
+			gather_scalar("general.alignment", alignment, header.metadata_kv);
+			const uint64_t tensor_data_start{ align_offset(ptr.current_index, alignment) };
+			gguf_string_t architecture{};
+			float rope_freq_base{};
+			gather_scalar("general.architecture", architecture, header.metadata_kv);
+			gather_scalar(architecture, ".rope.freq_base", rope_freq_base, header.metadata_kv);
+			model_new.rope_freqs = rope_freq_base;
+			using reader_type = direct_file_reader<config.exceptions>;
+			reader_type* reader{};
+			if (options.reader != weight_reader::mmap) {
+				reader = model_new.open_direct_reader(path, options.reader);
+				if (!reader) {
+					return false;
+				}
+			}
+			weight_load_schedule<half> schedule{};
+			bool output_found{};
+			for (uint64_t x = 0; x < tensor_infos.size(); ++x) {
+				const auto [op, layer]{ tensor_name_map<model_arch::llama>::impl(tensor_infos[x].name) };
+				if (op == static_cast<uint64_t>(llama_op_types::count)) {
+					continue;
+				}
+				output_found = output_found || op == static_cast<uint64_t>(llama_op_types::output_weight);
+				if (!weight_tensor_specs<config>::matches(op, tensor_infos[x])) {
+					return report_error("Sorry, but this tensor's type or shape does not match the model: " + std::string{ tensor_infos[x].name } + " (" +
+						get_type_name(tensor_infos[x].type) + ")");
+				}
+				const uint64_t absolute_offset{ tensor_data_start + tensor_infos[x].offset };
+				const uint64_t tensor_bytes{ weight_tensor_specs<config>::specs[op].bytes };
+				const bool repacked{ weight_layout_plan<config>::repacked(op) };
+				bool bound{ absolute_offset <= file.size() && tensor_bytes <= file.size() - absolute_offset &&
+					(!repacked || repacker_type::source_bytes(repack_traits[op]) <= tensor_bytes) };
+				if (bound) {
+					const uint64_t stage{ memory_plan<config>::weight_stage(op, layer) };
+					const uint8_t* weight{ file.data() + absolute_offset };
+					uint64_t weight_bytes{ tensor_bytes };
+					uint8_t* read_weight{};
+					if (reader) {
+						// The aligned span around the tensor goes to the start of its slot, which puts the tensor itself lead bytes in.
+						const uint64_t lead{ absolute_offset % reader_type::alignment };
+						uint8_t* slot{ model_new.claim_direct_weight(op, layer) };
+						if (slot) {
+							schedule.add_read(slot, absolute_offset - lead, roundUpToMultiple(lead + tensor_bytes, reader_type::alignment), stage);
+							read_weight = slot + lead;
+						}
+						weight = read_weight;
+					}
+					if (repacked) {
+						// A weight read into its slot is repacked there in place.
+						uint8_t* repacked_weight{ reader ? read_weight : model_new.claim_repacked_weight(op, layer) };
+						if (repacked_weight) {
+							schedule.add_repack(repack_traits[op], repacked_weight, weight, stage);
+						}
+						weight		 = repacked_weight;
+						weight_bytes = repack_traits[op].bytes;
+					} else if ((options.populate || options.background) && !reader) {
+						// Serving while loading gates each stage on its page-ins, so they are scheduled even when nothing asked for populate.
+						schedule.add_page_in(weight, std::min(weight_bytes, memory_plan<config>::traits[op].bytes), stage);
+					}
+					bound = weight && model_new.bind_weight(op, layer, weight, weight_bytes);
+				}
+				if (!bound) {
+					return report_error("Sorry, but this tensor does not fit the model: " + std::string{ tensor_infos[x].name });
+				}
+			}
+			// Tied checkpoints ship no output.weight at all; result_output then reads the embedding table.
+			if (!output_found && !model_new.tie_output_weight(schedule)) {
+				return report_error("Sorry, but this model has no output.weight and no token_embd.weight to tie it to!");
+			}
+			if (reader) {
+				file.close();
+			}
+			model_new.adopt_weight_file(std::move(file));
+			return model_new.run_weight_schedule(std::move(schedule), options.background);
+		}
+
 		NIHILUS_FORCE_INLINE static model_graph<config> parse_model(std::string_view path) {
-			std::string data_val{ file_loader<config.exceptions>{ path } };
 			model_graph<config> return_value{};
+			if (!return_value.weight_file.open(path)) {
+				report_error("Sorry, but the model file could not be opened: " + std::string{ path });
+				return return_value;
+			}
 			gguf_file_t gguf_file{};
 			string_iterator ptr{};
-			ptr.first_index	 = data_val.data();
-			ptr.length		 = data_val.size();
+			ptr.first_index	 = reinterpret_cast<const char*>(return_value.weight_file.data());
+			ptr.length		 = return_value.weight_file.size();
 			gguf_file.header = value_reader<gguf_header_t>::gather_value(ptr);
 			for (uint64_t x = 0; x < gguf_file.header.tensor_count; ++x) {
 				gguf_file.tensor_infos.emplace_back(value_reader<gguf_tensor_info_t>::gather_value(ptr));
 			}
-			auto calculate_tensor_size = [](const gguf_tensor_info_t& tensor) -> uint64_t {
-				core_base_creation_data temp_core{};
-				//temp_core.data_type_val = tensor.type;
-				for (uint64_t i = 0; i < tensor.n_dimensions; ++i) {
-					//temp_core.allocated_dims[i] = tensor.dimensions[i];
-				}
-				return temp_core.core_total_byte_size();
-			};
-
-			uint64_t total_tensor_bytes = 0;
-			uint64_t max_tensor_end	  = 0;
-			for (const auto& tensor: gguf_file.tensor_infos) {
-				uint64_t tensor_size = calculate_tensor_size(tensor);
-				total_tensor_bytes += tensor_size;
-				uint64_t tensor_end = tensor.offset + tensor_size;
-				max_tensor_end	  = std::max(max_tensor_end, tensor_end);
-			}
-			return_value.leaf_core_data.init(total_tensor_bytes);
-
-			uint64_t tensor_data_start = data_val.size() - max_tensor_end;
 			uint64_t alignment{ 32 };
-			gather_scalar("alignment", alignment, gguf_file.header.metadata_kv);
+			gather_scalar("general.alignment", alignment, gguf_file.header.metadata_kv);
+			const uint64_t tensor_data_start{ align_offset(ptr.current_index, alignment) };
 			return_value.cparams		  = value_reader<construction_parameters<model_arch::llama>, model_arch::llama>::gather_value(gguf_file.header.metadata_kv);
 			return_value.tokenizer_params = value_reader<tokenizer_parameters<model_arch::llama>, model_arch::llama>::gather_value(gguf_file.header.metadata_kv);
-			sort_tensor_infos(gguf_file.tensor_infos);
 			for (uint64_t x = 0; x < gguf_file.header.tensor_count; ++x) {
 				core_base_creation_data new_core{};
-				//new_core.name = arch_traits<model_arch::llama>::tensor_names[string_to_tensor_name<model_arch::llama>::impl(gguf_file.tensor_infos[x].name)]
-				//[extract_layer_number(gguf_file.tensor_infos[x].name)];
 				for (uint64_t y = 0; y < gguf_file.tensor_infos[x].n_dimensions; ++y) {
 					new_core.allocated_dims[y] = gguf_file.tensor_infos[x].dimensions[y];
 					new_core.allocated_dims[y] = gguf_file.tensor_infos[x].dimensions[y];
 				}
-				uint64_t current_size{ new_core.core_total_byte_size() };
 				uint64_t absolute_offset = tensor_data_start + gguf_file.tensor_infos[x].offset;
-				auto* ptr_new		   = return_value.leaf_core_data.claim_memory(current_size);
-				new_core.data		   = ptr_new;
-				std::memcpy(ptr_new, data_val.data() + absolute_offset, current_size);
+				new_core.data			 = const_cast<uint8_t*>(return_value.weight_file.data() + absolute_offset);
 				return_value.cores.emplace_back(new_core);
 			}
 			generate_ops(return_value);
@@ -1391,5 +1029,15 @@ namespace nihilus {
 			}
 			return return_value;
 		}
+
+	  protected:
+		NIHILUS_FORCE_INLINE static bool report_error(const std::string& message) {
+			if constexpr (config.exceptions) {
+				throw std::runtime_error{ message };
+			} else {
+				std::cerr << message << std::endl;
+				return false;
+			}
+		}
 	};
 }
@@ -20,41 +20,79 @@ RealTimeChris (Chris M.)
 
 #pragma once
 
+#include <nihilus/common/weight_repacker.hpp>
 #include <nihilus/common/kernel_traits.hpp>
 #include <nihilus/common/common.hpp>
 #include <nihilus/common/core_traits.hpp>
+#include <nihilus/common/scratch_arena.hpp>
 #include <nihilus/cpu/cpu_arch.hpp>
 
 namespace nihilus {
 
 	array<size_t, 22> depths_new{};
 
+	// Kernels whose kernel_traits declare scratch_bytes take the calling worker's arena as a trailing argument; every other kernel never sees it.
+	template<typename kernel_impl_type, typename... arg_types> NIHILUS_FORCE_INLINE void dispatch_kernel(scratch_arena& scratch, arg_types&&... args) {
+		if constexpr (requires { kernel_impl_type::impl(args..., scratch); }) {
+			kernel_impl_type::impl(args..., scratch);
+		} else {
+			kernel_impl_type::impl(args...);
+		}
+	}
+
 	template<model_config config, device_type dev_type, kernel_type type, single_input core_type> struct kernel_dispatcher
 		: public kernel_traits<type, core_type, typename core_type::input_type01> {
-		NIHILUS_FORCE_INLINE static void impl(core_type& params) {
-			kernel_dispatcher_impl<cpu_arch_index, type, typename core_type::transform_type, typename core_type::output_type, typename core_type::input_type01::output_type>::impl(
-				params.count, params.data, get_adjacent_value<config, core_type::type, 0>::impl(params).data);
+		NIHILUS_FORCE_INLINE static void impl(core_type& params, uint64_t current_block, scratch_arena& scratch) {
+			dispatch_kernel<kernel_dispatcher_impl<cpu_arch_index, type, typename core_type::transform_type, typename core_type::output_type,
+				typename core_type::input_type01::output_type>>(scratch, params.count, get_block_data(params, current_block),
+				get_block_data(get_adjacent_value<config, core_type::type, 0>::impl(params), current_block));
+			++depths_new[core_type::depth];
+		}
+	};
+
+	template<model_config config, device_type dev_type, single_input core_type> struct kernel_dispatcher<config, dev_type, kernel_type::softmax, core_type>
+		: public kernel_traits<kernel_type::softmax, core_type, typename core_type::input_type01> {
+		NIHILUS_FORCE_INLINE static void impl(core_type& params, uint64_t current_block, scratch_arena& scratch) {
+			dispatch_kernel<kernel_dispatcher_impl<cpu_arch_index, kernel_type::softmax, typename core_type::transform_type, typename core_type::output_type,
+				typename core_type::input_type01::output_type>>(scratch, params.count, get_block_data(params, current_block),
+				get_block_data(get_adjacent_value<config, core_type::type, 0>::impl(params), current_block), core_type::dims[0], params.mask);
 			++depths_new[core_type::depth];
 		}
 	};
 
 	template<model_config config, device_type dev_type, kernel_type type, double_input core_type> struct kernel_dispatcher<config, dev_type, type, core_type>
 		: public kernel_traits<type, core_type, typename core_type::input_type01, typename core_type::input_type02> {
-		NIHILUS_FORCE_INLINE static void impl(core_type& params) {
-			kernel_dispatcher_impl<cpu_arch_index, type, typename core_type::transform_type, typename core_type::output_type, typename core_type::input_type01::output_type,
-				typename core_type::input_type02::output_type>::impl(params.count, params.data, get_adjacent_value<config, core_type::type, 0>::impl(params).data,
-				get_adjacent_value<config, core_type::type, 1>::impl(params).data);
+		NIHILUS_FORCE_INLINE static void impl(core_type& params, uint64_t current_block, scratch_arena& scratch) {
+			dispatch_kernel<kernel_dispatcher_impl<cpu_arch_index, type, typename core_type::transform_type, typename core_type::output_type,
+				typename core_type::input_type01::output_type,
+				typename core_type::input_type02::output_type>>(scratch, params.count, get_block_data(params, current_block),
+				get_block_data(get_adjacent_value<config, core_type::type, 0>::impl(params), current_block),
+				get_block_data(get_adjacent_value<config, core_type::type, 1>::impl(params), current_block));
+			++depths_new[core_type::depth];
+		}
+	};
+
+	template<model_config config, device_type dev_type, double_input core_type> struct kernel_dispatcher<config, dev_type, kernel_type::mul_mat, core_type>
+		: public kernel_traits<kernel_type::mul_mat, core_type, typename core_type::input_type01, typename core_type::input_type02> {
+		NIHILUS_FORCE_INLINE static void impl(core_type& params, uint64_t current_block, scratch_arena& scratch) {
+			dispatch_kernel<kernel_dispatcher_impl<cpu_arch_index, kernel_type::mul_mat, typename core_type::transform_type, typename core_type::output_type,
+				mul_mat_operand_t<config, typename core_type::input_type01>,
+				typename core_type::input_type02::output_type>>(scratch, params.count, get_block_data(params, current_block),
+				get_block_data(get_adjacent_value<config, core_type::type, 0>::impl(params), current_block),
+				get_block_data(get_adjacent_value<config, core_type::type, 1>::impl(params), current_block));
 			++depths_new[core_type::depth];
 		}
 	};
 
 	template<model_config config, device_type dev_type, kernel_type type, triple_input core_type> struct kernel_dispatcher<config, dev_type, type, core_type>
 		: public kernel_traits<type, core_type, typename core_type::input_type01, typename core_type::input_type02, typename core_type::input_type03> {
-		NIHILUS_FORCE_INLINE static void impl(core_type& params) {
-			kernel_dispatcher_impl<cpu_arch_index, type, typename core_type::transform_type, typename core_type::output_type, typename core_type::input_type01::output_type,
-				typename core_type::input_type02::output_type, typename core_type::input_type03::output_type>::impl(params.count, params.data,
-				get_adjacent_value<config, core_type::type, 0>::impl(params).data, get_adjacent_value<config, core_type::type, 1>::impl(params).data,
-				get_adjacent_value<config, core_type::type, 2>::impl(params).data);
+		NIHILUS_FORCE_INLINE static void impl(core_type& params, uint64_t current_block, scratch_arena& scratch) {
+			dispatch_kernel<kernel_dispatcher_impl<cpu_arch_index, type, typename core_type::transform_type, typename core_type::output_type,
+				typename core_type::input_type01::output_type,
+				typename core_type::input_type02::output_type, typename core_type::input_type03::output_type>>(scratch, params.count, get_block_data(params, current_block),
+				get_block_data(get_adjacent_value<config, core_type::type, 0>::impl(params), current_block),
+				get_block_data(get_adjacent_value<config, core_type::type, 1>::impl(params), current_block),
+				get_block_data(get_adjacent_value<config, core_type::type, 2>::impl(params), current_block));
 			++depths_new[core_type::depth];
 		}
 	};
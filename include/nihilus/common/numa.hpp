@@ -0,0 +1,229 @@
+/*
+Copyright (c) 2025 RealTimeChris (Chris M.)
+
+This file is part of software offered under a restricted-use license to a designated Licensee,
+whose identity is confirmed in writing by the Author.
+
+License Terms (Summary):
+- Exclusive, non-transferable license for internal use only.
+- Redistribution, sublicensing, or public disclosure is prohibited without written consent.
+- Full ownership remains with the Author.
+- License may terminate if unused for [X months], if materially breached, or by mutual agreement.
+- No warranty is provided, express or implied.
+
+Full license terms are provided in the LICENSE file distributed with this software.
+
+Signed,
+RealTimeChris (Chris M.)
+2025
+*/
+
+#pragma once
+
+#include <nihilus/common/allocator.hpp>
+#include <nihilus/common/config.hpp>
+#include <nihilus/common/common.hpp>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined(NIHILUS_PLATFORM_WINDOWS)
+	#include <Windows.h>
+#elif defined(NIHILUS_PLATFORM_LINUX)
+	#include <sys/syscall.h>
+	#include <unistd.h>
+	#if __has_include(<linux/mempolicy.h>)
+		#include <linux/mempolicy.h>
+		#define NIHILUS_NUMA_MBIND 1
+	#endif
+#endif
+
+namespace nihilus {
+
+	struct numa_node {
+		uint64_t id{};
+		std::vector<uint32_t> cpus{};
+	};
+
+	// A worker as its node sees it: the node it is pinned to and its rank among that node's workers.
+	struct numa_thread_group {
+		uint64_t node{};
+		uint64_t rank{};
+		uint64_t size{ 1 };
+	};
+
+	// The machine's memory nodes and the cpus local to each, read once. Hosts without NUMA (or platforms we cannot query) report a single node
+	// holding every hardware thread, which turns every placement below into a no-op.
+	struct numa_topology {
+		std::vector<numa_node> nodes{};
+
+		NIHILUS_FORCE_INLINE static const numa_topology& get() {
+			static const numa_topology topology{ discover() };
+			return topology;
+		}
+
+		NIHILUS_FORCE_INLINE uint64_t node_count() const {
+			return nodes.size();
+		}
+
+		// Pool threads are split into contiguous groups, one per node and sized to it, so thread_index order is node order.
+		NIHILUS_FORCE_INLINE uint64_t node_of_thread(uint64_t thread_index, uint64_t thread_count) const {
+			return nodes.size() > 1 && thread_count > 0 ? thread_index * nodes.size() / thread_count : 0;
+		}
+
+		// The first thread index of node's group; past the last node, thread_count.
+		NIHILUS_FORCE_INLINE uint64_t first_thread_of_node(uint64_t node, uint64_t thread_count) const {
+			return (node * thread_count + nodes.size() - 1) / nodes.size();
+		}
+
+		NIHILUS_FORCE_INLINE numa_thread_group group_of_thread(uint64_t thread_index, uint64_t thread_count) const {
+			const uint64_t node{ node_of_thread(thread_index, thread_count) };
+			if (nodes.size() < 2) {
+				return numa_thread_group{ 0, thread_index, thread_count };
+			}
+			const uint64_t group_begin{ first_thread_of_node(node, thread_count) };
+			const uint64_t group_end{ first_thread_of_node(node + 1, thread_count) };
+			return numa_thread_group{ node, thread_index - group_begin, group_end - group_begin };
+		}
+
+		NIHILUS_FORCE_INLINE uint32_t cpu_of_thread(uint64_t thread_index, uint64_t thread_count) const {
+			const numa_thread_group group{ group_of_thread(thread_index, thread_count) };
+			const std::vector<uint32_t>& cpus{ nodes[group.node].cpus };
+			return cpus.empty() ? static_cast<uint32_t>(thread_index) : cpus[group.rank % cpus.size()];
+		}
+
+		// Applies placement to the pages of [data, data + size), which must be anonymous memory: binding pages of a file mapping only sets a policy
+		// on the page cache, which ignores it. Pages not yet touched are allocated accordingly; resident pages are migrated. partition splits the
+		// range into unit_bytes units (rows, or row groups of a repacked weight) the way a row-parallel kernel splits them over the pool, units
+		// [units * thread_index / thread_count, units * (thread_index + 1) / thread_count) per thread, and binds each node the units of its threads;
+		// without a unit it falls back to interleave. Returns false if the platform cannot place memory or the kernel refused.
+		NIHILUS_FORCE_INLINE bool place(const void* data, uint64_t size, numa_placement placement, uint64_t unit_bytes = 0, uint64_t thread_count = 0) const {
+			if (nodes.size() < 2 || placement == numa_placement::none || !data || size == 0) {
+				return true;
+			}
+			const uint64_t units{ unit_bytes > 0 ? size / unit_bytes : 0 };
+			if (placement == numa_placement::interleave || units == 0 || thread_count == 0) {
+				return bind(data, size, all_nodes(), interleave_mode);
+			}
+			bool return_value{ true };
+			for (uint64_t x = 0; x < nodes.size(); ++x) {
+				const uint64_t begin{ units * first_thread_of_node(x, thread_count) / thread_count * unit_bytes };
+				const uint64_t end{ x + 1 == nodes.size() ? size : units * first_thread_of_node(x + 1, thread_count) / thread_count * unit_bytes };
+				return_value = bind(static_cast<const uint8_t*>(data) + begin, end - begin, uint64_t{ 1 } << nodes[x].id, bind_mode) && return_value;
+			}
+			return return_value;
+		}
+
+	  protected:
+#if defined(NIHILUS_NUMA_MBIND)
+		static constexpr int bind_mode{ MPOL_BIND };
+		static constexpr int interleave_mode{ MPOL_INTERLEAVE };
+#else
+		static constexpr int bind_mode{ 2 };
+		static constexpr int interleave_mode{ 3 };
+#endif
+
+		NIHILUS_FORCE_INLINE uint64_t all_nodes() const {
+			uint64_t mask{};
+			for (uint64_t x = 0; x < nodes.size(); ++x) {
+				mask |= uint64_t{ 1 } << nodes[x].id;
+			}
+			return mask;
+		}
+
+		NIHILUS_FORCE_INLINE static bool bind(const void* data, uint64_t size, uint64_t node_mask, int mode) {
+#if defined(NIHILUS_NUMA_MBIND)
+			static const uint64_t page_size{ static_cast<uint64_t>(sysconf(_SC_PAGESIZE)) };
+			// mbind wants a page-aligned start; rounding inwards keeps a shared boundary page under whichever slice touches it first.
+			const uint64_t begin{ roundUpToMultiple(reinterpret_cast<uintptr_t>(data), page_size) };
+			const uint64_t end{ (reinterpret_cast<uintptr_t>(data) + size) / page_size * page_size };
+			if (end <= begin) {
+				return true;
+			}
+			return syscall(SYS_mbind, begin, end - begin, mode, &node_mask, 64ul, MPOL_MF_MOVE) == 0;
+#else
+			(void)data;
+			(void)size;
+			(void)node_mask;
+			(void)mode;
+			return false;
+#endif
+		}
+
+		NIHILUS_FORCE_INLINE static numa_topology discover() {
+			numa_topology return_value{};
+#if defined(NIHILUS_PLATFORM_LINUX)
+			std::error_code error{};
+			for (uint64_t x = 0; x < 64; ++x) {
+				const std::filesystem::path cpulist{ "/sys/devices/system/node/node" + std::to_string(x) + "/cpulist" };
+				if (!std::filesystem::exists(cpulist, error)) {
+					continue;
+				}
+				std::ifstream file{ cpulist };
+				std::string text{};
+				std::getline(file, text);
+				numa_node node{ x, parse_cpu_list(text) };
+				if (!node.cpus.empty()) {
+					return_value.nodes.emplace_back(std::move(node));
+				}
+			}
+#elif defined(NIHILUS_PLATFORM_WINDOWS)
+			ULONG highest_node{};
+			if (GetNumaHighestNodeNumber(&highest_node)) {
+				for (ULONG x = 0; x <= highest_node && x < 64; ++x) {
+					ULONGLONG mask{};
+					if (!GetNumaNodeProcessorMask(static_cast<UCHAR>(x), &mask) || mask == 0) {
+						continue;
+					}
+					numa_node node{ x, {} };
+					for (uint32_t y = 0; y < 64; ++y) {
+						if (mask & (1ull << y)) {
+							node.cpus.emplace_back(y);
+						}
+					}
+					return_value.nodes.emplace_back(std::move(node));
+				}
+			}
+#endif
+			if (return_value.nodes.empty()) {
+				numa_node node{};
+				for (uint32_t x = 0; x < std::thread::hardware_concurrency(); ++x) {
+					node.cpus.emplace_back(x);
+				}
+				return_value.nodes.emplace_back(std::move(node));
+			}
+			return return_value;
+		}
+
+		// "0-3,8,10-11" -> 0 1 2 3 8 10 11
+		NIHILUS_FORCE_INLINE static std::vector<uint32_t> parse_cpu_list(const std::string& text) {
+			std::vector<uint32_t> return_value{};
+			uint64_t index{};
+			auto parse_number = [&]() {
+				uint32_t value{};
+				while (index < text.size() && text[index] >= '0' && text[index] <= '9') {
+					value = value * 10 + static_cast<uint32_t>(text[index++] - '0');
+				}
+				return value;
+			};
+			while (index < text.size() && text[index] >= '0' && text[index] <= '9') {
+				const uint32_t first{ parse_number() };
+				uint32_t last{ first };
+				if (index < text.size() && text[index] == '-') {
+					++index;
+					last = parse_number();
+				}
+				for (uint32_t x = first; x <= last; ++x) {
+					return_value.emplace_back(x);
+				}
+				if (index < text.size() && text[index] == ',') {
+					++index;
+				}
+			}
+			return return_value;
+		}
+	};
+
+}
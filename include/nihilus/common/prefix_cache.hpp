@@ -0,0 +1,266 @@
+/*
+Copyright (c) 2025 RealTimeChris (Chris M.)
+
+This file is part of software offered under a restricted-use license to a designated Licensee,
+whose identity is confirmed in writing by the Author.
+
+License Terms (Summary):
+- Exclusive, non-transferable license for internal use only.
+- Redistribution, sublicensing, or public disclosure is prohibited without written consent.
+- Full ownership remains with the Author.
+- License may terminate if unused for [X months], if materially breached, or by mutual agreement.
+- No warranty is provided, express or implied.
+
+Full license terms are provided in the LICENSE file distributed with this software.
+
+Signed,
+RealTimeChris (Chris M.)
+2025
+*/
+
+#pragma once
+
+#include <nihilus/common/core_traits.hpp>
+#include <nihilus/common/model_traits.hpp>
+#include <nihilus/common/common.hpp>
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+namespace nihilus {
+
+	struct kv_page_pool {
+		NIHILUS_FORCE_INLINE kv_page_pool() noexcept							   = default;
+		NIHILUS_FORCE_INLINE kv_page_pool& operator=(const kv_page_pool&) noexcept = delete;
+		NIHILUS_FORCE_INLINE kv_page_pool(const kv_page_pool&) noexcept			   = delete;
+
+		NIHILUS_FORCE_INLINE void init(uint64_t page_count) {
+			ref_counts.assign(page_count, 0);
+			free_count = page_count;
+		}
+
+		NIHILUS_FORCE_INLINE bool acquire(uint32_t page) {
+			if (page >= ref_counts.size() || ref_counts[page] != 0) {
+				return false;
+			}
+			ref_counts[page] = 1;
+			--free_count;
+			return true;
+		}
+
+		NIHILUS_FORCE_INLINE void retain(uint32_t page) {
+			++ref_counts[page];
+		}
+
+		NIHILUS_FORCE_INLINE void release(uint32_t page) {
+			if (--ref_counts[page] == 0) {
+				++free_count;
+			}
+		}
+
+		NIHILUS_FORCE_INLINE uint32_t ref_count(uint32_t page) const {
+			return ref_counts[page];
+		}
+
+		NIHILUS_FORCE_INLINE uint64_t available() const {
+			return free_count;
+		}
+
+	  protected:
+		std::vector<uint32_t> ref_counts{};
+		uint64_t free_count{};
+	};
+
+	// Radix tree over token prefixes whose edges are whole kv pages, so a matched prefix can be shared by reference instead of being recomputed.
+	// The graph's cache views address kv rows by position, so pages are identity mapped: page x always holds positions [x * page_size, +page_size).
+	// A page can therefore sit on one branch only, and claiming it for a sequence that diverges there evicts the cached suffix that held it. In
+	// effect this caches one sequence: a request reuses whatever prefix it shares with the last sequence cached, and two prompts that diverge
+	// inside the same pages keep evicting each other. Keeping several branches resident needs the cache views to read through a page table.
+	template<model_config config> struct prefix_cache {
+		using model_traits_type = model_traits<config.arch, config.model_size, config.model_generation>;
+		static constexpr uint64_t page_size{ config.kv_cache_block_size };
+		static constexpr uint64_t page_count{ sequence_traits<config>::context_length / page_size };
+		static_assert(page_size > 0 && sequence_traits<config>::context_length % page_size == 0, "Sorry, but kv_cache_block_size must evenly divide the context length!");
+
+		NIHILUS_FORCE_INLINE prefix_cache() {
+			pool.init(page_count);
+			nodes.emplace_back();
+		}
+
+		NIHILUS_FORCE_INLINE prefix_cache& operator=(const prefix_cache&) = delete;
+		NIHILUS_FORCE_INLINE prefix_cache(const prefix_cache&)			  = delete;
+
+		// Returns how many leading tokens already have resident kv rows, appending (and retaining) the pages that hold them.
+		NIHILUS_FORCE_INLINE uint64_t match(const int32_t* tokens, uint64_t token_count, std::vector<uint32_t>& pages) {
+			const uint64_t full_pages{ token_count / page_size };
+			uint64_t matched{};
+			uint32_t node{};
+			while (matched < full_pages) {
+				const uint32_t child{ find_child(node, tokens + matched * page_size) };
+				if (child == 0) {
+					break;
+				}
+				const uint64_t shared{ shared_pages(child, tokens + matched * page_size, full_pages - matched) };
+				for (uint64_t x = 0; x < shared; ++x) {
+					pool.retain(nodes[child].pages[x]);
+					pages.emplace_back(nodes[child].pages[x]);
+				}
+				matched += shared;
+				if (shared < nodes[child].pages.size()) {
+					break;
+				}
+				node = child;
+			}
+			return matched * page_size;
+		}
+
+		// Publishes the full pages of a sequence; a trailing partial page stays private since it is still being written.
+		NIHILUS_FORCE_INLINE void insert(const int32_t* tokens, uint64_t token_count, const std::vector<uint32_t>& pages) {
+			const uint64_t full_pages{ std::min(token_count / page_size, static_cast<uint64_t>(pages.size())) };
+			uint64_t inserted{};
+			uint32_t node{};
+			while (inserted < full_pages) {
+				const int32_t* current_tokens{ tokens + inserted * page_size };
+				uint32_t child{ find_child(node, current_tokens) };
+				if (child == 0) {
+					const uint32_t leaf{ allocate_node() };
+					nodes[leaf].tokens.assign(current_tokens, tokens + full_pages * page_size);
+					nodes[leaf].pages.assign(pages.begin() + static_cast<std::ptrdiff_t>(inserted), pages.begin() + static_cast<std::ptrdiff_t>(full_pages));
+					for (uint32_t page: nodes[leaf].pages) {
+						pool.retain(page);
+					}
+					nodes[leaf].parent = node;
+					nodes[node].children.emplace_back(leaf);
+					return;
+				}
+				const uint64_t shared{ shared_pages(child, current_tokens, full_pages - inserted) };
+				inserted += shared;
+				if (shared < nodes[child].pages.size()) {
+					child = split(child, shared);
+				}
+				node = child;
+			}
+		}
+
+		NIHILUS_FORCE_INLINE bool acquire_page(uint32_t page) {
+			if (pool.acquire(page)) {
+				return true;
+			}
+			evict_from(page);
+			return pool.acquire(page);
+		}
+
+		// Drops the tree's references to page and to every cached page that continues the same prefix after it.
+		NIHILUS_FORCE_INLINE void evict_from(uint32_t page) {
+			for (uint32_t x = 1; x < nodes.size(); ++x) {
+				const auto found{ std::find(nodes[x].pages.begin(), nodes[x].pages.end(), page) };
+				if (!nodes[x].live || found == nodes[x].pages.end()) {
+					continue;
+				}
+				const uint64_t offset{ static_cast<uint64_t>(found - nodes[x].pages.begin()) };
+				if (offset > 0) {
+					split(x, offset);
+				}
+				auto& siblings{ nodes[nodes[x].parent].children };
+				siblings.erase(std::remove(siblings.begin(), siblings.end(), x), siblings.end());
+				evict_subtree(x);
+				return;
+			}
+		}
+
+		NIHILUS_FORCE_INLINE void release_pages(std::vector<uint32_t>& pages) {
+			for (uint32_t page: pages) {
+				pool.release(page);
+			}
+			pages.clear();
+		}
+
+		NIHILUS_FORCE_INLINE void release_page(uint32_t page) {
+			pool.release(page);
+		}
+
+		NIHILUS_FORCE_INLINE bool is_shared(uint32_t page) const {
+			return pool.ref_count(page) > 1;
+		}
+
+		NIHILUS_FORCE_INLINE uint64_t available_pages() const {
+			return pool.available();
+		}
+
+	  protected:
+		struct radix_node {
+			std::vector<int32_t> tokens{};
+			std::vector<uint32_t> pages{};
+			std::vector<uint32_t> children{};
+			uint32_t parent{};
+			bool live{ true };
+		};
+
+		std::vector<uint32_t> free_nodes{};
+		std::vector<radix_node> nodes{};
+		kv_page_pool pool{};
+
+		NIHILUS_FORCE_INLINE static bool page_equals(const int32_t* lhs, const int32_t* rhs) {
+			return std::memcmp(lhs, rhs, page_size * sizeof(int32_t)) == 0;
+		}
+
+		NIHILUS_FORCE_INLINE uint32_t find_child(uint32_t node, const int32_t* tokens) const {
+			for (uint32_t child: nodes[node].children) {
+				if (page_equals(nodes[child].tokens.data(), tokens)) {
+					return child;
+				}
+			}
+			return 0;
+		}
+
+		NIHILUS_FORCE_INLINE uint64_t shared_pages(uint32_t node, const int32_t* tokens, uint64_t page_limit) const {
+			const uint64_t limit{ std::min(static_cast<uint64_t>(nodes[node].pages.size()), page_limit) };
+			uint64_t shared{ 1 };
+			while (shared < limit && page_equals(nodes[node].tokens.data() + shared * page_size, tokens + shared * page_size)) {
+				++shared;
+			}
+			return shared;
+		}
+
+		NIHILUS_FORCE_INLINE uint32_t allocate_node() {
+			if (!free_nodes.empty()) {
+				const uint32_t index{ free_nodes.back() };
+				free_nodes.pop_back();
+				nodes[index] = radix_node{};
+				return index;
+			}
+			nodes.emplace_back();
+			return static_cast<uint32_t>(nodes.size() - 1);
+		}
+
+		NIHILUS_FORCE_INLINE uint32_t split(uint32_t index, uint64_t page_offset) {
+			const uint32_t head{ allocate_node() };
+			radix_node& tail_node{ nodes[index] };
+			radix_node& head_node{ nodes[head] };
+			const auto token_split{ static_cast<std::ptrdiff_t>(page_offset * page_size) };
+			const auto page_split{ static_cast<std::ptrdiff_t>(page_offset) };
+			head_node.tokens.assign(tail_node.tokens.begin(), tail_node.tokens.begin() + token_split);
+			head_node.pages.assign(tail_node.pages.begin(), tail_node.pages.begin() + page_split);
+			tail_node.tokens.erase(tail_node.tokens.begin(), tail_node.tokens.begin() + token_split);
+			tail_node.pages.erase(tail_node.pages.begin(), tail_node.pages.begin() + page_split);
+			head_node.parent = tail_node.parent;
+			head_node.children.emplace_back(index);
+			std::replace(nodes[head_node.parent].children.begin(), nodes[head_node.parent].children.end(), index, head);
+			tail_node.parent = head;
+			return head;
+		}
+
+		NIHILUS_FORCE_INLINE void evict_subtree(uint32_t index) {
+			for (uint32_t child: nodes[index].children) {
+				evict_subtree(child);
+			}
+			for (uint32_t page: nodes[index].pages) {
+				pool.release(page);
+			}
+			nodes[index]	  = radix_node{};
+			nodes[index].live = false;
+			free_nodes.emplace_back(index);
+		}
+	};
+
+}
@@ -0,0 +1,298 @@
+/*
+Copyright (c) 2025 RealTimeChris (Chris M.)
+
+This file is part of software offered under a restricted-use license to a designated Licensee,
+whose identity is confirmed in writing by the Author.
+
+License Terms (Summary):
+- Exclusive, non-transferable license for internal use only.
+- Redistribution, sublicensing, or public disclosure is prohibited without written consent.
+- Full ownership remains with the Author.
+- License may terminate if unused for [X months], if materially breached, or by mutual agreement.
+- No warranty is provided, express or implied.
+
+Full license terms are provided in the LICENSE file distributed with this software.
+
+Signed,
+RealTimeChris (Chris M.)
+2025
+*/
+
+#pragma once
+
+#include <nihilus/common/memory_mapped_file.hpp>
+#include <nihilus/common/weight_repacker.hpp>
+#include <nihilus/common/memory_planner.hpp>
+#include <nihilus/common/model_parser.hpp>
+#include <nihilus/common/model_traits.hpp>
+#include <nihilus/common/common.hpp>
+#include <nihilus/common/array.hpp>
+#include <filesystem>
+#include <fstream>
+#include <vector>
+
+namespace nihilus {
+
+	static constexpr uint64_t prepacked_magic{ 0x4B434150534C484EULL };// "NHLSPACK"
+	static constexpr uint64_t prepacked_version{ 2 };
+	static constexpr uint64_t prepacked_alignment{ 4096 };
+
+	// Everything the engine needs to trust the file is fixed-width and comparable against a constexpr copy; there is nothing to parse.
+	struct prepacked_header {
+		uint64_t magic{};
+		uint64_t version{};
+		uint64_t arch{};
+		uint64_t model_generation{};
+		uint64_t model_size{};
+		uint64_t kernel_profile{};
+		uint64_t block_count{};
+		uint64_t embedding_dim{};
+		uint64_t feed_forward_length{};
+		uint64_t head_count{};
+		uint64_t head_count_kv{};
+		uint64_t vocab_size{};
+		uint64_t tensor_count{};
+		uint64_t alignment{};
+		uint64_t data_offset{};
+		uint64_t data_bytes{};
+		uint64_t layout_hash{};
+
+		constexpr bool operator==(const prepacked_header&) const = default;
+	};
+
+	struct prepacked_entry {
+		uint64_t op{};
+		uint64_t layer{};
+		uint64_t offset{};
+		uint64_t bytes{};
+		weight_layout layout{};
+	};
+
+	// Weight placement of the native format: each tensor (one per layer for per-block weights) in the order the schedule first reads it, every one
+	// starting on a page boundary and already in its kernel's weight_layout. Derived entirely from core_traits and the compiled kernels, so a file
+	// written for one config and cpu_arch_index maps into exactly that build.
+	template<model_config config> struct prepacked_layout {
+		using plan_type			= memory_plan<config>;
+		using model_traits_type = model_traits<config.arch, config.model_size, config.model_generation>;
+		static constexpr uint64_t op_count{ plan_type::op_count };
+		static constexpr uint64_t block_count{ model_traits_type::block_count };
+
+		// Per-block weights repeat for every layer; single weights first read inside the block loop are hoisted in front of it. A tied output_weight
+		// gets no entry: the loader points it at token_embd_weight.
+		static constexpr typename plan_type::weight_order order{ [] {
+			typename plan_type::weight_order return_value{ plan_type::weight_sequence };
+			if constexpr (model_traits_type::tied_embeddings) {
+				auto drop = [](array<uint64_t, op_count>& ops, uint64_t& op_total) {
+					uint64_t kept{};
+					for (uint64_t x = 0; x < op_total; ++x) {
+						if (ops[x] != static_cast<uint64_t>(llama_op_types::output_weight)) {
+							ops[kept++] = ops[x];
+						}
+					}
+					op_total = kept;
+				};
+				drop(return_value.leading, return_value.leading_count);
+				drop(return_value.trailing, return_value.trailing_count);
+			}
+			return return_value;
+		}() };
+
+		static constexpr uint64_t entry_count{ order.leading_count + order.per_block_count * block_count + order.trailing_count };
+
+		static constexpr array<prepacked_entry, entry_count> entries{ [] {
+			array<prepacked_entry, entry_count> return_value{};
+			uint64_t index{};
+			uint64_t offset{};
+			auto place = [&](uint64_t op, uint64_t layer) {
+				return_value[index++] = prepacked_entry{ op, layer, offset, plan_type::traits[op].bytes, weight_layout_plan<config>::traits[op].layout };
+				offset += roundUpToMultiple(plan_type::traits[op].bytes, prepacked_alignment);
+			};
+			for (uint64_t x = 0; x < order.leading_count; ++x) {
+				place(order.leading[x], 0);
+			}
+			for (uint64_t layer = 0; layer < block_count; ++layer) {
+				for (uint64_t x = 0; x < order.per_block_count; ++x) {
+					place(order.per_block[x], layer);
+				}
+			}
+			for (uint64_t x = 0; x < order.trailing_count; ++x) {
+				place(order.trailing[x], 0);
+			}
+			return return_value;
+		}() };
+
+		static constexpr uint64_t data_offset{ roundUpToMultiple(sizeof(prepacked_header), prepacked_alignment) };
+		static constexpr uint64_t data_bytes{ entry_count > 0 ? entries[entry_count - 1].offset + roundUpToMultiple(entries[entry_count - 1].bytes, prepacked_alignment) : 0 };
+
+		static constexpr prepacked_header header{ [] {
+			uint64_t hash{ 14695981039346656037ULL };
+			auto mix = [&](uint64_t value) {
+				hash = (hash ^ value) * 1099511628211ULL;
+			};
+			for (uint64_t x = 0; x < entry_count; ++x) {
+				mix(entries[x].op);
+				mix(entries[x].layer);
+				mix(entries[x].offset);
+				mix(entries[x].bytes);
+				mix(static_cast<uint64_t>(entries[x].layout));
+			}
+			return prepacked_header{ prepacked_magic, prepacked_version, static_cast<uint64_t>(config.arch), static_cast<uint64_t>(config.model_generation),
+				static_cast<uint64_t>(config.model_size), static_cast<uint64_t>(config.kernel_profile), block_count, model_traits_type::embedding_dim,
+				model_traits_type::feed_forward_length, model_traits_type::head_count, model_traits_type::head_count_kv, model_traits_type::vocab_size, entry_count,
+				prepacked_alignment, data_offset, data_bytes, hash };
+		}() };
+
+		NIHILUS_FORCE_INLINE static constexpr uint64_t find(uint64_t op, uint64_t layer) {
+			for (uint64_t x = 0; x < entry_count; ++x) {
+				if (entries[x].op == op && entries[x].layer == (plan_type::traits[op].per_block ? layer : 0)) {
+					return x;
+				}
+			}
+			return entry_count;
+		}
+	};
+
+	// Converts a GGUF file into the native layout for config; only the prepacker tool needs this, the engine never touches GGUF for a prepacked model.
+	template<model_config config> struct prepacked_writer {
+		using layout_type = prepacked_layout<config>;
+
+		NIHILUS_FORCE_INLINE static bool write(const std::filesystem::path& gguf_path, const std::filesystem::path& output_path) {
+			memory_mapped_file<config.exceptions> file{ gguf_path, map_options{ false, map_advice::sequential } };
+			if (!file) {
+				return false;
+			}
+			string_iterator ptr{};
+			ptr.first_index = reinterpret_cast<const char*>(file.data());
+			ptr.length		= file.size();
+			gguf_header_t gguf_header{ value_reader<gguf_header_t>::gather_value(ptr) };
+			std::vector<gguf_tensor_info_t> tensor_infos{};
+			tensor_infos.reserve(gguf_header.tensor_count);
+			for (uint64_t x = 0; x < gguf_header.tensor_count; ++x) {
+				tensor_infos.emplace_back(value_reader<gguf_tensor_info_t>::gather_value(ptr));
+			}
+			uint64_t alignment{ 32 };
+			gather_scalar("general.alignment", alignment, gguf_header.metadata_kv);
+			const uint64_t tensor_data_start{ align_offset(ptr.current_index, alignment) };
+
+			std::vector<uint64_t> source_offsets(layout_type::entry_count, file.size());
+			for (uint64_t x = 0; x < tensor_infos.size(); ++x) {
+				const auto [op, layer]{ tensor_name_map<model_arch::llama>::impl(tensor_infos[x].name) };
+				if (op == static_cast<uint64_t>(llama_op_types::count)) {
+					continue;
+				}
+				const uint64_t index{ layout_type::find(op, layer) };
+				if (index >= layout_type::entry_count) {
+					continue;
+				}
+				const uint64_t source_offset{ tensor_data_start + tensor_infos[x].offset };
+				if (!weight_tensor_specs<config>::matches(op, tensor_infos[x])) {
+					return report_error("Sorry, but this tensor's type or shape does not match the model: " + std::string{ tensor_infos[x].name } + " (" +
+						get_type_name(tensor_infos[x].type) + ")");
+				}
+				if (source_offset > file.size() || weight_tensor_specs<config>::specs[op].bytes > file.size() - source_offset) {
+					return report_error("Sorry, but this tensor runs past the end of the GGUF file: " + std::string{ tensor_infos[x].name });
+				}
+				source_offsets[index] = source_offset;
+			}
+
+			std::ofstream output{ output_path, std::ios::binary | std::ios::trunc };
+			if (!output) {
+				return report_error("Sorry, but the prepacked file could not be created: " + output_path.string());
+			}
+			const std::vector<char> padding(prepacked_alignment, 0);
+			std::vector<uint8_t> repacked{};
+			output.write(reinterpret_cast<const char*>(&layout_type::header), sizeof(prepacked_header));
+			output.write(padding.data(), static_cast<std::streamsize>(layout_type::data_offset - sizeof(prepacked_header)));
+			for (uint64_t x = 0; x < layout_type::entry_count; ++x) {
+				const prepacked_entry& entry{ layout_type::entries[x] };
+				if (source_offsets[x] >= file.size()) {
+					return report_error(std::string{ "Sorry, but the GGUF file is missing a tensor for op: " } + llama_op_names[entry.op]);
+				}
+				const uint8_t* source{ file.data() + source_offsets[x] };
+				// Slots are 64-byte rounded; whatever the tensor does not fill is zeroed rather than copied from the bytes that follow it in the GGUF.
+				uint64_t available{ std::min(entry.bytes, weight_tensor_specs<config>::specs[entry.op].bytes) };
+				if (entry.layout != weight_layout::row_major) {
+					const weight_repack_traits& repack_traits{ weight_layout_plan<config>::traits[entry.op] };
+					if (weight_repacker<half>::source_bytes(repack_traits) > weight_tensor_specs<config>::specs[entry.op].bytes) {
+						return report_error(std::string{ "Sorry, but the GGUF tensor is too short to repack for op: " } + llama_op_names[entry.op]);
+					}
+					repacked.assign(entry.bytes, 0);
+					weight_repacker<half>::impl(repack_traits, repacked.data(), source);
+					source	  = repacked.data();
+					available = entry.bytes;
+				}
+				output.write(reinterpret_cast<const char*>(source), static_cast<std::streamsize>(available));
+				uint64_t remaining{ roundUpToMultiple(entry.bytes, prepacked_alignment) - available };
+				while (remaining > 0) {
+					const uint64_t chunk{ std::min(remaining, prepacked_alignment) };
+					output.write(padding.data(), static_cast<std::streamsize>(chunk));
+					remaining -= chunk;
+				}
+			}
+			if (!output) {
+				return report_error("Sorry, but writing the prepacked file failed: " + output_path.string());
+			}
+			return true;
+		}
+
+	  protected:
+		NIHILUS_FORCE_INLINE static bool report_error(const std::string& message) {
+			if constexpr (config.exceptions) {
+				throw std::runtime_error{ message };
+			} else {
+				std::cerr << message << std::endl;
+				return false;
+			}
+		}
+	};
+
+	template<model_config config> struct model_parser<config, model_arch::llama, model_format::prepacked> {
+		using layout_type = prepacked_layout<config>;
+
+		// Validates the header against the constexpr one for config, then binds every weight straight from the compile-time entry table.
+		NIHILUS_FORCE_INLINE static bool load_weights(model<config>& model_new, const std::filesystem::path& path, map_options options) {
+			memory_mapped_file<config.exceptions> file{ path, map_options{ false, options.advice } };
+			if (!file) {
+				return false;
+			}
+			if (file.size() < layout_type::data_offset + layout_type::data_bytes ||
+				*reinterpret_cast<const prepacked_header*>(file.data()) != layout_type::header) {
+				if constexpr (config.exceptions) {
+					throw std::runtime_error{ "Sorry, but that prepacked file was written for a different model or format version!" };
+				} else {
+					std::cerr << "Sorry, but that prepacked file was written for a different model or format version!" << std::endl;
+					return false;
+				}
+			}
+			const uint8_t* data{ file.data() + layout_type::data_offset };
+			weight_load_schedule<half> schedule{};
+			for (uint64_t x = 0; x < layout_type::entry_count; ++x) {
+				const prepacked_entry& entry{ layout_type::entries[x] };
+				if (!model_new.bind_weight(entry.op, entry.layer, data + entry.offset, entry.bytes)) {
+					if constexpr (config.exceptions) {
+						throw std::runtime_error{ std::string{ "Sorry, but this prepacked tensor does not fit the model: " } + llama_op_names[entry.op] };
+					} else {
+						std::cerr << "Sorry, but this prepacked tensor does not fit the model: " << llama_op_names[entry.op] << std::endl;
+						return false;
+					}
+				}
+				if (options.populate || options.background) {
+					schedule.add_page_in(data + entry.offset, entry.bytes, memory_plan<config>::weight_stage(entry.op, entry.layer));
+				}
+			}
+			if constexpr (model_traits<config.arch, config.model_size, config.model_generation>::tied_embeddings) {
+				if (!model_new.tie_output_weight(schedule)) {
+					if constexpr (config.exceptions) {
+						throw std::runtime_error{ "Sorry, but output_weight could not be tied to token_embd_weight!" };
+					} else {
+						std::cerr << "Sorry, but output_weight could not be tied to token_embd_weight!" << std::endl;
+						return false;
+					}
+				}
+			}
+			model_new.adopt_weight_file(std::move(file));
+			return model_new.run_weight_schedule(std::move(schedule), options.background);
+		}
+	};
+
+}
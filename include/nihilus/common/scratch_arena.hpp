@@ -0,0 +1,127 @@
+/*
+Copyright (c) 2025 RealTimeChris (Chris M.)
+
+This file is part of software offered under a restricted-use license to a designated Licensee,
+whose identity is confirmed in writing by the Author.
+
+License Terms (Summary):
+- Exclusive, non-transferable license for internal use only.
+- Redistribution, sublicensing, or public disclosure is prohibited without written consent.
+- Full ownership remains with the Author.
+- License may terminate if unused for [X months], if materially breached, or by mutual agreement.
+- No warranty is provided, express or implied.
+
+Full license terms are provided in the LICENSE file distributed with this software.
+
+Signed,
+RealTimeChris (Chris M.)
+2025
+*/
+
+#pragma once
+
+#include <nihilus/common/kernel_traits.hpp>
+#include <nihilus/common/core_traits.hpp>
+#include <nihilus/common/allocator.hpp>
+#include <nihilus/common/common.hpp>
+#include <nihilus/common/array.hpp>
+#include <algorithm>
+#include <cstring>
+
+namespace nihilus {
+
+	// One worker's temporaries for the op it is running. Only its owner ever touches it, and the thread function resets it before every op, so
+	// claims are a plain bump with no atomics; the header is cache-line aligned so neighbouring workers' offsets never share a line.
+	struct alignas(64) scratch_arena {
+		uint8_t* data{};
+		uint64_t size{};
+		uint64_t offset{};
+
+		NIHILUS_FORCE_INLINE void reset() {
+			offset = 0;
+		}
+
+		// Every claim starts on its own cache line. The arena is sized by scratch_plan for the largest kernel_traits::scratch_bytes, so a kernel that
+		// claims only what it declared never sees nullptr.
+		template<typename value_type> NIHILUS_FORCE_INLINE value_type* claim(uint64_t count) {
+			const uint64_t begin{ roundUpToMultiple(offset, uint64_t{ 64 }) };
+			if (begin + count * sizeof(value_type) > size) {
+				return nullptr;
+			}
+			offset = begin + count * sizeof(value_type);
+			return reinterpret_cast<value_type*>(data + begin);
+		}
+
+		// Called by the owning worker once it is pinned, so first touch puts the pages on that worker's NUMA node.
+		NIHILUS_FORCE_INLINE void touch() {
+			if (data) {
+				std::memset(data, 0, size);
+			}
+		}
+	};
+
+	template<typename base_type_new> struct scratch_collector {
+		NIHILUS_FORCE_INLINE scratch_collector() noexcept									  = default;
+		NIHILUS_FORCE_INLINE scratch_collector& operator=(const scratch_collector&) noexcept = delete;
+		NIHILUS_FORCE_INLINE scratch_collector(const scratch_collector&) noexcept			  = delete;
+		NIHILUS_FORCE_INLINE scratch_collector& operator=(scratch_collector&&) noexcept	  = delete;
+		NIHILUS_FORCE_INLINE scratch_collector(scratch_collector&&) noexcept				  = delete;
+		using base_type																		  = base_type_new;
+
+		NIHILUS_FORCE_INLINE static constexpr uint64_t scratch_bytes() {
+			if constexpr (triple_input<base_type>) {
+				return scratch_bytes<kernel_traits<base_type::krn_type, base_type, typename base_type::input_type01, typename base_type::input_type02,
+					typename base_type::input_type03>>();
+			} else if constexpr (double_input<base_type>) {
+				return scratch_bytes<kernel_traits<base_type::krn_type, base_type, typename base_type::input_type01, typename base_type::input_type02>>();
+			} else if constexpr (single_input<base_type>) {
+				return scratch_bytes<kernel_traits<base_type::krn_type, base_type, typename base_type::input_type01>>();
+			} else {
+				return 0;
+			}
+		}
+
+		template<typename kernel_traits_type> NIHILUS_FORCE_INLINE static constexpr uint64_t scratch_bytes() {
+			if constexpr (requires { kernel_traits_type::scratch_bytes; }) {
+				return kernel_traits_type::scratch_bytes;
+			} else {
+				return 0;
+			}
+		}
+
+		template<uint64_t size> NIHILUS_FORCE_INLINE constexpr static void impl(array<uint64_t, size>& values) {
+			values[static_cast<uint64_t>(base_type::type)] = scratch_bytes();
+		}
+	};
+
+	// Scratch each worker needs, from the kernel_traits of every op in the prefill and decode graphs. Arenas are reset per op, so a worker needs
+	// the largest single op's temporaries, not their sum. The per-thread stride is page-rounded so each slice can live on its worker's node.
+	template<model_config config> struct scratch_plan {
+		using op_type_type = op_type_type_t<config>;
+		static constexpr uint64_t op_count{ static_cast<uint64_t>(op_type_type::count) };
+
+		template<model_config graph_config> NIHILUS_FORCE_INLINE static constexpr array<uint64_t, op_count> collect() {
+			array<uint64_t, op_count> return_value{};
+			get_core_traits_config_base_t<graph_config>::template impl_constexpr<scratch_collector>(return_value);
+			return return_value;
+		}
+
+		static constexpr array<uint64_t, op_count> op_bytes{ [] {
+			array<uint64_t, op_count> return_value{ collect<config>() };
+			const array<uint64_t, op_count> decode_bytes{ collect<decode_config<config>>() };
+			for (uint64_t x = 0; x < op_count; ++x) {
+				return_value[x] = std::max(return_value[x], decode_bytes[x]);
+			}
+			return return_value;
+		}() };
+
+		static constexpr uint64_t bytes_per_thread{ [] {
+			uint64_t return_value{};
+			for (uint64_t x = 0; x < op_count; ++x) {
+				return_value = std::max(return_value, op_bytes[x]);
+			}
+			return roundUpToMultiple(return_value, uint64_t{ 4096 });
+		}() };
+	};
+
+}
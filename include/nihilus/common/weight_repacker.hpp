@@ -0,0 +1,449 @@
+/*
+Copyright (c) 2025 RealTimeChris (Chris M.)
+
+This file is part of software offered under a restricted-use license to a designated Licensee,
+whose identity is confirmed in writing by the Author.
+
+License Terms (Summary):
+- Exclusive, non-transferable license for internal use only.
+- Redistribution, sublicensing, or public disclosure is prohibited without written consent.
+- Full ownership remains with the Author.
+- License may terminate if unused for [X months], if materially breached, or by mutual agreement.
+- No warranty is provided, express or implied.
+
+Full license terms are provided in the LICENSE file distributed with this software.
+
+Signed,
+RealTimeChris (Chris M.)
+2025
+*/
+
+#pragma once
+
+#include <nihilus/common/memory_planner.hpp>
+#include <nihilus/common/core_traits.hpp>
+#include <nihilus/common/data_types.hpp>
+#include <nihilus/common/common.hpp>
+#include <nihilus/common/array.hpp>
+#include <nihilus/cpu/cpu_arch.hpp>
+#include <cstring>
+#include <limits>
+#include <atomic>
+#include <vector>
+
+namespace nihilus {
+
+	template<weight_layout layout> struct weight_layout_traits {
+		static constexpr uint64_t row_count{ 1 };
+		static constexpr uint64_t interleave_bytes{ Q_SIZE };
+	};
+
+	template<> struct weight_layout_traits<weight_layout::interleaved_x4> {
+		static constexpr uint64_t row_count{ 4 };
+		static constexpr uint64_t interleave_bytes{ 8 };
+	};
+
+	template<> struct weight_layout_traits<weight_layout::interleaved_x8> {
+		static constexpr uint64_t row_count{ 8 };
+		static constexpr uint64_t interleave_bytes{ 8 };
+	};
+
+	NIHILUS_FORCE_INLINE constexpr uint64_t weight_layout_rows(weight_layout layout) {
+		switch (layout) {
+			case weight_layout::interleaved_x4:
+				return weight_layout_traits<weight_layout::interleaved_x4>::row_count;
+			case weight_layout::interleaved_x8:
+				return weight_layout_traits<weight_layout::interleaved_x8>::row_count;
+			default:
+				return 1;
+		}
+	}
+
+	struct weight_repack_traits {
+		weight_layout layout{};
+		// Pinned weights are read by something other than a q8_0 mul_mat and must stay in GGUF order.
+		bool pinned{};
+		bool per_block{};
+		uint64_t rows{};
+		uint64_t blocks_per_row{};
+		uint64_t bytes{};
+	};
+
+	template<typename base_type_new> struct weight_layout_collector {
+		NIHILUS_FORCE_INLINE weight_layout_collector() noexcept										  = default;
+		NIHILUS_FORCE_INLINE weight_layout_collector& operator=(const weight_layout_collector&) noexcept = delete;
+		NIHILUS_FORCE_INLINE weight_layout_collector(const weight_layout_collector&) noexcept			  = delete;
+		NIHILUS_FORCE_INLINE weight_layout_collector& operator=(weight_layout_collector&&) noexcept	  = delete;
+		NIHILUS_FORCE_INLINE weight_layout_collector(weight_layout_collector&&) noexcept				  = delete;
+		using base_type																				  = base_type_new;
+
+		NIHILUS_FORCE_INLINE static constexpr weight_layout kernel_layout() {
+			if constexpr (base_type::krn_type == kernel_type::mul_mat && double_input<base_type>) {
+				if constexpr (std::is_same_v<typename base_type::input_type01::output_type, block_q8_0<half>>) {
+					// Every layout instantiation of a kernel prefers the same one; row_major is the instantiation every kernel accepts.
+					using kernel_type_new = kernel_dispatcher_impl<cpu_arch_index, kernel_type::mul_mat, typename base_type::transform_type, typename base_type::output_type,
+						laid_out_weight<block_q8_0<half>, weight_layout::row_major>, typename base_type::input_type02::output_type>;
+					return kernel_type_new::preferred_layout;
+				} else {
+					return weight_layout::row_major;
+				}
+			} else {
+				return weight_layout::row_major;
+			}
+		}
+
+		template<typename input_type> NIHILUS_FORCE_INLINE static constexpr void record(weight_repack_traits& value, bool first_input) {
+			constexpr weight_layout layout{ kernel_layout() };
+			if (!first_input || layout == weight_layout::row_major) {
+				value.pinned = true;
+				return;
+			}
+			value.layout		 = layout;
+			value.per_block		 = input_type::alc_type == alloc_type::per_block_alloc;
+			value.rows			 = input_type::dims[1];
+			value.blocks_per_row = input_type::dims[0] / Q_SIZE;
+			value.bytes			 = input_type::total_required_bytes;
+		}
+
+		template<uint64_t size> NIHILUS_FORCE_INLINE constexpr static void impl(array<weight_repack_traits, size>& values) {
+			if constexpr (requires { typename base_type::input_type01; }) {
+				if constexpr (is_weight_op(base_type::input_type01::type)) {
+					record<typename base_type::input_type01>(values[static_cast<uint64_t>(base_type::input_type01::type)], true);
+				}
+			}
+			if constexpr (requires { typename base_type::input_type02; }) {
+				if constexpr (is_weight_op(base_type::input_type02::type)) {
+					record<typename base_type::input_type02>(values[static_cast<uint64_t>(base_type::input_type02::type)], false);
+				}
+			}
+			if constexpr (requires { typename base_type::input_type03; }) {
+				if constexpr (is_weight_op(base_type::input_type03::type)) {
+					record<typename base_type::input_type03>(values[static_cast<uint64_t>(base_type::input_type03::type)], false);
+				}
+			}
+		}
+	};
+
+	// Which weights get rewritten at load time, and into what; decided by the mul_mat kernels compiled for this cpu_arch_index.
+	template<model_config config> struct weight_layout_plan {
+		using op_type_type		= op_type_type_t<config>;
+		using model_traits_type = model_traits<config.arch, config.model_size, config.model_generation>;
+		static constexpr uint64_t op_count{ static_cast<uint64_t>(op_type_type::count) };
+
+		static constexpr array<weight_repack_traits, op_count> traits{ [] {
+			array<weight_repack_traits, op_count> return_value{};
+			get_core_traits_config_base_t<config>::template impl_constexpr<weight_layout_collector>(return_value);
+			for (uint64_t x = 0; x < op_count; ++x) {
+				if (return_value[x].pinned || return_value[x].rows % weight_layout_rows(return_value[x].layout) != 0) {
+					return_value[x].layout = weight_layout::row_major;
+				}
+			}
+			// A tied output projection is the embedding table itself, which the embedding lookup needs in GGUF order; result_output then runs the
+			// row_major instantiation of its mul_mat kernel (see mul_mat_operand).
+			if constexpr (model_traits_type::tied_embeddings) {
+				return_value[static_cast<uint64_t>(op_type_type::output_weight)].layout = weight_layout::row_major;
+			}
+			return return_value;
+		}() };
+
+		NIHILUS_FORCE_INLINE static constexpr bool repacked(uint64_t op) {
+			return op < op_count && traits[op].layout != weight_layout::row_major;
+		}
+
+		static constexpr uint64_t repacked_bytes{ [] {
+			uint64_t return_value{};
+			for (uint64_t x = 0; x < op_count; ++x) {
+				if (repacked(x)) {
+					return_value += roundUpToMultiple(traits[x].bytes, cpu_alignment) * (traits[x].per_block ? model_traits_type::block_count : 1);
+				}
+			}
+			return return_value;
+		}() };
+	};
+
+	// The first operand type a mul_mat kernel is selected by. q8_0 weights carry the layout weight_layout_plan gave them, so the kernel that reads a
+	// weight is always the one for the layout it is stored in; every other operand is just its element type.
+	template<model_config config, typename input_type> struct mul_mat_operand {
+		using type = typename input_type::output_type;
+	};
+
+	template<model_config config, typename input_type>
+		requires(is_weight_op(input_type::type) && std::is_same_v<typename input_type::output_type, block_q8_0<half>>)
+	struct mul_mat_operand<config, input_type> {
+		using type = laid_out_weight<block_q8_0<half>, weight_layout_plan<config>::traits[static_cast<uint64_t>(input_type::type)].layout>;
+	};
+
+	template<model_config config, typename input_type> using mul_mat_operand_t = typename mul_mat_operand<config, input_type>::type;
+
+	// Slot of every repacked weight in weight memory, in memory_plan::weight_sequence order: layer 0's attn_q, attn_k, attn_v, attn_output,
+	// ffn_gate, ffn_up, ffn_down, then layer 1's, and so on. A pass then reads the repacked weights as one forward sweep, rather than jumping
+	// between per-op runs of every layer in whatever order the GGUF listed its tensors. With a read_alignment (the direct-read path), every weight
+	// the model stores gets a slot in the same order, one read_alignment larger than the weight, so an aligned read of the span around the tensor
+	// lands inside it; the tensor then starts at its file offset modulo read_alignment into the slot.
+	template<model_config config, uint64_t read_alignment = 0> struct weight_memory_layout {
+		using plan_type			= memory_plan<config>;
+		using layout_plan_type	= weight_layout_plan<config>;
+		using model_traits_type = model_traits<config.arch, config.model_size, config.model_generation>;
+		static constexpr uint64_t op_count{ layout_plan_type::op_count };
+
+		// A tied output_weight that is not repacked reads the embedding table and needs no storage of its own.
+		NIHILUS_FORCE_INLINE static constexpr bool owns(uint64_t op) {
+			if constexpr (read_alignment == 0) {
+				return layout_plan_type::repacked(op);
+			} else {
+				return layout_plan_type::repacked(op) ||
+					(is_weight_op(op) && plan_type::traits[op].bytes > 0 && !(model_traits_type::tied_embeddings && op == static_cast<uint64_t>(llama_op_types::output_weight)));
+			}
+		}
+
+		NIHILUS_FORCE_INLINE static constexpr uint64_t slot_bytes(uint64_t op) {
+			if constexpr (read_alignment == 0) {
+				return owns(op) ? roundUpToMultiple(layout_plan_type::traits[op].bytes, cpu_alignment) : 0;
+			} else {
+				const uint64_t bytes{ layout_plan_type::repacked(op) ? std::max(plan_type::traits[op].bytes, layout_plan_type::traits[op].bytes) : plan_type::traits[op].bytes };
+				return owns(op) ? roundUpToMultiple(bytes, read_alignment) + read_alignment : 0;
+			}
+		}
+
+		struct section_bytes {
+			uint64_t leading{};
+			uint64_t layer{};
+		};
+
+		static constexpr section_bytes sections{ [] {
+			section_bytes return_value{};
+			for (uint64_t x = 0; x < plan_type::weight_sequence.leading_count; ++x) {
+				return_value.leading += slot_bytes(plan_type::weight_sequence.leading[x]);
+			}
+			for (uint64_t x = 0; x < plan_type::weight_sequence.per_block_count; ++x) {
+				return_value.layer += slot_bytes(plan_type::weight_sequence.per_block[x]);
+			}
+			return return_value;
+		}() };
+
+		// Leading and trailing weights hold absolute offsets; per-block weights hold their offset within a layer's run.
+		static constexpr array<uint64_t, op_count> op_offsets{ [] {
+			array<uint64_t, op_count> return_value{};
+			uint64_t offset{};
+			for (uint64_t x = 0; x < plan_type::weight_sequence.leading_count; ++x) {
+				return_value[plan_type::weight_sequence.leading[x]] = offset;
+				offset += slot_bytes(plan_type::weight_sequence.leading[x]);
+			}
+			for (uint64_t x = 0, layer_offset = 0; x < plan_type::weight_sequence.per_block_count; ++x) {
+				return_value[plan_type::weight_sequence.per_block[x]] = layer_offset;
+				layer_offset += slot_bytes(plan_type::weight_sequence.per_block[x]);
+			}
+			offset += sections.layer * model_traits_type::block_count;
+			for (uint64_t x = 0; x < plan_type::weight_sequence.trailing_count; ++x) {
+				return_value[plan_type::weight_sequence.trailing[x]] = offset;
+				offset += slot_bytes(plan_type::weight_sequence.trailing[x]);
+			}
+			return return_value;
+		}() };
+
+		NIHILUS_FORCE_INLINE static constexpr uint64_t offset(uint64_t op, uint64_t layer) {
+			return plan_type::traits[op].per_block ? sections.leading + layer * sections.layer + op_offsets[op] : op_offsets[op];
+		}
+
+		static constexpr uint64_t total_bytes{ [] {
+			uint64_t return_value{ sections.leading + sections.layer * model_traits_type::block_count };
+			for (uint64_t x = 0; x < plan_type::weight_sequence.trailing_count; ++x) {
+				return_value += slot_bytes(plan_type::weight_sequence.trailing[x]);
+			}
+			return return_value;
+		}() };
+		static_assert(read_alignment > 0 || total_bytes == layout_plan_type::repacked_bytes, "Sorry, but a repacked weight is missing from the execution order!");
+		static_assert(total_bytes == [] {
+			uint64_t return_value{};
+			for (uint64_t x = 0; x < op_count; ++x) {
+				return_value += slot_bytes(x) * (plan_type::traits[x].per_block ? model_traits_type::block_count : 1);
+			}
+			return return_value;
+		}(), "Sorry, but a stored weight is missing from the execution order!");
+	};
+
+	template<typename half_type> struct weight_repacker {
+		using block_type = block_q8_0<half_type>;
+
+		// Bytes of GGUF-ordered input one weight needs; callers bounds-check the source against this before repacking.
+		NIHILUS_FORCE_INLINE static constexpr uint64_t source_bytes(const weight_repack_traits& traits) {
+			return traits.rows * traits.blocks_per_row * sizeof(block_type);
+		}
+
+		// Row groups are the unit of work: group g covers rows [g * rows_per_group, (g + 1) * rows_per_group), and groups never overlap in the output.
+		NIHILUS_FORCE_INLINE static constexpr uint64_t group_count(const weight_repack_traits& traits) {
+			return traits.rows / weight_layout_rows(traits.layout);
+		}
+
+		NIHILUS_FORCE_INLINE static constexpr uint64_t group_bytes(const weight_repack_traits& traits) {
+			return weight_layout_rows(traits.layout) * traits.blocks_per_row * sizeof(block_type);
+		}
+
+		NIHILUS_FORCE_INLINE static void impl(const weight_repack_traits& traits, uint8_t* output, const uint8_t* input) {
+			impl(traits, output, input, 0, group_count(traits));
+		}
+
+		NIHILUS_FORCE_INLINE static void impl(const weight_repack_traits& traits, uint8_t* output, const uint8_t* input, uint64_t group_begin, uint64_t group_end) {
+			switch (traits.layout) {
+				case weight_layout::interleaved_x4:
+					return impl<weight_layout::interleaved_x4>(traits, output, input, group_begin, group_end);
+				case weight_layout::interleaved_x8:
+					return impl<weight_layout::interleaved_x8>(traits, output, input, group_begin, group_end);
+				default:
+					std::memcpy(output + group_begin * group_bytes(traits), input + group_begin * group_bytes(traits), (group_end - group_begin) * group_bytes(traits));
+					return;
+			}
+		}
+
+		template<weight_layout layout>
+		NIHILUS_FORCE_INLINE static void impl(const weight_repack_traits& traits, uint8_t* output, const uint8_t* input, uint64_t group_begin, uint64_t group_end) {
+			static constexpr uint64_t row_count{ weight_layout_traits<layout>::row_count };
+			static constexpr uint64_t interleave_bytes{ weight_layout_traits<layout>::interleave_bytes };
+			using interleaved_type = block_q8_0_interleaved<half_type, row_count>;
+			const block_type* source{ reinterpret_cast<const block_type*>(input) };
+			interleaved_type* destination{ reinterpret_cast<interleaved_type*>(output) };
+			for (uint64_t group = group_begin; group < group_end; ++group) {
+				for (uint64_t block = 0; block < traits.blocks_per_row; ++block) {
+					interleaved_type& current{ destination[group * traits.blocks_per_row + block] };
+					for (uint64_t row = 0; row < row_count; ++row) {
+						const block_type& source_block{ source[(group * row_count + row) * traits.blocks_per_row + block] };
+						current.d[row] = source_block.d;
+						for (uint64_t chunk = 0; chunk < Q_SIZE / interleave_bytes; ++chunk) {
+							std::memcpy(current.qs + (chunk * row_count + row) * interleave_bytes, source_block.qs + chunk * interleave_bytes, interleave_bytes);
+						}
+					}
+				}
+			}
+		}
+	};
+
+	// The parallel half of a weight load. The parser does everything serial first (parsing, bounds checks, claiming repack destinations, binding),
+	// then records the remaining byte-heavy work here as slices of at most slice_bytes. Each pool thread takes a contiguous run of slices covering an
+	// equal share of the bytes, so one large embedding table is split across threads instead of pinning the whole load on whoever drew it.
+	template<typename half_type> struct weight_load_schedule {
+		using repacker_type = weight_repacker<half_type>;
+		static constexpr uint64_t slice_bytes{ 8ull * 1024ull * 1024ull };
+		static constexpr uint64_t touch_stride{ 4096 };
+
+		struct task {
+			const uint8_t* source{};
+			uint8_t* destination{};
+			const weight_repack_traits* traits{};
+			// Row groups for repacks, bytes of source for page-ins.
+			uint64_t begin{};
+			uint64_t end{};
+			uint64_t bytes{};
+			uint64_t stage{};
+		};
+
+		// An aligned read of [offset, offset + length) of the model file into destination, issued by the one thread that owns the reader.
+		struct read_task {
+			uint8_t* destination{};
+			uint64_t offset{};
+			uint64_t length{};
+			uint64_t stage{};
+		};
+
+		// output may equal input, for weights already read into memory the model owns.
+		NIHILUS_FORCE_INLINE void add_repack(const weight_repack_traits& traits, uint8_t* output, const uint8_t* input, uint64_t stage = 0) {
+			const uint64_t groups_per_slice{ std::max(slice_bytes / repacker_type::group_bytes(traits), uint64_t{ 1 }) };
+			const uint64_t group_count{ repacker_type::group_count(traits) };
+			for (uint64_t x = 0; x < group_count; x += groups_per_slice) {
+				const uint64_t end{ std::min(x + groups_per_slice, group_count) };
+				push(task{ input, output, &traits, x, end, (end - x) * repacker_type::group_bytes(traits), stage });
+			}
+		}
+
+		// Faults a zero-copy weight into the page cache ahead of the first forward pass.
+		NIHILUS_FORCE_INLINE void add_page_in(const uint8_t* input, uint64_t size, uint64_t stage = 0) {
+			for (uint64_t x = 0; x < size; x += slice_bytes) {
+				const uint64_t end{ std::min(x + slice_bytes, size) };
+				push(task{ input, nullptr, nullptr, x, end, end - x, stage });
+			}
+		}
+
+		// Reads must be issued through run_reads before any repack of the weight they fill.
+		NIHILUS_FORCE_INLINE void add_read(uint8_t* destination, uint64_t offset, uint64_t length, uint64_t stage = 0) {
+			reads.emplace_back(read_task{ destination, offset, length, stage });
+		}
+
+		NIHILUS_FORCE_INLINE bool empty() const {
+			return tasks.empty() && reads.empty();
+		}
+
+		// Issues the reads of one stage, or of every stage, in the order they were added.
+		template<typename reader_type> NIHILUS_FORCE_INLINE bool run_reads(reader_type& reader, uint64_t stage = std::numeric_limits<uint64_t>::max()) const {
+			for (const read_task& value: reads) {
+				if ((stage == std::numeric_limits<uint64_t>::max() || value.stage == stage) && !reader.read(value.destination, value.offset, value.length)) {
+					return false;
+				}
+			}
+			return true;
+		}
+
+		NIHILUS_FORCE_INLINE void operator()(uint64_t thread_index, uint64_t thread_count) const {
+			for (uint64_t x = 0; x < tasks.size(); ++x) {
+				const uint64_t midpoint{ starts[x] + tasks[x].bytes / 2 };
+				if (midpoint * thread_count / total_bytes == thread_index) {
+					run(tasks[x]);
+				}
+			}
+		}
+
+		// The serve-while-loading path: one thread works through the stages in order, reading then repacking each, and publishing in resident how
+		// many are complete. Stops at the first failed read, leaving the stages from there on unpublished.
+		template<typename reader_type> NIHILUS_FORCE_INLINE bool run_in_order(std::atomic<uint64_t>& resident, uint64_t stage_count, reader_type& reader) const {
+			for (uint64_t stage = 0; stage < stage_count; ++stage) {
+				if (!run_reads(reader, stage)) {
+					return false;
+				}
+				for (uint64_t x = 0; x < tasks.size(); ++x) {
+					if (tasks[x].stage == stage) {
+						run(tasks[x]);
+					}
+				}
+				resident.store(stage + 1, std::memory_order_release);
+				resident.notify_all();
+			}
+			return true;
+		}
+
+	  protected:
+		std::vector<task> tasks{};
+		std::vector<read_task> reads{};
+		std::vector<uint64_t> starts{};
+		uint64_t total_bytes{};
+
+		NIHILUS_FORCE_INLINE void push(const task& value) {
+			starts.emplace_back(total_bytes);
+			tasks.emplace_back(value);
+			total_bytes += value.bytes;
+		}
+
+		NIHILUS_FORCE_INLINE static void run(const task& value) {
+			if (value.traits && value.destination == value.source) {
+				// In place: every row group occupies the same bytes before and after, so each is staged through scratch and written back.
+				thread_local std::vector<uint8_t> scratch{};
+				const uint64_t group_bytes{ repacker_type::group_bytes(*value.traits) };
+				scratch.resize(group_bytes);
+				for (uint64_t x = value.begin; x < value.end; ++x) {
+					std::memcpy(scratch.data(), value.source + x * group_bytes, group_bytes);
+					repacker_type::impl(*value.traits, value.destination + x * group_bytes, scratch.data(), 0, 1);
+				}
+				return;
+			}
+			if (value.traits) {
+				repacker_type::impl(*value.traits, value.destination, value.source, value.begin, value.end);
+				return;
+			}
+			uint8_t accumulator{};
+			for (uint64_t x = value.begin; x < value.end; x += touch_stride) {
+				accumulator ^= value.source[x];
+			}
+			sink.store(accumulator, std::memory_order_relaxed);
+		}
+
+		inline static std::atomic<uint8_t> sink{};
+	};
+
+}
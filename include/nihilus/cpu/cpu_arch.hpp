@@ -20,11 +20,15 @@ RealTimeChris (Chris M.)
 
 #pragma once
 
+#include <nihilus/common/attention_mask.hpp>
 #include <nihilus/cpu/simd/avx_2.hpp>
 #include <nihilus/cpu/simd/avx_512.hpp>
 
 #include <nihilus/cpu/simd/arm_neon.hpp>
 #include <nihilus/cpu/simd/arm_sve2.hpp>
+#include <algorithm>
+#include <limits>
+#include <cmath>
 
 namespace nihilus {
 
@@ -60,12 +64,18 @@ namespace nihilus {
 		}
 	};
 
-	template<typename transform_type> struct kernel_dispatcher_impl<0, kernel_type::mul_mat, transform_type, float, block_q8_0<half>, float> {
+	template<typename transform_type, weight_layout layout>
+	struct kernel_dispatcher_impl<0, kernel_type::mul_mat, transform_type, float, laid_out_weight<block_q8_0<half>, layout>, float> {
+		static constexpr weight_layout preferred_layout{ weight_layout::row_major };
+		static_assert(layout == weight_layout::row_major || layout == preferred_layout, "Sorry, but this mul_mat kernel does not read that weight layout!");
+
 		NIHILUS_FORCE_INLINE static void impl(uint64_t count, float*, const block_q8_0<half>*, const float*) {
 		}
 	};
 
 	template<typename transform_type> struct kernel_dispatcher_impl<0, kernel_type::mul_mat, transform_type, float, int16_t, float> {
+		static constexpr weight_layout preferred_layout{ weight_layout::row_major };
+
 		NIHILUS_FORCE_INLINE static void impl(uint64_t count, float*, const int16_t*, const float*) {
 		}
 	};
@@ -86,12 +96,37 @@ namespace nihilus {
 	};
 
 	template<typename transform_type> struct kernel_dispatcher_impl<0, kernel_type::mul_mat, transform_type, float, float, float> {
+		static constexpr weight_layout preferred_layout{ weight_layout::row_major };
+
 		NIHILUS_FORCE_INLINE static void impl(uint64_t count, float*, const float*, const float*) {
 		}
 	};
 
-	template<typename transform_type> struct kernel_dispatcher_impl<0, kernel_type::softmax, transform_type, float, float, float> {
-		NIHILUS_FORCE_INLINE static void impl(uint64_t count, float*, const float*, const float*) {
+	template<typename transform_type> struct kernel_dispatcher_impl<0, kernel_type::softmax, transform_type, float, float> {
+		template<typename mask_type> NIHILUS_FORCE_INLINE static void impl(uint64_t count, float* output, const float* input01, uint64_t row_length, const mask_type& mask) {
+			const uint64_t row_count{ count / row_length };
+			for (uint64_t x = 0; x < row_count; ++x) {
+				const visible_range range{ mask.range_for_row(x) };
+				const uint64_t end{ std::min(range.end, row_length) };
+				const uint64_t begin{ std::min(range.begin, end) };
+				const float* input_row{ input01 + x * row_length };
+				float* output_row{ output + x * row_length };
+				float max_value{ -std::numeric_limits<float>::infinity() };
+				for (uint64_t y = begin; y < end; ++y) {
+					max_value = std::max(max_value, input_row[y]);
+				}
+				float sum{};
+				for (uint64_t y = begin; y < end; ++y) {
+					output_row[y] = std::exp(input_row[y] - max_value);
+					sum += output_row[y];
+				}
+				const float inverse_sum{ sum > 0.0f ? 1.0f / sum : 0.0f };
+				for (uint64_t y = begin; y < end; ++y) {
+					output_row[y] *= inverse_sum;
+				}
+				std::fill(output_row, output_row + begin, 0.0f);
+				std::fill(output_row + end, output_row + row_length, 0.0f);
+			}
 		}
 	};
 
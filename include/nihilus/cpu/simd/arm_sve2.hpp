@@ -59,12 +59,18 @@ namespace nihilus {
 		}
 	};
 
-	template<typename transform_type> struct kernel_dispatcher_impl<2, kernel_type::mul_mat, transform_type, float, block_q8_0<half>, float> {
+	template<typename transform_type, weight_layout layout>
+	struct kernel_dispatcher_impl<2, kernel_type::mul_mat, transform_type, float, laid_out_weight<block_q8_0<half>, layout>, float> {
+		static constexpr weight_layout preferred_layout{ weight_layout::interleaved_x8 };
+		static_assert(layout == weight_layout::row_major || layout == preferred_layout, "Sorry, but this mul_mat kernel does not read that weight layout!");
+
 		NIHILUS_FORCE_INLINE static void impl(uint64_t, float*, const block_q8_0<half>*, const float*) {
 		}
 	};
 
 	template<typename transform_type> struct kernel_dispatcher_impl<2, kernel_type::mul_mat, transform_type, float, int16_t, float> {
+		static constexpr weight_layout preferred_layout{ weight_layout::row_major };
+
 		NIHILUS_FORCE_INLINE static void impl(uint64_t, float*, const int16_t*, const float*) {
 		}
 	};
@@ -85,12 +91,16 @@ namespace nihilus {
 	};
 
 	template<typename transform_type> struct kernel_dispatcher_impl<2, kernel_type::mul_mat, transform_type, float, float, float> {
+		static constexpr weight_layout preferred_layout{ weight_layout::row_major };
+
 		NIHILUS_FORCE_INLINE static void impl(uint64_t, const float*, const float*, float*) {
 		}
 	};
 
-	template<typename transform_type> struct kernel_dispatcher_impl<2, kernel_type::softmax, transform_type, float, float, float> {
-		NIHILUS_FORCE_INLINE static void impl(uint64_t, const float*, const float*, float*) {
+	// No vector version yet; the scalar kernel keeps the mask honoured on this backend.
+	template<typename transform_type> struct kernel_dispatcher_impl<2, kernel_type::softmax, transform_type, float, float> {
+		template<typename mask_type> NIHILUS_FORCE_INLINE static void impl(uint64_t count, float* output, const float* input01, uint64_t row_length, const mask_type& mask) {
+			kernel_dispatcher_impl<0, kernel_type::softmax, transform_type, float, float>::impl(count, output, input01, row_length, mask);
 		}
 	};
 
@@ -19,7 +19,10 @@ RealTimeChris (Chris M.)
 */
 #pragma once
 
+#include <nihilus/common/attention_mask.hpp>
 #include <nihilus/common/common.hpp>
+#include <algorithm>
+#include <limits>
 
 #if defined(NIHILUS_AVX2)
 
@@ -57,12 +60,18 @@ namespace nihilus {
 		}
 	};
 
-	template<typename transform_type> struct kernel_dispatcher_impl<1, kernel_type::mul_mat, transform_type, float, block_q8_0<half>, float> {
+	template<typename transform_type, weight_layout layout>
+	struct kernel_dispatcher_impl<1, kernel_type::mul_mat, transform_type, float, laid_out_weight<block_q8_0<half>, layout>, float> {
+		static constexpr weight_layout preferred_layout{ weight_layout::interleaved_x4 };
+		static_assert(layout == weight_layout::row_major || layout == preferred_layout, "Sorry, but this mul_mat kernel does not read that weight layout!");
+
 		NIHILUS_FORCE_INLINE static void impl(uint64_t count, float*, const block_q8_0<half>*, const float*) {
 		}
 	};
 
 	template<typename transform_type> struct kernel_dispatcher_impl<1, kernel_type::mul_mat, transform_type, float, int16_t, float> {
+		static constexpr weight_layout preferred_layout{ weight_layout::row_major };
+
 		NIHILUS_FORCE_INLINE static void impl(uint64_t count, float*, const int16_t*, const float*) {
 		}
 	};
@@ -83,52 +92,75 @@ namespace nihilus {
 	};
 
 	template<typename transform_type> struct kernel_dispatcher_impl<1, kernel_type::mul_mat, transform_type, float, float, float> {
+		static constexpr weight_layout preferred_layout{ weight_layout::row_major };
+
 		NIHILUS_FORCE_INLINE static void impl(uint64_t count, float*, const float*, const float*) {
 		}
 	};
 
-	template<typename transform_type> struct kernel_dispatcher_impl<1, kernel_type::softmax, transform_type, float, float, float> {
-		NIHILUS_FORCE_INLINE static __m256 fast_exp_ps(__m256 x) {
-			const __m256 a = _mm256_set1_ps(12102203.0f / 16777216.0f);
-			const __m256 b = _mm256_set1_ps(1064872507.0f / 16777216.0f);
-			x			   = _mm256_min_ps(x, _mm256_set1_ps(88.3762626647950f));
-			x			   = _mm256_max_ps(x, _mm256_set1_ps(-88.3762626647950f));
-			__m256 tmp	   = _mm256_fmadd_ps(x, a, b);
-			return _mm256_castsi256_ps(_mm256_cvttps_epi32(tmp));
-		}
-
-		NIHILUS_FORCE_INLINE static void impl(uint64_t count, float* output, const float* input01, const float* input02) {
-			/*
-			constexpr size_t simd_width = 8;
-			const size_t simd_count		= count / simd_width;
-			__m256 max_vec = _mm256_set1_ps(-std::numeric_limits<float>::max());
-			for (size_t i = 0; i < simd_count; ++i) {
-				__m256 logits = _mm256_load_ps(input01 + i * simd_width);
-				__m256 mask	  = _mm256_load_ps(input02 + i * simd_width);
-				max_vec		  = _mm256_max_ps(max_vec, _mm256_blendv_ps(_mm256_set1_ps(-std::numeric_limits<float>::max()), logits, mask));
+	template<typename transform_type> struct kernel_dispatcher_impl<1, kernel_type::softmax, transform_type, float, float> {
+		NIHILUS_FORCE_INLINE static __m256 exp_ps(__m256 x) {
+			x		 = _mm256_min_ps(x, _mm256_set1_ps(88.3762626647950f));
+			x		 = _mm256_max_ps(x, _mm256_set1_ps(-87.3365478515625f));
+			__m256 n = _mm256_round_ps(_mm256_mul_ps(x, _mm256_set1_ps(1.44269504088896341f)), _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+			__m256 r = _mm256_fnmadd_ps(n, _mm256_set1_ps(0.693359375f), x);
+			r		 = _mm256_fnmadd_ps(n, _mm256_set1_ps(-2.12194440e-4f), r);
+			__m256 p = _mm256_set1_ps(1.9875691500e-4f);
+			p		 = _mm256_fmadd_ps(p, r, _mm256_set1_ps(1.3981999507e-3f));
+			p		 = _mm256_fmadd_ps(p, r, _mm256_set1_ps(8.3334519073e-3f));
+			p		 = _mm256_fmadd_ps(p, r, _mm256_set1_ps(4.1665795894e-2f));
+			p		 = _mm256_fmadd_ps(p, r, _mm256_set1_ps(1.6666665459e-1f));
+			p		 = _mm256_fmadd_ps(p, r, _mm256_set1_ps(5.0000001201e-1f));
+			p		 = _mm256_fmadd_ps(p, _mm256_mul_ps(r, r), _mm256_add_ps(r, _mm256_set1_ps(1.0f)));
+			__m256i e = _mm256_slli_epi32(_mm256_add_epi32(_mm256_cvtps_epi32(n), _mm256_set1_epi32(127)), 23);
+			return _mm256_mul_ps(p, _mm256_castsi256_ps(e));
+		}
+
+		// All-ones lanes for kv indices inside [begin, end), built from the lane indices so no mask tensor is ever loaded. Doubles as the
+		// maskload/maskstore mask, so a row whose visible span is not a multiple of 8 never touches memory outside it.
+		NIHILUS_FORCE_INLINE static __m256i lane_mask(uint64_t base, uint64_t begin, uint64_t end) {
+			const __m256i index = _mm256_add_epi32(_mm256_set1_epi32(static_cast<int32_t>(base)), _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7));
+			const __m256i below = _mm256_cmpgt_epi32(_mm256_set1_epi32(static_cast<int32_t>(begin)), index);
+			const __m256i above = _mm256_cmpgt_epi32(_mm256_set1_epi32(static_cast<int32_t>(end)), index);
+			return _mm256_andnot_si256(below, above);
+		}
+
+		template<typename mask_type> NIHILUS_FORCE_INLINE static void impl(uint64_t count, float* output, const float* input01, uint64_t row_length, const mask_type& mask) {
+			static constexpr uint64_t simd_width = 8;
+			const uint64_t row_count{ count / row_length };
+			const __m256 lowest{ _mm256_set1_ps(-std::numeric_limits<float>::infinity()) };
+			for (uint64_t x = 0; x < row_count; ++x) {
+				const visible_range range{ mask.range_for_row(x) };
+				const uint64_t end{ std::min(range.end, row_length) };
+				const uint64_t begin{ std::min(range.begin, end) };
+				const uint64_t first{ begin & ~(simd_width - 1) };
+				const float* input_row{ input01 + x * row_length };
+				float* output_row{ output + x * row_length };
+
+				__m256 max_vec = lowest;
+				for (uint64_t y = first; y < end; y += simd_width) {
+					const __m256i lanes = lane_mask(y, begin, end);
+					max_vec				= _mm256_max_ps(max_vec, _mm256_blendv_ps(lowest, _mm256_maskload_ps(input_row + y, lanes), _mm256_castsi256_ps(lanes)));
+				}
+				const __m256 max_bcast = _mm256_set1_ps(horizontal_max(max_vec));
+
+				__m256 sum_vec = _mm256_setzero_ps();
+				for (uint64_t y = first; y < end; y += simd_width) {
+					const __m256i lanes = lane_mask(y, begin, end);
+					const __m256 exps	= _mm256_and_ps(exp_ps(_mm256_sub_ps(_mm256_maskload_ps(input_row + y, lanes), max_bcast)), _mm256_castsi256_ps(lanes));
+					_mm256_maskstore_ps(output_row + y, lanes, exps);
+					sum_vec = _mm256_add_ps(sum_vec, exps);
+				}
+
+				const float sum{ horizontal_sum(sum_vec) };
+				const __m256 inverse_sum = _mm256_set1_ps(sum > 0.0f ? 1.0f / sum : 0.0f);
+				for (uint64_t y = first; y < end; y += simd_width) {
+					const __m256i lanes = lane_mask(y, begin, end);
+					_mm256_maskstore_ps(output_row + y, lanes, _mm256_mul_ps(_mm256_maskload_ps(output_row + y, lanes), inverse_sum));
+				}
+				std::fill(output_row, output_row + begin, 0.0f);
+				std::fill(output_row + end, output_row + row_length, 0.0f);
 			}
-			float max_val = horizontal_max(max_vec);
-
-			__m256 sum_vec	 = _mm256_setzero_ps();
-			__m256 max_bcast = _mm256_set1_ps(max_val);
-			for (size_t i = 0; i < simd_count; ++i) {
-				__m256 logits  = _mm256_load_ps(input01 + i * simd_width);
-				__m256 shifted = _mm256_sub_ps(logits, max_bcast);
-				__m256 exps	   = fast_exp_ps(shifted);
-				__m256 mask	   = _mm256_load_ps(input02 + i * simd_width);
-				exps		   = _mm256_and_ps(exps, mask);
-				_mm256_stream_ps(output + i * simd_width, exps);
-				sum_vec = _mm256_add_ps(sum_vec, exps);
-			}
-
-			__m256 inv_sum = _mm256_set1_ps(1.0f / horizontal_sum(sum_vec));
-			for (size_t i = 0; i < simd_count; ++i) {
-				__m256 vals = _mm256_load_ps(output + i * simd_width);
-				_mm256_store_ps(output + i * simd_width, _mm256_mul_ps(vals, inv_sum));
-			}
-
-			if (count % simd_width) {
-			}*/
 		}
 
 		NIHILUS_FORCE_INLINE static float horizontal_max(__m256 vec) {
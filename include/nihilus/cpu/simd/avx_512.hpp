@@ -1,6 +1,9 @@
 #pragma once
 
+#include <nihilus/common/attention_mask.hpp>
 #include <nihilus/common/common.hpp>
+#include <algorithm>
+#include <limits>
 
 #if defined(NIHILUS_AVX512)
 
@@ -38,12 +41,18 @@ namespace nihilus {
 		}
 	};
 
-	template<typename transform_type> struct kernel_dispatcher_impl<2, kernel_type::mul_mat, transform_type, float, block_q8_0<half>, float> {
+	template<typename transform_type, weight_layout layout>
+	struct kernel_dispatcher_impl<2, kernel_type::mul_mat, transform_type, float, laid_out_weight<block_q8_0<half>, layout>, float> {
+		static constexpr weight_layout preferred_layout{ weight_layout::interleaved_x8 };
+		static_assert(layout == weight_layout::row_major || layout == preferred_layout, "Sorry, but this mul_mat kernel does not read that weight layout!");
+
 		NIHILUS_FORCE_INLINE static void impl(uint64_t count, float*, const block_q8_0<half>*, const float*) {
 		}
 	};
 
 	template<typename transform_type> struct kernel_dispatcher_impl<2, kernel_type::mul_mat, transform_type, float, int26_t, float> {
+		static constexpr weight_layout preferred_layout{ weight_layout::row_major };
+
 		NIHILUS_FORCE_INLINE static void impl(uint64_t count, float*, const int26_t*, const float*) {
 		}
 	};
@@ -64,12 +73,71 @@ namespace nihilus {
 	};
 
 	template<typename transform_type> struct kernel_dispatcher_impl<2, kernel_type::mul_mat, transform_type, float, float, float> {
+		static constexpr weight_layout preferred_layout{ weight_layout::row_major };
+
 		NIHILUS_FORCE_INLINE static void impl(uint64_t count, float*, const float*, const float*) {
 		}
 	};
 
-	template<typename transform_type> struct kernel_dispatcher_impl<2, kernel_type::softmax, transform_type, float, float, float> {
-		NIHILUS_FORCE_INLINE static void impl(uint64_t count, float* output, const float* input02, const float* input02) {
+	template<typename transform_type> struct kernel_dispatcher_impl<2, kernel_type::softmax, transform_type, float, float> {
+		NIHILUS_FORCE_INLINE static __m512 exp_ps(__m512 x) {
+			x		 = _mm512_min_ps(x, _mm512_set1_ps(88.3762626647950f));
+			x		 = _mm512_max_ps(x, _mm512_set1_ps(-87.3365478515625f));
+			__m512 n = _mm512_roundscale_ps(_mm512_mul_ps(x, _mm512_set1_ps(1.44269504088896341f)), _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+			__m512 r = _mm512_fnmadd_ps(n, _mm512_set1_ps(0.693359375f), x);
+			r		 = _mm512_fnmadd_ps(n, _mm512_set1_ps(-2.12194440e-4f), r);
+			__m512 p = _mm512_set1_ps(1.9875691500e-4f);
+			p		 = _mm512_fmadd_ps(p, r, _mm512_set1_ps(1.3981999507e-3f));
+			p		 = _mm512_fmadd_ps(p, r, _mm512_set1_ps(8.3334519073e-3f));
+			p		 = _mm512_fmadd_ps(p, r, _mm512_set1_ps(4.1665795894e-2f));
+			p		 = _mm512_fmadd_ps(p, r, _mm512_set1_ps(1.6666665459e-1f));
+			p		 = _mm512_fmadd_ps(p, r, _mm512_set1_ps(5.0000001201e-1f));
+			p		 = _mm512_fmadd_ps(p, _mm512_mul_ps(r, r), _mm512_add_ps(r, _mm512_set1_ps(1.0f)));
+			return _mm512_scalef_ps(p, n);
+		}
+
+		// Lanes of [base, base + 16) inside [begin, end); masked loads and stores never touch memory outside the visible span.
+		NIHILUS_FORCE_INLINE static __mmask16 lane_mask(uint64_t base, uint64_t begin, uint64_t end) {
+			const uint64_t first{ begin > base ? begin - base : 0 };
+			const uint64_t last{ std::min(end - base, uint64_t{ 16 }) };
+			return static_cast<__mmask16>(((1u << last) - 1u) & ~((1u << first) - 1u));
+		}
+
+		template<typename mask_type> NIHILUS_FORCE_INLINE static void impl(uint64_t count, float* output, const float* input01, uint64_t row_length, const mask_type& mask) {
+			static constexpr uint64_t simd_width = 16;
+			const uint64_t row_count{ count / row_length };
+			const __m512 lowest{ _mm512_set1_ps(-std::numeric_limits<float>::infinity()) };
+			for (uint64_t x = 0; x < row_count; ++x) {
+				const visible_range range{ mask.range_for_row(x) };
+				const uint64_t end{ std::min(range.end, row_length) };
+				const uint64_t begin{ std::min(range.begin, end) };
+				const uint64_t first{ begin & ~(simd_width - 1) };
+				const float* input_row{ input01 + x * row_length };
+				float* output_row{ output + x * row_length };
+
+				__m512 max_vec = lowest;
+				for (uint64_t y = first; y < end; y += simd_width) {
+					max_vec = _mm512_max_ps(max_vec, _mm512_mask_loadu_ps(lowest, lane_mask(y, begin, end), input_row + y));
+				}
+				const __m512 max_bcast = _mm512_set1_ps(_mm512_reduce_max_ps(max_vec));
+
+				__m512 sum_vec = _mm512_setzero_ps();
+				for (uint64_t y = first; y < end; y += simd_width) {
+					const __mmask16 lanes = lane_mask(y, begin, end);
+					const __m512 exps	  = _mm512_maskz_mov_ps(lanes, exp_ps(_mm512_sub_ps(_mm512_maskz_loadu_ps(lanes, input_row + y), max_bcast)));
+					_mm512_mask_storeu_ps(output_row + y, lanes, exps);
+					sum_vec = _mm512_add_ps(sum_vec, exps);
+				}
+
+				const float sum{ _mm512_reduce_add_ps(sum_vec) };
+				const __m512 inverse_sum = _mm512_set1_ps(sum > 0.0f ? 1.0f / sum : 0.0f);
+				for (uint64_t y = first; y < end; y += simd_width) {
+					const __mmask16 lanes = lane_mask(y, begin, end);
+					_mm512_mask_storeu_ps(output_row + y, lanes, _mm512_mul_ps(_mm512_maskz_loadu_ps(lanes, output_row + y), inverse_sum));
+				}
+				std::fill(output_row, output_row + begin, 0.0f);
+				std::fill(output_row + end, output_row + row_length, 0.0f);
+			}
 		}
 	};
 
@@ -21,6 +21,11 @@ RealTimeChris (Chris M.)
 #pragma once
 
 #include <nihilus/common/monolithic_dispatcher.hpp>
+#include <nihilus/common/execution_schedule.hpp>
+#include <nihilus/common/memory_planner.hpp>
+#include <nihilus/common/scratch_arena.hpp>
+#include <nihilus/common/memory_buffer.hpp>
+#include <nihilus/common/numa.hpp>
 #include <nihilus/cpu/cpu_scheduler.hpp>
 #include <nihilus/common/common.hpp>
 #include <nihilus/common/tuple.hpp>
@@ -149,11 +154,13 @@ namespace nihilus {
 			}
 		}
 
-		template<op_type_type current_index = static_cast<op_type_type>(0)> NIHILUS_FORCE_INLINE static constexpr uint64_t impl(uint64_t current_size = 0) {
+		template<op_type_type current_index = static_cast<op_type_type>(0)> NIHILUS_FORCE_INLINE static constexpr uint64_t impl(uint64_t current_size = memory_plan<config>::arena_bytes) {
 			if constexpr (static_cast<uint64_t>(current_index) < static_cast<uint64_t>(op_type_type::count)) {
 				using core_traits_type = core_traits<config, current_index>;
 				using output_type	   = core_traits_type::output_type;
-				current_size += core_traits_type::total_required_bytes * get_multiplier<core_traits_type>();
+				if constexpr (!memory_plan<config>::planned[static_cast<uint64_t>(current_index)] && !is_weight_op(current_index)) {
+					current_size += core_traits_type::total_required_bytes * get_multiplier<core_traits_type>();
+				}
 				return impl<static_cast<op_type_type>(static_cast<uint64_t>(current_index) + 1)>(current_size);
 			}
 			return current_size;
@@ -190,27 +197,6 @@ namespace nihilus {
 
 	std::unordered_map<llama_op_types, size_t> depths{};
 
-	template<typename base_type_new> struct execution_planner_constexpr {
-		NIHILUS_FORCE_INLINE execution_planner_constexpr() noexcept												 = default;
-		NIHILUS_FORCE_INLINE execution_planner_constexpr& operator=(const execution_planner_constexpr&) noexcept = delete;
-		NIHILUS_FORCE_INLINE execution_planner_constexpr(const execution_planner_constexpr&) noexcept			 = delete;
-		NIHILUS_FORCE_INLINE execution_planner_constexpr& operator=(execution_planner_constexpr&&) noexcept		 = delete;
-		NIHILUS_FORCE_INLINE execution_planner_constexpr(execution_planner_constexpr&&) noexcept				 = delete;
-		using output_type																						 = base_type_new::output_type;
-		using base_type																							 = base_type_new;
-		using op_type_type																						 = base_type_new::model_traits_type::op_type_type;
-		NIHILUS_FORCE_INLINE constexpr static void impl(uint64_t& count_new, layer_op_type op_type) {
-			count_new += base_type::layer_type == op_type;
-		}
-		template<uint64_t size> NIHILUS_FORCE_INLINE constexpr static void impl(array<op_type_type, size>& value, layer_op_type op_type, uint64_t& current_index) {
-			if (base_type::layer_type == op_type && base_type::krn_type != kernel_type::permute && base_type::krn_type != kernel_type::reshape &&
-				base_type::krn_type != kernel_type::transpose && base_type::krn_type != kernel_type::view) {
-				value[current_index] = base_type::type;
-				++current_index;
-			}
-		};
-	};
-
 	template<typename base_type> struct memory_mapper {
 		NIHILUS_FORCE_INLINE memory_mapper() noexcept								 = default;
 		NIHILUS_FORCE_INLINE memory_mapper& operator=(const memory_mapper&) noexcept = delete;
@@ -218,14 +204,18 @@ namespace nihilus {
 		NIHILUS_FORCE_INLINE memory_mapper& operator=(memory_mapper&&) noexcept		 = delete;
 		NIHILUS_FORCE_INLINE memory_mapper(memory_mapper&&) noexcept				 = delete;
 		using output_type															 = base_type::output_type;
-		template<typename memory_buffer_type> NIHILUS_FORCE_INLINE static void impl(base_type& core, memory_buffer_type& memory_buffer) {
-			if constexpr (base_type::total_required_bytes > 0) {
-				output_type* ptr = static_cast<output_type*>(memory_buffer.claim_memory(core.total_required_bytes));
+		template<typename memory_buffer_type, typename memory_plan_type>
+		NIHILUS_FORCE_INLINE static void impl(base_type& core, memory_buffer_type& memory_buffer, const memory_plan_type&, uint8_t* arena) {
+			if constexpr (memory_plan_type::planned[static_cast<uint64_t>(base_type::type)]) {
+				core.data = reinterpret_cast<output_type*>(arena + memory_plan_type::offsets[static_cast<uint64_t>(base_type::type)]);
+			} else if constexpr (base_type::total_required_bytes > 0 && !is_weight_op(base_type::type)) {
 				if constexpr (array_type<decltype(core.data)>) {
+					uint8_t* ptr = static_cast<uint8_t*>(memory_buffer.claim_memory(core.total_required_bytes * decltype(core.data)::size_val));
 					for (uint64_t x = 0; x < decltype(core.data)::size_val; ++x) {
-						core.data[x] = ptr;
+						core.data[x] = reinterpret_cast<output_type*>(ptr + x * core.total_required_bytes);
 					}
 				} else {
+					output_type* ptr = static_cast<output_type*>(memory_buffer.claim_memory(core.total_required_bytes));
 					core.data = ptr;
 				}
 			}
@@ -244,8 +234,9 @@ namespace nihilus {
 		NIHILUS_FORCE_INLINE thread_function(thread_function&&) noexcept				 = delete;
 		using output_type																 = base_type_new::output_type;
 		using base_type																	 = base_type_new;
-		NIHILUS_FORCE_INLINE void thread_impl(uint64_t thread_index, uint64_t thread_count) {
-			kernel_dispatcher<config, device_type::cpu, base_type::krn_type, base_type>::impl(*this);
+		NIHILUS_FORCE_INLINE void thread_impl(uint64_t thread_index, uint64_t thread_count, scratch_arena& scratch, uint64_t current_index = 0) {
+			scratch.reset();
+			kernel_dispatcher<config, device_type::cpu, base_type::krn_type, base_type>::impl(*this, current_index, scratch);
 		}
 	};
 
@@ -257,10 +248,11 @@ namespace nihilus {
 		NIHILUS_FORCE_INLINE thread_function(thread_function&&) noexcept				 = delete;
 		using output_type																 = base_type_new::output_type;
 		using base_type																	 = base_type_new;
-		NIHILUS_FORCE_INLINE void thread_impl(uint64_t thread_index, uint64_t thread_count, uint64_t current_index = 0) {
+		NIHILUS_FORCE_INLINE void thread_impl(uint64_t thread_index, uint64_t thread_count, scratch_arena& scratch, uint64_t current_index = 0) {
 			//stop_watch_val.reset();
 			this->sync_flag_start[current_index].arrive_and_wait(thread_index);
-			kernel_dispatcher<config, device_type::cpu, base_type::krn_type, base_type>::impl(*this);
+			scratch.reset();
+			kernel_dispatcher<config, device_type::cpu, base_type::krn_type, base_type>::impl(*this, current_index, scratch);
 			this->sync_flag_start[current_index].arrive_and_wait_second(thread_index);
 			//count[base_type::type].fetch_add(stop_watch_val.total_time_elapsed_uint64(), std::memory_order_release);
 			//avg_count[base_type::type].fetch_add(1, std::memory_order_release);
@@ -272,94 +264,54 @@ namespace nihilus {
 		using derived_type		= derived_type_new;
 		using op_type_type		= model_traits_type::op_type_type;
 
-		static constexpr uint64_t global_input_count{ [] {
-			uint64_t return_value{};
-			get_core_traits_config_base_t<config>::template impl_constexpr<execution_planner_constexpr>(return_value, layer_op_type::global_input);
-			return return_value;
-		}() };
-
-		static constexpr uint64_t per_block_count{ [] {
-			uint64_t return_value{};
-			get_core_traits_config_base_t<config>::template impl_constexpr<execution_planner_constexpr>(return_value, layer_op_type::per_block);
-			return return_value;
-		}() };
-
-		static constexpr uint64_t global_output_count{ [] {
-			uint64_t return_value{};
-			get_core_traits_config_base_t<config>::template impl_constexpr<execution_planner_constexpr>(return_value, layer_op_type::global_output);
-			return return_value;
-		}() };
-
-		static constexpr auto global_input{ [] {
-			uint64_t current_index{};
-			array<op_type_type, global_input_count> return_value{};
-			get_core_traits_config_base_t<config>::template impl_constexpr<execution_planner_constexpr>(return_value, layer_op_type::global_input, current_index);
-			return return_value;
-		}() };
-
-		static constexpr auto per_block{ [] {
-			uint64_t current_index{};
-			array<op_type_type, per_block_count> return_value{};
-			get_core_traits_config_base_t<config>::template impl_constexpr<execution_planner_constexpr>(return_value, layer_op_type::per_block, current_index);
-			return return_value;
-		}() };
-
-		static constexpr auto global_output{ [] {
-			uint64_t current_index{};
-			array<op_type_type, global_output_count> return_value{};
-			get_core_traits_config_base_t<config>::template impl_constexpr<execution_planner_constexpr>(return_value, layer_op_type::global_output, current_index);
-			return return_value;
-		}() };
-
-		template<template<model_config, typename> typename thread_function, uint64_t current_index = 0>
-		NIHILUS_FORCE_INLINE void impl_global_input(uint64_t thread_index, uint64_t thread_count) {
-			if constexpr (current_index < global_input_count) {
-				static constexpr op_type_type op_type = global_input[current_index];
-				using core_traits_type				  = core_traits<config, op_type>;
-				static_cast<thread_function<config, core_traits_type>*>(static_cast<core_traits_type*>(static_cast<derived_type_new*>(this)))
-					->thread_impl(thread_index, thread_count);
-				impl_global_input<thread_function, current_index + 1>(thread_index, thread_count);
+		// graph_config selects which instantiation of the op graph runs: config itself for prefill, decode_config<config> for single-row decode.
+		template<model_config graph_config, template<model_config, typename> typename thread_function, uint64_t current_index = 0>
+		NIHILUS_FORCE_INLINE void impl_global_input(uint64_t thread_index, uint64_t thread_count, scratch_arena& scratch) {
+			if constexpr (current_index < execution_schedule<graph_config>::global_input_count) {
+				static constexpr op_type_type op_type = execution_schedule<graph_config>::global_input[current_index];
+				using core_traits_type				  = core_traits<graph_config, op_type>;
+				static_cast<thread_function<graph_config, core_traits_type>*>(static_cast<core_traits_type*>(static_cast<derived_type_new*>(this)))
+					->thread_impl(thread_index, thread_count, scratch);
+				impl_global_input<graph_config, thread_function, current_index + 1>(thread_index, thread_count, scratch);
 			}
 		}
 
-		template<template<model_config, typename> typename thread_function, uint64_t current_index = 0>
-		NIHILUS_FORCE_INLINE void impl_per_block(uint64_t thread_index, uint64_t thread_count, uint64_t current_index_new) {
-			if constexpr (current_index < per_block_count) {
-				static constexpr op_type_type op_type = per_block[current_index];
-				using core_traits_type				  = core_traits<config, op_type>;
-				if constexpr (blocking<core_traits_type>) {
-					static_cast<thread_function<config, core_traits_type>*>(static_cast<core_traits_type*>(static_cast<derived_type_new*>(this)))
-						->thread_impl(thread_index, thread_count, current_index_new);
-				} else {
-					static_cast<thread_function<config, core_traits_type>*>(static_cast<core_traits_type*>(static_cast<derived_type_new*>(this)))
-						->thread_impl(thread_index, thread_count);
-				}
-				impl_per_block<thread_function, current_index + 1>(thread_index, thread_count, current_index_new);
+		template<model_config graph_config, template<model_config, typename> typename thread_function, uint64_t current_index = 0>
+		NIHILUS_FORCE_INLINE void impl_per_block(uint64_t thread_index, uint64_t thread_count, scratch_arena& scratch, uint64_t current_index_new) {
+			if constexpr (current_index < execution_schedule<graph_config>::per_block_count) {
+				static constexpr op_type_type op_type = execution_schedule<graph_config>::per_block[current_index];
+				using core_traits_type				  = core_traits<graph_config, op_type>;
+				static_cast<thread_function<graph_config, core_traits_type>*>(static_cast<core_traits_type*>(static_cast<derived_type_new*>(this)))
+					->thread_impl(thread_index, thread_count, scratch, current_index_new);
+				impl_per_block<graph_config, thread_function, current_index + 1>(thread_index, thread_count, scratch, current_index_new);
 			}
 		}
 
-		template<template<model_config, typename> typename thread_function, uint64_t current_index = 0>
-		NIHILUS_FORCE_INLINE void impl_global_output(uint64_t thread_index, uint64_t thread_count) {
-			if constexpr (current_index < global_output_count) {
-				static constexpr op_type_type op_type = global_output[current_index];
-				using core_traits_type				  = core_traits<config, op_type>;
-				if constexpr (blocking<core_traits_type>) {
-					static_cast<thread_function<config, core_traits_type>*>(static_cast<core_traits_type*>(static_cast<derived_type_new*>(this)))
-						->thread_impl(thread_index, thread_count);
-				} else {
-					static_cast<thread_function<config, core_traits_type>*>(static_cast<core_traits_type*>(static_cast<derived_type_new*>(this)))
-						->thread_impl(thread_index, thread_count);
-				}
-				impl_global_output<thread_function, current_index + 1>(thread_index, thread_count);
+		template<model_config graph_config, template<model_config, typename> typename thread_function, uint64_t current_index = 0>
+		NIHILUS_FORCE_INLINE void impl_global_output(uint64_t thread_index, uint64_t thread_count, scratch_arena& scratch) {
+			if constexpr (current_index < execution_schedule<graph_config>::global_output_count) {
+				static constexpr op_type_type op_type = execution_schedule<graph_config>::global_output[current_index];
+				using core_traits_type				  = core_traits<graph_config, op_type>;
+				static_cast<thread_function<graph_config, core_traits_type>*>(static_cast<core_traits_type*>(static_cast<derived_type_new*>(this)))
+					->thread_impl(thread_index, thread_count, scratch);
+				impl_global_output<graph_config, thread_function, current_index + 1>(thread_index, thread_count, scratch);
 			}
 		};
 
-		template<template<model_config, typename> typename thread_function> NIHILUS_FORCE_INLINE void impl(uint64_t thread_index, uint64_t thread_count) {
-			impl_global_input<thread_function>(thread_index, thread_count);
+		template<model_config graph_config, template<model_config, typename> typename thread_function>
+		NIHILUS_FORCE_INLINE void impl(uint64_t thread_index, uint64_t thread_count) {
+			scratch_arena& scratch{ static_cast<derived_type*>(this)->thread_scratch(thread_index) };
+			static_cast<derived_type*>(this)->wait_resident(0);
+			impl_global_input<graph_config, thread_function>(thread_index, thread_count, scratch);
 			for (uint64_t x = 0; x < model_traits_type::block_count; ++x) {
-				impl_per_block<thread_function>(thread_index, thread_count, x);
+				if (thread_index == 0) {
+					static_cast<derived_type*>(this)->enter_layer(x);
+				}
+				static_cast<derived_type*>(this)->wait_resident(1 + x);
+				impl_per_block<graph_config, thread_function>(thread_index, thread_count, scratch, x);
 			}
-			impl_global_output<thread_function>(thread_index, thread_count);
+			static_cast<derived_type*>(this)->wait_resident(model_traits_type::block_count + 1);
+			impl_global_output<graph_config, thread_function>(thread_index, thread_count, scratch);
 		};
 	};
 
@@ -369,14 +321,26 @@ namespace nihilus {
 		NIHILUS_FORCE_INLINE thread_pool& operator=(const thread_pool&) noexcept = delete;
 		NIHILUS_FORCE_INLINE thread_pool(const thread_pool&) noexcept			 = delete;
 
-		NIHILUS_FORCE_INLINE thread_pool(uint64_t thread_count_new) {
+		// With bind_threads, each worker is pinned to a cpu of its NUMA node (see numa_topology::node_of_thread) before it first runs.
+		NIHILUS_FORCE_INLINE thread_pool(uint64_t thread_count_new, bool bind_threads = false) {
 			worker_latches.resize(thread_count_new);
 			threads.resize(thread_count_new);
 			thread_count = thread_count_new;
+			static constexpr uint64_t scratch_stride{ scratch_plan<config>::bytes_per_thread };
+			scratch_memory.init(scratch_stride * thread_count_new);
+			scratch_arenas.resize(thread_count_new);
+			for (uint64_t x = 0; x < thread_count_new; ++x) {
+				scratch_arenas[x].data = scratch_memory.data() + x * scratch_stride;
+				scratch_arenas[x].size = scratch_stride;
+			}
 			main_thread_latch.reset(thread_count_new);
 			for (uint64_t x = 0; x < thread_count_new; ++x) {
 				worker_latches[x].reset(1ull);
-				threads[x] = std::thread{ [&, x] {
+				threads[x] = std::thread{ [&, x, bind_threads] {
+					if (bind_threads && numa_topology::get().node_count() > 1) {
+						pin_thread_to_core(static_cast<int>(numa_topology::get().cpu_of_thread(x, worker_latches.size())));
+					}
+					scratch_arenas[x].touch();
 					if (x < (thread_count_new % 3) == 0) {
 						thread_function_impl<true>(x);
 					} else {
@@ -392,17 +356,57 @@ namespace nihilus {
 			}
 			while (!stop.load(std::memory_order_acquire)) {
 				worker_latches[thread_index].wait();
+				const bool job_pass{ job_function != nullptr };
 				if (!stop.load(std::memory_order_acquire)) {
-					threading_strategy<config, derived_type>::template impl<thread_function>(thread_index, thread_count);
+					if (job_pass) {
+						job_function(job_context, thread_index, thread_count);
+					} else if (decode_pass.load(std::memory_order_acquire)) {
+						threading_strategy<config, derived_type>::template impl<decode_config<config>, thread_function>(thread_index, thread_count);
+					} else {
+						threading_strategy<config, derived_type>::template impl<config, thread_function>(thread_index, thread_count);
+					}
 				}
 				if (!main_thread_latch.try_wait()) {
 					main_thread_latch.count_down();
 				}
 				worker_latches[thread_index].reset(1ull);
+				if (job_pass) {
+					job_remaining.fetch_sub(1, std::memory_order_acq_rel);
+				}
+			}
+		}
+
+		// Runs job(thread_index, thread_count) once on every worker and returns when all of them are done; used for work outside the graph, such as
+		// loading weights. Unlike execute_tasks this waits for the last worker rather than the first, since jobs have no barrier of their own.
+		template<typename job_type> NIHILUS_FORCE_INLINE void execute_job(const job_type& job) {
+			if (threads.empty()) {
+				job(0ull, 1ull);
+				return;
+			}
+			job_context	 = &job;
+			job_function = [](const void* context, uint64_t thread_index, uint64_t thread_count_new) {
+				(*static_cast<const job_type*>(context))(thread_index, thread_count_new);
+			};
+			job_remaining.store(threads.size(), std::memory_order_release);
+			main_thread_latch.reset(threads.size());
+			for (auto& value: worker_latches) {
+				if (!value.try_wait()) {
+					value.count_down();
+				}
 			}
+			while (job_remaining.load(std::memory_order_acquire) > 0) {
+				nihilus_pause();
+			}
+			job_function = nullptr;
+			job_context	 = nullptr;
+		}
+
+		NIHILUS_FORCE_INLINE scratch_arena& thread_scratch(uint64_t thread_index) {
+			return scratch_arenas[thread_index];
 		}
 
-		NIHILUS_FORCE_INLINE void execute_tasks() {
+		NIHILUS_FORCE_INLINE void execute_tasks(bool decode = false) {
+			decode_pass.store(decode, std::memory_order_release);
 			stop_watch_val.reset();
 			main_thread_latch.reset(threads.size());
 			for (auto& value: worker_latches) {
@@ -439,12 +443,19 @@ namespace nihilus {
 
 	  protected:
 		std::vector<slim_latch> worker_latches{};
+		// Worker x owns scratch_arenas[x], a scratch_plan<config>::bytes_per_thread slice of scratch_memory.
+		std::vector<scratch_arena> scratch_arenas{};
+		memory_buffer<config> scratch_memory{};
 		slim_latch main_thread_latch{};
 		std::vector<std::thread> threads{};
 		char padding[48]{};
 		alignas(64) std::atomic_bool stop{};
-		char padding02[63]{};
+		std::atomic_bool decode_pass{};
+		char padding02[62]{};
 		alignas(64) uint64_t thread_count{};
+		alignas(64) std::atomic<uint64_t> job_remaining{};
+		void (*job_function)(const void*, uint64_t, uint64_t){};
+		const void* job_context{};
 	};
 
 }
\ No newline at end of file
@@ -25,4 +25,5 @@ RealTimeChris (Chris M.)
 #include <nihilus/common/type_traits.hpp>
 #include <nihilus/common/array.hpp>
 #include <nihilus/common/harbinger.hpp>
+#include <nihilus/common/prepacked_format.hpp>
 #include <nihilus/common/input_session.hpp>
\ No newline at end of file
@@ -0,0 +1,111 @@
+/*
+Copyright (c) 2025 RealTimeChris (Chris M.)
+
+This file is part of software offered under a restricted-use license to a designated Licensee,
+whose identity is confirmed in writing by the Author.
+
+License Terms (Summary):
+- Exclusive, non-transferable license for internal use only.
+- Redistribution, sublicensing, or public disclosure is prohibited without written consent.
+- Full ownership remains with the Author.
+- License may terminate if unused for [X months], if materially breached, or by mutual agreement.
+- No warranty is provided, express or implied.
+
+Full license terms are provided in the LICENSE file distributed with this software.
+
+Signed,
+RealTimeChris (Chris M.)
+2025
+*/
+
+#include "test_common.hpp"
+#include <cmath>
+#include <vector>
+
+using namespace nihilus_tests;
+
+using shift_type	   = nihilus::context_shift<test_config>;
+using model_traits_type = nihilus::model_traits<test_config.arch, test_config.model_size, test_config.model_generation>;
+using kv_cache_type	   = shift_type::kv_cache_type;
+static constexpr uint64_t block_count{ model_traits_type::block_count };
+static constexpr uint64_t layer_elements{ shift_type::kv_dim * shift_type::context_length };
+static constexpr uint64_t pair_count{ shift_type::rope_pair_count };
+
+// The key a rope kernel would have written at position for one pair of one head: a fixed vector rotated by position * theta.
+static void rotated_pair(uint64_t layer, uint64_t head, uint64_t pair, uint64_t position, const float* freq_factors, float& x0, float& x1) {
+	const float value0{ std::cos(static_cast<float>(layer * 31 + head * 7 + pair)) };
+	const float value1{ std::sin(static_cast<float>(layer * 17 + head * 3 + pair)) };
+	float theta{ static_cast<float>(position) *
+		std::pow(model_traits_type::rope_freq_base, -2.0f * static_cast<float>(pair) / static_cast<float>(model_traits_type::rope_dimension_count)) };
+	if (freq_factors) {
+		theta /= freq_factors[pair];
+	}
+	x0 = value0 * std::cos(theta) - value1 * std::sin(theta);
+	x1 = value0 * std::sin(theta) + value1 * std::cos(theta);
+}
+
+static void run_shift(const float* freq_factors, const char* description) {
+	static constexpr uint64_t token_count{ 40 };
+	static constexpr uint64_t keep_count{ 4 };
+	static constexpr uint64_t discard_count{ 10 };
+	std::vector<kv_cache_type> k_storage(block_count * layer_elements);
+	std::vector<kv_cache_type> v_storage(block_count * layer_elements);
+	shift_type::cache_data_type cache_k{};
+	shift_type::cache_data_type cache_v{};
+	for (uint64_t x = 0; x < block_count; ++x) {
+		cache_k[x] = k_storage.data() + x * layer_elements;
+		cache_v[x] = v_storage.data() + x * layer_elements;
+		for (uint64_t row = 0; row < token_count; ++row) {
+			for (uint64_t head = 0; head < model_traits_type::head_count_kv; ++head) {
+				kv_cache_type* values{ cache_k[x] + row * shift_type::kv_dim + head * model_traits_type::head_dim };
+				for (uint64_t pair = 0; pair < pair_count; ++pair) {
+					float x0{};
+					float x1{};
+					rotated_pair(x, head, pair, row, freq_factors, x0, x1);
+					values[2 * pair]	 = shift_type::store(x0);
+					values[2 * pair + 1] = shift_type::store(x1);
+				}
+			}
+			for (uint64_t y = 0; y < shift_type::kv_dim; ++y) {
+				cache_v[x][y * shift_type::context_length + row] = static_cast<kv_cache_type>(row * 100 + y % 100);
+			}
+		}
+	}
+
+	const std::vector<uint32_t> pages{ 0, 1, 2 };
+	shift_type::impl(cache_k, cache_v, pages, token_count, keep_count, discard_count, model_traits_type::rope_freq_base, freq_factors);
+
+	float max_error{};
+	bool values_moved{ true };
+	for (uint64_t x = 0; x < block_count; ++x) {
+		for (uint64_t row = 0; row < token_count - discard_count; ++row) {
+			const uint64_t source_row{ row < keep_count ? row : row + discard_count };
+			for (uint64_t head = 0; head < model_traits_type::head_count_kv; ++head) {
+				const kv_cache_type* values{ cache_k[x] + row * shift_type::kv_dim + head * model_traits_type::head_dim };
+				for (uint64_t pair = 0; pair < pair_count; ++pair) {
+					float x0{};
+					float x1{};
+					rotated_pair(x, head, pair, row, freq_factors, x0, x1);
+					max_error = std::max(max_error, std::fabs(shift_type::load(values[2 * pair]) - x0));
+					max_error = std::max(max_error, std::fabs(shift_type::load(values[2 * pair + 1]) - x1));
+				}
+			}
+			for (uint64_t y = 0; y < shift_type::kv_dim; ++y) {
+				values_moved &= cache_v[x][y * shift_type::context_length + row] == static_cast<kv_cache_type>(source_row * 100 + y % 100);
+			}
+		}
+	}
+	// Half precision keeps about three decimal digits; the re-rotation adds one more rounding.
+	check(max_error < 4e-3f, description);
+	check(values_moved, "values slide down by the discarded count and the kept rows stay put");
+}
+
+int main() {
+	run_shift(nullptr, "shifted keys match keys roped at their new positions");
+	std::vector<float> freq_factors(pair_count);
+	for (uint64_t x = 0; x < pair_count; ++x) {
+		freq_factors[x] = 1.0f + static_cast<float>(x % 4);
+	}
+	run_shift(freq_factors.data(), "shifted keys honour rope_freqs.weight");
+	return finish("context_shift");
+}
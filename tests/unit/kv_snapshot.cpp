@@ -0,0 +1,101 @@
+/*
+Copyright (c) 2025 RealTimeChris (Chris M.)
+
+This file is part of software offered under a restricted-use license to a designated Licensee,
+whose identity is confirmed in writing by the Author.
+
+License Terms (Summary):
+- Exclusive, non-transferable license for internal use only.
+- Redistribution, sublicensing, or public disclosure is prohibited without written consent.
+- Full ownership remains with the Author.
+- License may terminate if unused for [X months], if materially breached, or by mutual agreement.
+- No warranty is provided, express or implied.
+
+Full license terms are provided in the LICENSE file distributed with this software.
+
+Signed,
+RealTimeChris (Chris M.)
+2025
+*/
+
+#include "test_common.hpp"
+#include <filesystem>
+#include <fstream>
+#include <vector>
+
+using namespace nihilus_tests;
+
+using snapshot_type	  = nihilus::kv_snapshot<test_config>;
+using kv_cache_type	  = snapshot_type::kv_cache_type;
+using cache_data_type = snapshot_type::cache_data_type;
+static constexpr uint64_t block_count{ nihilus::model_traits<test_config.arch, test_config.model_size, test_config.model_generation>::block_count };
+static constexpr uint64_t layer_elements{ snapshot_type::kv_dim * snapshot_type::context_length };
+
+struct kv_cache {
+	std::vector<kv_cache_type> k_storage{};
+	std::vector<kv_cache_type> v_storage{};
+	cache_data_type k{};
+	cache_data_type v{};
+
+	kv_cache() : k_storage(block_count * layer_elements), v_storage(block_count * layer_elements) {
+		for (uint64_t x = 0; x < block_count; ++x) {
+			k[x] = k_storage.data() + x * layer_elements;
+			v[x] = v_storage.data() + x * layer_elements;
+		}
+	}
+};
+
+int main() {
+	static constexpr uint64_t token_count{ 37 };
+	const std::filesystem::path path{ std::filesystem::temp_directory_path() / "nihilus_kv_snapshot_test.bin" };
+	const std::vector<uint32_t> pages{ 0, 1, 2 };
+	std::vector<int32_t> tokens(token_count);
+	for (uint64_t x = 0; x < token_count; ++x) {
+		tokens[x] = static_cast<int32_t>(x * 7 + 3);
+	}
+
+	kv_cache source{};
+	for (uint64_t x = 0; x < block_count * layer_elements; ++x) {
+		source.k_storage[x] = static_cast<kv_cache_type>(x % 30011);
+		source.v_storage[x] = static_cast<kv_cache_type>((x * 13) % 30011);
+	}
+	check(snapshot_type::save(path, source.k, source.v, tokens, pages), "the snapshot is written");
+	check(std::filesystem::file_size(path) == snapshot_type::file_size(token_count), "the snapshot holds exactly the live rows");
+
+	kv_cache restored{};
+	std::vector<int32_t> restored_tokens{};
+	{
+		nihilus::memory_mapped_file<test_config.exceptions> file{ path };
+		const nihilus::kv_snapshot_header* header{ snapshot_type::validate(file) };
+		check(header != nullptr && header->token_count == token_count, "the snapshot validates");
+		if (header) {
+			snapshot_type::restore(file, *header, restored.k, restored.v, restored_tokens, pages);
+		}
+	}
+	check(restored_tokens == tokens, "the token history round-trips");
+	bool rows_match{ true };
+	bool tail_untouched{ true };
+	for (uint64_t x = 0; x < block_count; ++x) {
+		for (uint64_t row = 0; row < snapshot_type::context_length; ++row) {
+			for (uint64_t y = 0; y < snapshot_type::kv_dim; ++y) {
+				const uint64_t k_index{ x * layer_elements + row * snapshot_type::kv_dim + y };
+				const uint64_t v_index{ x * layer_elements + y * snapshot_type::context_length + row };
+				if (row < token_count) {
+					rows_match &= restored.k_storage[k_index] == source.k_storage[k_index] && restored.v_storage[v_index] == source.v_storage[v_index];
+				} else {
+					tail_untouched &= restored.k_storage[k_index] == 0 && restored.v_storage[v_index] == 0;
+				}
+			}
+		}
+	}
+	check(rows_match, "every live K row and V channel round-trips");
+	check(tail_untouched, "rows past the sequence are not written");
+
+	std::filesystem::resize_file(path, snapshot_type::file_size(token_count) - 1);
+	{
+		nihilus::memory_mapped_file<test_config.exceptions> file{ path };
+		check(snapshot_type::validate(file) == nullptr, "a truncated snapshot is rejected");
+	}
+	std::filesystem::remove(path);
+	return finish("kv_snapshot");
+}
@@ -0,0 +1,95 @@
+/*
+Copyright (c) 2025 RealTimeChris (Chris M.)
+
+This file is part of software offered under a restricted-use license to a designated Licensee,
+whose identity is confirmed in writing by the Author.
+
+License Terms (Summary):
+- Exclusive, non-transferable license for internal use only.
+- Redistribution, sublicensing, or public disclosure is prohibited without written consent.
+- Full ownership remains with the Author.
+- License may terminate if unused for [X months], if materially breached, or by mutual agreement.
+- No warranty is provided, express or implied.
+
+Full license terms are provided in the LICENSE file distributed with this software.
+
+Signed,
+RealTimeChris (Chris M.)
+2025
+*/
+
+#include "test_common.hpp"
+#include <cmath>
+#include <limits>
+#include <vector>
+
+using namespace nihilus_tests;
+
+static constexpr auto window_config = nihilus::harbinger::generate_model_config(nihilus::llama_model_generation::v3, nihilus::llama_model_size::llama_1B,
+	nihilus::kernel_type_profile::q8_gqa, nihilus::model_arch::llama, false, nihilus::kv_cache_strategy::paged, false, nihilus::rope_scaling_type::linear, true, 16, true,
+	nihilus::norm_type::rms_standard, nihilus::model_format::gguf, 1e-6f, nihilus::attention_mask_type::sliding_window, 5, 64, 16);
+
+using simd_softmax	 = nihilus::kernel_dispatcher_impl<cpu_arch_index, nihilus::kernel_type::softmax, int32_t, float, float>;
+using scalar_softmax = nihilus::kernel_dispatcher_impl<0, nihilus::kernel_type::softmax, int32_t, float, float>;
+
+// Rows whose length is not a multiple of the vector width end mid-register; masked lanes must neither be read nor written. Inputs outside the
+// visible span are NaN, so any masked lane that leaks into the max or the sum poisons the whole row.
+template<typename mask_type> static void run_rows(const mask_type& mask, uint64_t row_length, uint64_t row_count) {
+	const uint64_t count{ row_length * row_count };
+	std::vector<float> input(count);
+	std::vector<float> simd_output(count, -1.0f);
+	std::vector<float> scalar_output(count, -1.0f);
+	for (uint64_t x = 0; x < row_count; ++x) {
+		const nihilus::visible_range range{ mask.range_for_row(x) };
+		for (uint64_t y = 0; y < row_length; ++y) {
+			const bool visible{ y >= range.begin && y < range.end };
+			input[x * row_length + y] = visible ? std::sin(static_cast<float>(x * row_length + y) * 0.7f) * 4.0f : std::numeric_limits<float>::quiet_NaN();
+		}
+	}
+	simd_softmax::impl(count, simd_output.data(), input.data(), row_length, mask);
+	scalar_softmax::impl(count, scalar_output.data(), input.data(), row_length, mask);
+
+	bool matches{ true };
+	bool normalized{ true };
+	for (uint64_t x = 0; x < row_count; ++x) {
+		float sum{};
+		for (uint64_t y = 0; y < row_length; ++y) {
+			const uint64_t index{ x * row_length + y };
+			matches &= std::fabs(simd_output[index] - scalar_output[index]) <= 1e-5f;
+			sum += simd_output[index];
+		}
+		const nihilus::visible_range range{ mask.range_for_row(x) };
+		normalized &= range.begin >= std::min(range.end, row_length) ? sum == 0.0f : std::fabs(sum - 1.0f) <= 1e-4f;
+	}
+	check(matches, "the vector softmax matches the scalar one, masked lanes included");
+	check(normalized, "every visible span sums to one and masked rows to zero");
+}
+
+int main() {
+	static constexpr uint64_t row_lengths[]{ 1, 5, 8, 13, 21, 27, 64 };
+	for (uint64_t row_length: row_lengths) {
+		nihilus::attention_mask<test_config> causal{};
+		causal.query_count = 3;
+		const uint64_t causal_offsets[]{ 0, 2, row_length / 2 };
+		for (uint64_t offset: causal_offsets) {
+			causal.position_offset = offset;
+			run_rows(causal, row_length, 6);
+		}
+		// A short last chunk: two heads of four laid-out rows, only three of which hold tokens.
+		nihilus::attention_mask<test_config> short_chunk{};
+		short_chunk.row_stride		= 4;
+		short_chunk.query_count		= 3;
+		short_chunk.position_offset = row_length / 2;
+		run_rows(short_chunk, row_length, 8);
+		check(short_chunk.range_for_row(3).end == 0 && short_chunk.range_for_row(7).end == 0, "rows past the end of a short chunk see nothing");
+		check(short_chunk.range_for_row(4).end == short_chunk.range_for_row(0).end, "each head restarts at the first query row");
+		nihilus::attention_mask<window_config> window{};
+		window.query_count = 4;
+		const uint64_t window_offsets[]{ 0, 3, row_length };
+		for (uint64_t offset: window_offsets) {
+			window.position_offset = offset;
+			run_rows(window, row_length, 8);
+		}
+	}
+	return finish("masked_softmax");
+}
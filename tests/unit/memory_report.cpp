@@ -0,0 +1,92 @@
+/*
+Copyright (c) 2025 RealTimeChris (Chris M.)
+
+This file is part of software offered under a restricted-use license to a designated Licensee,
+whose identity is confirmed in writing by the Author.
+
+License Terms (Summary):
+- Exclusive, non-transferable license for internal use only.
+- Redistribution, sublicensing, or public disclosure is prohibited without written consent.
+- Full ownership remains with the Author.
+- License may terminate if unused for [X months], if materially breached, or by mutual agreement.
+- No warranty is provided, express or implied.
+
+Full license terms are provided in the LICENSE file distributed with this software.
+
+Signed,
+RealTimeChris (Chris M.)
+2025
+*/
+
+#include "test_common.hpp"
+#include <iomanip>
+#include <sstream>
+#include <string>
+
+using namespace nihilus_tests;
+
+using report_type		= nihilus::memory_report<test_config>;
+using model_traits_type = nihilus::model_traits<test_config.arch, test_config.model_size, test_config.model_generation>;
+using kv_cache_type		= nihilus::kernel_type_profile_traits<test_config.kernel_profile>::kv_cache_type;
+
+// One K and one V cache per layer, each kv_dim x context_length, rounded to 64 bytes as core_traits allocates them.
+static constexpr uint64_t layer_cache_bytes{ nihilus::roundUpToMultiple(
+	model_traits_type::head_count_kv * model_traits_type::head_dim * nihilus::sequence_traits<test_config>::context_length * sizeof(kv_cache_type), 64ull) };
+
+static std::string mib_line(const char* label, uint64_t bytes) {
+	std::ostringstream stream{};
+	stream << std::fixed << std::setprecision(2) << "  " << std::left << std::setw(36) << label << std::right << std::setw(12)
+		   << static_cast<double>(bytes) / (1024.0 * 1024.0) << " MiB";
+	return stream.str();
+}
+
+int main() {
+	uint64_t weights{};
+	uint64_t kv_cache{};
+	uint64_t activations{};
+	for (uint64_t x = 0; x < report_type::op_count; ++x) {
+		switch (report_type::ops[x].category) {
+			case nihilus::memory_category::weights:
+				weights += report_type::owned_bytes(x);
+				break;
+			case nihilus::memory_category::kv_cache:
+				kv_cache += report_type::owned_bytes(x);
+				break;
+			case nihilus::memory_category::activations:
+				activations += report_type::owned_bytes(x);
+				break;
+			default:
+				break;
+		}
+	}
+	check(weights == report_type::weight_bytes, "the weight total is the sum of the weight ops");
+	check(kv_cache == report_type::kv_cache_bytes, "the kv cache total is the sum of the cache ops");
+	check(report_type::kv_cache_bytes == 2 * model_traits_type::block_count * layer_cache_bytes, "the kv cache total is K and V for every layer");
+	check(report_type::layer_bytes(nihilus::memory_category::kv_cache) == 2 * layer_cache_bytes, "one layer holds one K and one V cache");
+	check(report_type::activation_bytes ==
+			activations + nihilus::memory_plan<test_config>::arena_bytes + nihilus::memory_plan<nihilus::decode_config<test_config>>::arena_bytes,
+		"the activation total is the unplanned ops plus both arenas");
+	check(!model_traits_type::tied_embeddings || report_type::op_bytes(static_cast<uint64_t>(nihilus::llama_op_types::output_weight)) == 0,
+		"a tied output projection owns nothing");
+
+	bool ordered{ true };
+	for (uint64_t x = 0; x < report_type::largest_count && report_type::largest[x] < report_type::op_count; ++x) {
+		ordered &= report_type::ops[report_type::largest[x]].category != nihilus::memory_category::weights;
+		if (x > 0 && report_type::largest[x - 1] < report_type::op_count) {
+			ordered &= report_type::op_bytes(report_type::largest[x - 1]) >= report_type::op_bytes(report_type::largest[x]);
+		}
+	}
+	check(ordered, "the largest buffers are non-weights in descending order");
+
+	static constexpr uint64_t thread_count{ 4 };
+	std::ostringstream stream{};
+	report_type::print(stream, thread_count);
+	const std::string printed{ stream.str() };
+	const uint64_t scratch_bytes{ report_type::scratch_bytes_per_thread * thread_count };
+	check(printed.find(mib_line("KV CACHE", report_type::kv_cache_bytes)) != std::string::npos, "the printed kv cache total matches");
+	check(printed.find(mib_line("SCRATCH", scratch_bytes)) != std::string::npos, "the printed scratch total scales with the thread count");
+	check(printed.find(mib_line("PER INSTANCE (KV + ACT + SCRATCH)", report_type::kv_cache_bytes + report_type::activation_bytes + scratch_bytes)) !=
+			std::string::npos,
+		"the printed per-instance total adds kv cache, activations and scratch");
+	return finish("memory_report");
+}
@@ -0,0 +1,81 @@
+/*
+Copyright (c) 2025 RealTimeChris (Chris M.)
+
+This file is part of software offered under a restricted-use license to a designated Licensee,
+whose identity is confirmed in writing by the Author.
+
+License Terms (Summary):
+- Exclusive, non-transferable license for internal use only.
+- Redistribution, sublicensing, or public disclosure is prohibited without written consent.
+- Full ownership remains with the Author.
+- License may terminate if unused for [X months], if materially breached, or by mutual agreement.
+- No warranty is provided, express or implied.
+
+Full license terms are provided in the LICENSE file distributed with this software.
+
+Signed,
+RealTimeChris (Chris M.)
+2025
+*/
+
+#include "test_common.hpp"
+#include <numeric>
+#include <vector>
+
+using namespace nihilus_tests;
+
+int main() {
+	using cache_type = nihilus::prefix_cache<test_config>;
+	static constexpr uint64_t page_size{ cache_type::page_size };
+	cache_type cache{};
+
+	std::vector<int32_t> first(page_size * 3);
+	std::vector<int32_t> second(page_size * 3);
+	std::iota(first.begin(), first.end(), 0);
+	std::iota(second.begin(), second.end(), 0);
+	std::iota(second.begin() + page_size, second.end(), 1000);
+
+	std::vector<uint32_t> pages{};
+	for (uint32_t x = 0; x < 3; ++x) {
+		check(cache.acquire_page(x), "a free page can be claimed at its own index");
+		pages.emplace_back(x);
+	}
+	check(!cache.acquire_page(1), "a page held by the active sequence cannot be claimed twice");
+	check(cache.available_pages() == cache_type::page_count - 3, "claimed pages leave the pool");
+
+	cache.insert(first.data(), first.size(), pages);
+	check(cache.is_shared(0) && cache.is_shared(2), "published pages are shared with the tree");
+	cache.release_pages(pages);
+	check(!cache.is_shared(0) && cache.available_pages() == cache_type::page_count - 3, "the tree keeps published pages resident");
+
+	std::vector<uint32_t> matched_pages{};
+	check(cache.match(first.data(), first.size(), matched_pages) == first.size(), "an identical sequence matches every full page");
+	check(matched_pages == std::vector<uint32_t>{ 0, 1, 2 }, "matched pages sit at their own positions");
+	cache.release_pages(matched_pages);
+
+	// The second sequence shares only the first page; claiming its second page evicts the cached suffix that held it.
+	check(cache.match(second.data(), second.size(), matched_pages) == page_size, "a diverging sequence matches up to the divergence");
+	check(matched_pages == std::vector<uint32_t>{ 0 }, "the shared prefix is the first page");
+	check(cache.acquire_page(1), "the page after the divergence is taken over from the cache");
+	matched_pages.emplace_back(1);
+	check(cache.available_pages() == cache_type::page_count - 2, "the evicted suffix returns its other pages to the pool");
+	std::vector<uint32_t> probe{};
+	check(cache.match(first.data(), first.size(), probe) == page_size, "the evicted branch no longer matches past the shared page");
+	cache.release_pages(probe);
+
+	// Only full pages are published; the trailing partial page stays private.
+	cache.insert(second.data(), page_size * 2 - 3, matched_pages);
+	check(!cache.is_shared(1), "a partial page is not published");
+	cache.insert(second.data(), page_size * 2, matched_pages);
+	check(cache.is_shared(1), "a completed page is published");
+	check(cache.match(second.data(), page_size * 2, probe) == page_size * 2, "the new branch matches");
+	cache.release_pages(probe);
+
+	// A context shift rewrites rows from a shared page on, so the tree gives up everything from there.
+	cache.evict_from(0);
+	check(!cache.is_shared(0) && !cache.is_shared(1), "evicting from a page drops the tree's references to it and its suffix");
+	check(cache.match(second.data(), page_size * 2, probe) == 0, "an evicted prefix no longer matches");
+	cache.release_pages(matched_pages);
+	check(cache.available_pages() == cache_type::page_count, "every page returns to the pool");
+	return finish("page_table");
+}
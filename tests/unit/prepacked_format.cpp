@@ -0,0 +1,135 @@
+/*
+Copyright (c) 2025 RealTimeChris (Chris M.)
+
+This file is part of software offered under a restricted-use license to a designated Licensee,
+whose identity is confirmed in writing by the Author.
+
+License Terms (Summary):
+- Exclusive, non-transferable license for internal use only.
+- Redistribution, sublicensing, or public disclosure is prohibited without written consent.
+- Full ownership remains with the Author.
+- License may terminate if unused for [X months], if materially breached, or by mutual agreement.
+- No warranty is provided, express or implied.
+
+Full license terms are provided in the LICENSE file distributed with this software.
+
+Signed,
+RealTimeChris (Chris M.)
+2025
+*/
+
+#include "test_common.hpp"
+#include <filesystem>
+#include <fstream>
+#include <cstring>
+#include <atomic>
+#include <vector>
+
+using namespace nihilus_tests;
+
+using layout_type	= nihilus::prepacked_layout<test_config>;
+using repacker_type = nihilus::weight_repacker<nihilus::half>;
+using block_type	= nihilus::block_q8_0<nihilus::half>;
+
+// Serves reads out of an in-memory copy of a file, the way direct_file_reader serves them out of the model file.
+struct memory_reader {
+	const std::vector<uint8_t>& file;
+
+	bool read(uint8_t* destination, uint64_t offset, uint64_t length) const {
+		if (offset + length > file.size()) {
+			return false;
+		}
+		std::memcpy(destination, file.data() + offset, length);
+		return true;
+	}
+};
+
+static void check_layout() {
+	bool aligned{ true };
+	bool disjoint{ true };
+	bool findable{ true };
+	for (uint64_t x = 0; x < layout_type::entry_count; ++x) {
+		const nihilus::prepacked_entry& entry{ layout_type::entries[x] };
+		aligned &= entry.offset % nihilus::prepacked_alignment == 0;
+		if (x > 0) {
+			const nihilus::prepacked_entry& previous{ layout_type::entries[x - 1] };
+			disjoint &= previous.offset + previous.bytes <= entry.offset;
+		}
+		findable &= layout_type::find(entry.op, entry.layer) == x;
+	}
+	check(aligned, "every prepacked tensor starts on a page boundary");
+	check(disjoint, "prepacked tensors do not overlap");
+	check(findable, "every entry is found again by its op and layer");
+	const nihilus::prepacked_entry& last{ layout_type::entries[layout_type::entry_count - 1] };
+	check(layout_type::data_bytes >= last.offset + last.bytes && layout_type::data_bytes % nihilus::prepacked_alignment == 0, "the data section covers the last tensor");
+	check(layout_type::header.tensor_count == layout_type::entry_count && layout_type::header.data_offset == layout_type::data_offset, "the header describes the table");
+}
+
+static void check_header_round_trip() {
+	const std::filesystem::path path{ std::filesystem::temp_directory_path() / "nihilus_prepacked_header_test.nhl" };
+	{
+		std::ofstream output{ path, std::ios::binary | std::ios::trunc };
+		const std::vector<char> padding(layout_type::data_offset - sizeof(nihilus::prepacked_header), 0);
+		output.write(reinterpret_cast<const char*>(&layout_type::header), sizeof(nihilus::prepacked_header));
+		output.write(padding.data(), static_cast<std::streamsize>(padding.size()));
+	}
+	{
+		nihilus::memory_mapped_file<test_config.exceptions> file{ path };
+		check(file.size() == layout_type::data_offset, "the header is padded to the data offset");
+		check(*reinterpret_cast<const nihilus::prepacked_header*>(file.data()) == layout_type::header, "a written header reads back equal");
+	}
+	nihilus::prepacked_header changed{ layout_type::header };
+	++changed.layout_hash;
+	check(changed != layout_type::header, "a different layout is told apart by its header");
+	std::filesystem::remove(path);
+}
+
+// The writer repacks out of place into the file; the direct loader reads the GGUF bytes into their slot and repacks them there. Both must produce
+// the same bytes, and undoing the interleave must give back the source rows.
+template<nihilus::weight_layout layout> static void check_repack_round_trip() {
+	static constexpr uint64_t row_count{ nihilus::weight_layout_traits<layout>::row_count };
+	static constexpr uint64_t interleave_bytes{ nihilus::weight_layout_traits<layout>::interleave_bytes };
+	const nihilus::weight_repack_traits traits{ layout, false, false, row_count * 3, 5, row_count * 3 * 5 * sizeof(block_type) };
+	std::vector<uint8_t> source(repacker_type::source_bytes(traits));
+	for (uint64_t x = 0; x < source.size(); ++x) {
+		source[x] = static_cast<uint8_t>(x * 131 + 7);
+	}
+
+	std::vector<uint8_t> written(traits.bytes);
+	repacker_type::impl(traits, written.data(), source.data());
+
+	static constexpr uint64_t file_offset{ 4096 };
+	std::vector<uint8_t> file(file_offset + source.size());
+	std::memcpy(file.data() + file_offset, source.data(), source.size());
+	std::vector<uint8_t> slot(traits.bytes);
+	nihilus::weight_load_schedule<nihilus::half> schedule{};
+	schedule.add_read(slot.data(), file_offset, source.size());
+	schedule.add_repack(traits, slot.data(), slot.data());
+	memory_reader reader{ file };
+	std::atomic<uint64_t> resident{};
+	check(schedule.run_in_order(resident, 1, reader) && resident.load() == 1, "the in-place load completes its stage");
+	check(slot == written, "repacking in place matches the writer's out-of-place repack");
+
+	const auto* blocks{ reinterpret_cast<const block_type*>(source.data()) };
+	const auto* groups{ reinterpret_cast<const nihilus::block_q8_0_interleaved<nihilus::half, row_count>*>(written.data()) };
+	bool restored{ true };
+	for (uint64_t row = 0; row < traits.rows; ++row) {
+		for (uint64_t block = 0; block < traits.blocks_per_row; ++block) {
+			const block_type& original{ blocks[row * traits.blocks_per_row + block] };
+			const auto& group{ groups[(row / row_count) * traits.blocks_per_row + block] };
+			restored &= group.d[row % row_count] == original.d;
+			for (uint64_t chunk = 0; chunk < nihilus::Q_SIZE / interleave_bytes; ++chunk) {
+				restored &= std::memcmp(group.qs + (chunk * row_count + row % row_count) * interleave_bytes, original.qs + chunk * interleave_bytes, interleave_bytes) == 0;
+			}
+		}
+	}
+	check(restored, "undoing the interleave gives back every source block");
+}
+
+int main() {
+	check_layout();
+	check_header_round_trip();
+	check_repack_round_trip<nihilus::weight_layout::interleaved_x4>();
+	check_repack_round_trip<nihilus::weight_layout::interleaved_x8>();
+	return finish("prepacked_format");
+}
@@ -0,0 +1,47 @@
+/*
+Copyright (c) 2025 RealTimeChris (Chris M.)
+
+This file is part of software offered under a restricted-use license to a designated Licensee,
+whose identity is confirmed in writing by the Author.
+
+License Terms (Summary):
+- Exclusive, non-transferable license for internal use only.
+- Redistribution, sublicensing, or public disclosure is prohibited without written consent.
+- Full ownership remains with the Author.
+- License may terminate if unused for [X months], if materially breached, or by mutual agreement.
+- No warranty is provided, express or implied.
+
+Full license terms are provided in the LICENSE file distributed with this software.
+
+Signed,
+RealTimeChris (Chris M.)
+2025
+*/
+
+#pragma once
+
+#include <nihilus/index.hpp>
+#include <iostream>
+
+namespace nihilus_tests {
+
+	// Llama 3 1B capped at a 64-token context and 16-row batches, so every cache and snapshot the tests build stays a few megabytes.
+	static constexpr auto test_config = nihilus::harbinger::generate_model_config(nihilus::llama_model_generation::v3, nihilus::llama_model_size::llama_1B,
+		nihilus::kernel_type_profile::q8_gqa, nihilus::model_arch::llama, false, nihilus::kv_cache_strategy::paged, false, nihilus::rope_scaling_type::linear, true, 16, true,
+		nihilus::norm_type::rms_standard, nihilus::model_format::gguf, 1e-6f, nihilus::attention_mask_type::causal, 4096, 64, 16);
+
+	inline uint64_t failure_count{};
+
+	inline void check(bool condition, const char* description) {
+		if (!condition) {
+			std::cerr << "FAILED: " << description << std::endl;
+			++failure_count;
+		}
+	}
+
+	inline int finish(const char* test_name) {
+		std::cout << test_name << ": " << (failure_count == 0 ? "PASSED" : "FAILED") << std::endl;
+		return failure_count == 0 ? 0 : 1;
+	}
+
+}
@@ -0,0 +1,41 @@
+/*
+Copyright (c) 2025 RealTimeChris (Chris M.)
+
+This file is part of software offered under a restricted-use license to a designated Licensee,
+whose identity is confirmed in writing by the Author.
+
+License Terms (Summary):
+- Exclusive, non-transferable license for internal use only.
+- Redistribution, sublicensing, or public disclosure is prohibited without written consent.
+- Full ownership remains with the Author.
+- License may terminate if unused for [X months], if materially breached, or by mutual agreement.
+- No warranty is provided, express or implied.
+
+Full license terms are provided in the LICENSE file distributed with this software.
+
+Signed,
+RealTimeChris (Chris M.)
+2025
+*/
+
+#include <nihilus/index.hpp>
+
+// The layout is a function of the model config, so the prepacker is built for the same config as the engine that will load its output.
+static constexpr auto model_config = nihilus::harbinger::generate_model_config(nihilus::llama_model_generation::v3, nihilus::llama_model_size::llama_8B,
+	nihilus::kernel_type_profile::q8_gqa, nihilus::model_arch::llama, false);
+
+int main(int argc, char** argv) {
+	if (argc != 3) {
+		std::cerr << "usage: " << argv[0] << " <input.gguf> <output.nhl>" << std::endl;
+		std::cerr << "writes the layout of llama 3 8B with the q8_gqa kernel profile, the config this tool is built for; rebuild it with the engine's own config to "
+					 "prepack any other model."
+				  << std::endl;
+		return 1;
+	}
+	if (!nihilus::prepacked_writer<model_config>::write(argv[1], argv[2])) {
+		return 1;
+	}
+	std::cout << "Wrote " << nihilus::prepacked_layout<model_config>::entry_count << " tensors ("
+			  << nihilus::prepacked_layout<model_config>::data_offset + nihilus::prepacked_layout<model_config>::data_bytes << " bytes) to " << argv[2] << std::endl;
+	return 0;
+}